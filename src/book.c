@@ -0,0 +1,369 @@
+/* Opening books for the placement phase.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Opening books for the placement phase.
+ *
+ * While the pieces are being placed, almost every empty place is a
+ * legal move, which makes the placement phase the most expensive part
+ * of the game to search.  An opening book holds good moves for the
+ * positions of that phase, so that a computer player can look up its
+ * move instead.  morris-book builds books from game records.
+ *
+ * Positions that are rotations or mirror images of each other are
+ * stored only once.  A position is looked up by its canonical key,
+ * the smallest ::StateKey among all symmetries of its board.  Its
+ * moves are stored in the same orientation and are turned back when
+ * the book is probed.
+ *
+ * An opening book file is a 16-byte header followed by ::BookEntry
+ * records, sorted by key and then by descending weight, in little
+ * endian byte order:
+ *
+ * @code
+ * offset 0   "MMBK"   magic
+ * offset 4   guint8   format version, currently 1
+ * offset 5   guint8   the number of men of the game variant
+ * offset 6   guint16  reserved, always 0
+ * offset 8   guint64  number of entries
+ * offset 16  entries...
+ * @endcode
+ *
+ * The file is mapped into memory and searched in place, so processes
+ * that use the same book share its pages.  Every entry is checked
+ * once when the book is opened, since a move from a corrupt book
+ * would otherwise be played on places outside the board.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+
+#include "morris.h"
+#include "corpus.h"
+#include "book.h"
+
+/* The generated symmetries table.  */
+#include "tables-gen.h"
+
+/** The 48 bits of a ::StateKey that hold the board.  */
+#define BOARD_BITS G_GUINT64_CONSTANT (0xffffffffffff)
+
+struct Book_tag
+{
+  GMappedFile *file;
+  const BookEntry *entries; /**< The entries within the mapped file */
+  gsize count;
+};
+
+/********************************************************************/
+/* Symmetries  */
+
+/* Apply a symmetry to the board of a key.  */
+static StateKey
+transform_key (StateKey key, guint sym)
+{
+  StateKey result = key & ~BOARD_BITS;
+  guint pos;
+  for (pos = 0; pos < BOARD_SIZE; pos++)
+    result |= ((key >> (pos * 2)) & 0x03) << (symmetries[sym][pos] * 2);
+  return result;
+}
+
+/* Apply a symmetry, or its inverse, to a place.  */
+static guchar
+transform_pos (guchar pos, guint sym, bool inverse)
+{
+  guchar i;
+  if (!inverse)
+    return symmetries[sym][pos];
+  for (i = 0; i < BOARD_SIZE; i++)
+    {
+      if (symmetries[sym][i] == pos)
+	return i;
+    }
+  return pos;
+}
+
+/**
+ * Find the canonical key of a position.
+ *
+ * @param key the position
+ * @param sym receives the symmetry that turns @a key into the
+ * canonical key, or may be @a NULL
+ * @return the smallest key among all symmetries of the board of @a
+ * key
+ */
+StateKey
+book_canonical_key (StateKey key, guint *sym)
+{
+  StateKey best = key;
+  guint best_sym = 0, i;
+  for (i = 1; i < NUM_SYMMETRIES; i++)
+    {
+      StateKey image = transform_key (key, i);
+      if (image < best)
+	{
+	  best = image;
+	  best_sym = i;
+	}
+    }
+  if (sym != NULL)
+    *sym = best_sym;
+  return best;
+}
+
+/**
+ * Apply a symmetry of the board to a move.
+ *
+ * @param move the move to transform
+ * @param sym the symmetry, as given by book_canonical_key()
+ * @param inverse whether to undo the symmetry instead, which turns a
+ * move of the canonical position back into one of the original
+ * position
+ * @param result receives the transformed move
+ */
+void
+book_transform_move (const Move *move, guint sym, bool inverse,
+		     Move *result)
+{
+  result->type = move->type;
+  result->src = (move->type == MOVE_MOVE) ?
+    transform_pos (move->src, sym, inverse) : 0;
+  result->dest = transform_pos (move->dest, sym, inverse);
+}
+
+/********************************************************************/
+/* Probing  */
+
+/* Check that the entries hold valid moves of valid positions, in the
+   order that book_probe() searches them in.  */
+static bool
+entries_valid (const BookEntry *entries, gsize count)
+{
+  StateKey last_key = 0;
+  gsize i;
+  for (i = 0; i < count; i++)
+    {
+      StateKey key = GUINT64_FROM_LE (entries[i].key);
+      if (entries[i].type > MOVE_REMOVE ||
+	  entries[i].src >= BOARD_SIZE || entries[i].dest >= BOARD_SIZE ||
+	  !is_valid_state_key (key) || key < last_key)
+	return false;
+      last_key = key;
+    }
+  return true;
+}
+
+/**
+ * Map an opening book file into memory.
+ *
+ * @param path the file to open
+ * @return the book, or @a NULL if the file could not be opened, is
+ * not an opening book for this variant, or holds an invalid entry
+ */
+Book *
+book_open (const gchar *path)
+{
+  GMappedFile *file;
+  const gchar *contents;
+  gsize length;
+  guint64 count;
+  Book *book;
+
+  file = g_mapped_file_new (path, FALSE, NULL);
+  if (file == NULL)
+    return NULL;
+  contents = g_mapped_file_get_contents (file);
+  length = g_mapped_file_get_length (file);
+  if (length < BOOK_HEADER_SIZE ||
+      memcmp (contents, BOOK_MAGIC, 4) != 0 ||
+      contents[4] != BOOK_VERSION || contents[5] != MORRIS_VARIANT)
+    goto fail;
+  memcpy (&count, contents + 8, 8);
+  count = GUINT64_FROM_LE (count);
+  if (count != (length - BOOK_HEADER_SIZE) / sizeof (BookEntry) ||
+      (length - BOOK_HEADER_SIZE) % sizeof (BookEntry) != 0 ||
+      !entries_valid ((const BookEntry *) (contents + BOOK_HEADER_SIZE),
+		      count))
+    goto fail;
+
+  book = g_new (Book, 1);
+  book->file = file;
+  book->entries = (const BookEntry *) (contents + BOOK_HEADER_SIZE);
+  book->count = count;
+  return book;
+
+ fail:
+  g_mapped_file_unref (file);
+  return NULL;
+}
+
+/**
+ * Get the number of entries in an opening book.
+ *
+ * @param book the book to use
+ * @return the number of moves over all positions
+ */
+gsize
+book_size (Book *book)
+{
+  return book->count;
+}
+
+/**
+ * Look up the book moves of a position.
+ *
+ * @param book the book to use
+ * @param state the position to look up
+ * @param moves receives the book moves, which must have room for
+ * #BOOK_MAX_MOVES moves
+ * @param weights receives the weight of each move
+ * @return the number of book moves, which is zero if the position is
+ * not in the book
+ */
+guint
+book_probe (Book *book, GameState *state, Move *moves, guint32 *weights)
+{
+  const BookEntry *entries = book->entries;
+  gsize lo = 0, hi = book->count;
+  guint sym, num_moves = 0;
+  StateKey key;
+
+  key = book_canonical_key (pack_state (state), &sym);
+  while (lo < hi)
+    {
+      gsize mid = lo + (hi - lo) / 2;
+      if (GUINT64_FROM_LE (entries[mid].key) < key)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  for (; lo < book->count && GUINT64_FROM_LE (entries[lo].key) == key &&
+	 num_moves < BOOK_MAX_MOVES; lo++)
+    {
+      Move move;
+      move.type = entries[lo].type;
+      move.src = entries[lo].src;
+      move.dest = entries[lo].dest;
+      book_transform_move (&move, sym, true, &moves[num_moves]);
+      weights[num_moves++] = GUINT32_FROM_LE (entries[lo].weight);
+    }
+  return num_moves;
+}
+
+/**
+ * Pick a book move at random, in proportion to the weights.
+ *
+ * @param book the book to use
+ * @param state the position to look up
+ * @param rng_state the state of the random number generator, see
+ * corpus_random()
+ * @param move receives the move
+ * @return @a true if a move was chosen, @a false if the position is
+ * not in the book or all of its moves have a weight of zero
+ */
+bool
+book_choose (Book *book, GameState *state, guint64 *rng_state,
+	     Move *move)
+{
+  Move moves[BOOK_MAX_MOVES];
+  guint32 weights[BOOK_MAX_MOVES];
+  guint64 total = 0, target;
+  guint num_moves, i;
+
+  num_moves = book_probe (book, state, moves, weights);
+  for (i = 0; i < num_moves; i++)
+    total += weights[i];
+  if (total == 0)
+    return false;
+  target = (guint64) corpus_random (rng_state) << 32;
+  target = (target | corpus_random (rng_state)) % total;
+  for (i = 0; target >= weights[i]; i++)
+    target -= weights[i];
+  *move = moves[i];
+  return true;
+}
+
+/**
+ * Unmap an opening book.
+ *
+ * @param book the book to free
+ */
+void
+book_free (Book *book)
+{
+  g_mapped_file_unref (book->file);
+  g_free (book);
+}
+
+/********************************************************************/
+/* Writing  */
+
+/**
+ * Write an opening book file.
+ *
+ * @param path the file to write
+ * @param entries the entries in host byte order, sorted by key and
+ * then by descending weight
+ * @param count the number of entries
+ * @return @a true on success, @a false on an I/O error
+ */
+bool
+book_write (const gchar *path, const BookEntry *entries, gsize count)
+{
+  guchar header[BOOK_HEADER_SIZE];
+  guint64 le_count = GUINT64_TO_LE ((guint64) count);
+  FILE *fp;
+  bool success;
+  gsize i;
+
+  memcpy (header, BOOK_MAGIC, 4);
+  header[4] = BOOK_VERSION;
+  header[5] = MORRIS_VARIANT;
+  header[6] = 0;
+  header[7] = 0;
+  memcpy (header + 8, &le_count, 8);
+
+  fp = fopen (path, "wb");
+  if (fp == NULL)
+    return false;
+  success = (fwrite (header, BOOK_HEADER_SIZE, 1, fp) == 1);
+  for (i = 0; i < count && success; i++)
+    {
+      BookEntry entry = entries[i];
+      entry.key = GUINT64_TO_LE (entry.key);
+      entry.weight = GUINT32_TO_LE (entry.weight);
+      entry.reserved = 0;
+      success = (fwrite (&entry, sizeof (entry), 1, fp) == 1);
+    }
+  success &= (fclose (fp) == 0);
+  return success;
+}
@@ -0,0 +1,76 @@
+/* Opening books for the placement phase.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Opening books for the placement phase.
+ */
+
+#ifndef BOOK_H
+#define BOOK_H
+
+/** The first bytes of an opening book file.  */
+#define BOOK_MAGIC "MMBK"
+/** The current version of the opening book format.  */
+#define BOOK_VERSION 1
+/** The size of the header at the start of an opening book file.  */
+#define BOOK_HEADER_SIZE 16
+/** The largest number of book moves in any one position.  */
+#define BOOK_MAX_MOVES MAX_MOVES
+
+/**
+ * One move of an opening book, as it is stored in the file.
+ *
+ * All fields are in little endian byte order.  The position and the
+ * move are in canonical orientation, see book_canonical_key().
+ */
+struct BookEntry_tag
+{
+  guint64 key; /**< The canonical ::StateKey of the position */
+  guint32 weight; /**< How often to play the move, relative to others */
+  guchar type; /**< One of ::MoveType_tag */
+  guchar src;
+  guchar dest;
+  guchar reserved;
+};
+typedef struct BookEntry_tag BookEntry;
+
+/** An opening book that is mapped into memory.  */
+typedef struct Book_tag Book;
+
+StateKey book_canonical_key (StateKey key, guint *sym);
+void book_transform_move (const Move *move, guint sym, bool inverse,
+			  Move *result);
+
+Book *book_open (const gchar *path);
+gsize book_size (Book *book);
+guint book_probe (Book *book, GameState *state, Move *moves,
+		  guint32 *weights);
+bool book_choose (Book *book, GameState *state, guint64 *rng_state,
+		  Move *move);
+void book_free (Book *book);
+bool book_write (const gchar *path, const BookEntry *entries,
+		 gsize count);
+
+#endif /* not BOOK_H */
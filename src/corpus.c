@@ -0,0 +1,310 @@
+/* Corpora of representative game positions.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Corpora of representative game positions.
+ *
+ * Benchmarks and tests that only look at the empty board say nothing
+ * about the cost of the rules in the middle of a game.  A corpus is a
+ * set of positions taken from seeded random games, so that every tool
+ * can work on the same realistic workload.
+ *
+ * Random games spend most of their time in a few kinds of positions,
+ * so the positions are stratified: they are grouped by phase (placing
+ * or moving pieces) and by the number of pieces on the board, and the
+ * corpus draws from every group in turn.  Rare kinds of positions,
+ * such as crowded boards late in the placing phase, are thereby
+ * represented as well as common ones.
+ *
+ * A corpus file holds a 16-byte header followed by the positions as
+ * packed ::StateKey values, all in little endian byte order:
+ *
+ * @code
+ * offset 0   "MCRP"   magic
+ * offset 4   guint32  format version, currently 1
+ * offset 8   guint64  number of positions
+ * offset 16  guint64  positions...
+ * @endcode
+ *
+ * The whole file is read with a single read.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "morris.h"
+#include "corpus.h"
+
+#define CORPUS_MAGIC "MCRP"
+#define CORPUS_VERSION 1
+#define CORPUS_HEADER_SIZE 16
+
+/** Random games are cut off after this many moves.  */
+#define MAX_GAME_MOVES 256
+/** Number of positions to look at for every position in the corpus.  */
+#define OVERSAMPLING 8
+/**
+ * Each stratum keeps a sample of this many times its equal share of
+ * the corpus, so that common strata can make up for rare ones.
+ */
+#define STRATUM_HEADROOM 2
+
+/**
+ * Get the stratum that a position belongs to.
+ *
+ * @param state the position
+ * @return a number less than ::CORPUS_NUM_STRATA
+ */
+guint
+corpus_stratum (GameState *state)
+{
+  guint pieces = state->player_pieces[0] + state->player_pieces[1];
+  return ((state->setup_rounds_left > 0) ? 0 : BOARD_SIZE + 1) + pieces;
+}
+
+/**
+ * Get a random number.
+ *
+ * This is xorshift64*, which gives the same sequence on every
+ * platform, unlike rand ().
+ *
+ * @param rng_state the generator state, which must not be zero
+ * @return 32 random bits
+ */
+guint32
+corpus_random (guint64 *rng_state)
+{
+  *rng_state ^= *rng_state >> 12;
+  *rng_state ^= *rng_state << 25;
+  *rng_state ^= *rng_state >> 27;
+  return (*rng_state * G_GUINT64_CONSTANT (0x2545f4914f6cdd1d)) >> 32;
+}
+
+static int
+compare_keys (const void *a, const void *b)
+{
+  StateKey x = *(const StateKey *) a, y = *(const StateKey *) b;
+  return (x > y) - (x < y);
+}
+
+/* Sort a sample, drop the repeated positions and shuffle the rest.
+   Returns the number of distinct positions.  */
+static guint
+unique_sample (StateKey *sample, guint count, guint64 *rng_state)
+{
+  guint num_unique = 0;
+  guint i;
+  qsort (sample, count, sizeof (StateKey), compare_keys);
+  for (i = 0; i < count; i++)
+    {
+      if (num_unique == 0 || sample[i] != sample[num_unique-1])
+	sample[num_unique++] = sample[i];
+    }
+  for (i = num_unique; i > 1; i--)
+    {
+      guint j = corpus_random (rng_state) % i;
+      StateKey tmp = sample[i-1];
+      sample[i-1] = sample[j];
+      sample[j] = tmp;
+    }
+  return num_unique;
+}
+
+/**
+ * Fill an array with a stratified sample of positions from random
+ * games.
+ *
+ * Each stratum keeps a uniform sample of the positions that came up
+ * in it, by reservoir sampling.  A stratum only keeps
+ * ::STRATUM_HEADROOM times its share of the corpus, and repeats of a
+ * position are dropped from its sample, so a stratum with few
+ * distinct positions, such as the empty board, adds each of them only
+ * once.  Once enough positions have been seen, the corpus is filled
+ * by taking one position from each stratum in turn, until the strata
+ * run dry.  The same seed always gives the same corpus.
+ *
+ * @param keys the array to fill
+ * @param count the number of positions to generate
+ * @param seed the random seed
+ * @return the number of positions generated, which is less than @a
+ * count only if the random games did not come up with that many
+ * distinct positions
+ */
+guint
+corpus_generate (StateKey *keys, guint count, guint64 seed)
+{
+  StateKey *samples[CORPUS_NUM_STRATA];
+  guint64 seen[CORPUS_NUM_STRATA];
+  guint sizes[CORPUS_NUM_STRATA];
+  guint taken[CORPUS_NUM_STRATA];
+  guint64 rng_state = (seed != 0) ? seed : CORPUS_DEFAULT_SEED;
+  guint64 total_seen = 0;
+  guint capacity = (guint) (((guint64) count * STRATUM_HEADROOM +
+			     CORPUS_NUM_STRATA - 1) / CORPUS_NUM_STRATA);
+  guint num_keys = 0, num_left = 0;
+  guint i;
+
+  for (i = 0; i < CORPUS_NUM_STRATA; i++)
+    {
+      samples[i] = g_new (StateKey, capacity);
+      seen[i] = 0;
+      taken[i] = 0;
+    }
+
+  while (total_seen < (guint64) count * OVERSAMPLING)
+    {
+      GameState state;
+      guint num_game_moves;
+      init_game_state (&state);
+      for (num_game_moves = 0; num_game_moves < MAX_GAME_MOVES;
+	   num_game_moves++)
+	{
+	  Move moves[MAX_MOVES];
+	  guint num_moves = gen_moves (&state, moves);
+	  guint stratum = corpus_stratum (&state);
+	  guint64 slot = seen[stratum]++;
+	  if (slot >= capacity)
+	    {
+	      guint64 r = corpus_random (&rng_state);
+	      r = r << 32 | corpus_random (&rng_state);
+	      slot = r % (slot + 1);
+	    }
+	  if (slot < capacity)
+	    samples[stratum][slot] = pack_state (&state);
+	  total_seen++;
+	  if (num_moves == 0)
+	    break;
+	  play_move (&state, &moves[corpus_random (&rng_state) % num_moves]);
+	}
+    }
+
+  for (i = 0; i < CORPUS_NUM_STRATA; i++)
+    {
+      sizes[i] = unique_sample (samples[i], MIN (seen[i], capacity),
+				&rng_state);
+      num_left += sizes[i];
+    }
+  while (num_keys < count && num_left > 0)
+    {
+      for (i = 0; i < CORPUS_NUM_STRATA && num_keys < count; i++)
+	{
+	  if (taken[i] < sizes[i])
+	    {
+	      keys[num_keys++] = samples[i][taken[i]++];
+	      num_left--;
+	    }
+	}
+    }
+
+  for (i = 0; i < CORPUS_NUM_STRATA; i++)
+    g_free (samples[i]);
+  return num_keys;
+}
+
+/**
+ * Write a corpus file.
+ *
+ * @param path the file to write
+ * @param keys the positions to write
+ * @param count the number of positions
+ * @return @a true on success, @a false on an I/O error
+ */
+bool
+corpus_write (const gchar *path, const StateKey *keys, guint count)
+{
+  guchar header[CORPUS_HEADER_SIZE];
+  guint32 version = GUINT32_TO_LE (CORPUS_VERSION);
+  guint64 le_count = GUINT64_TO_LE ((guint64) count);
+  StateKey *le_keys;
+  FILE *fp;
+  bool success;
+  guint i;
+
+  memcpy (header, CORPUS_MAGIC, 4);
+  memcpy (header + 4, &version, 4);
+  memcpy (header + 8, &le_count, 8);
+  le_keys = g_new (StateKey, count);
+  for (i = 0; i < count; i++)
+    le_keys[i] = GUINT64_TO_LE (keys[i]);
+
+  fp = fopen (path, "wb");
+  success = (fp != NULL);
+  if (success)
+    {
+      success = (fwrite (header, CORPUS_HEADER_SIZE, 1, fp) == 1 &&
+		 fwrite (le_keys, sizeof (StateKey), count, fp) == count);
+      success &= (fclose (fp) == 0);
+    }
+  g_free (le_keys);
+  return success;
+}
+
+/**
+ * Read a corpus file.
+ *
+ * @param path the file to read
+ * @param count receives the number of positions
+ * @return a newly allocated array of the positions, or @a NULL if the
+ * file cannot be read or is not a corpus file
+ */
+StateKey *
+corpus_read (const gchar *path, guint *count)
+{
+  gchar *contents;
+  gsize length;
+  guint32 version;
+  guint64 num_keys;
+  StateKey *keys = NULL;
+  guint i;
+
+  if (!g_file_get_contents (path, &contents, &length, NULL))
+    return NULL;
+  if (length < CORPUS_HEADER_SIZE ||
+      memcmp (contents, CORPUS_MAGIC, 4) != 0)
+    goto cleanup;
+  memcpy (&version, contents + 4, 4);
+  memcpy (&num_keys, contents + 8, 8);
+  version = GUINT32_FROM_LE (version);
+  num_keys = GUINT64_FROM_LE (num_keys);
+  if (version != CORPUS_VERSION || num_keys > G_MAXUINT ||
+      num_keys != (length - CORPUS_HEADER_SIZE) / sizeof (StateKey))
+    goto cleanup;
+
+  keys = g_new (StateKey, MAX (num_keys, 1));
+  memcpy (keys, contents + CORPUS_HEADER_SIZE, num_keys * sizeof (StateKey));
+  for (i = 0; i < num_keys; i++)
+    keys[i] = GUINT64_FROM_LE (keys[i]);
+  *count = num_keys;
+
+ cleanup:
+  g_free (contents);
+  return keys;
+}
@@ -0,0 +1,48 @@
+/* Corpora of representative game positions.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Corpora of representative game positions.
+ */
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+/** The random seed that tools use unless told otherwise.  */
+#define CORPUS_DEFAULT_SEED G_GUINT64_CONSTANT (0x9e3779b97f4a7c15)
+
+/**
+ * Number of corpus strata.  Positions are grouped by whether the
+ * pieces are still being placed and by the number of pieces on the
+ * board.
+ */
+#define CORPUS_NUM_STRATA (2 * (BOARD_SIZE + 1))
+
+guint corpus_stratum (GameState *state);
+guint32 corpus_random (guint64 *rng_state);
+guint corpus_generate (StateKey *keys, guint count, guint64 seed);
+bool corpus_write (const gchar *path, const StateKey *keys, guint count);
+StateKey *corpus_read (const gchar *path, guint *count);
+
+#endif /* not CORPUS_H */
@@ -0,0 +1,374 @@
+/* Static evaluation of game positions.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Static evaluation of game positions.
+ *
+ * The evaluation is a weighted sum of a few features of a position,
+ * such as the difference in pieces or in mobility, from the point of
+ * view of the player to move.  The weights can be tuned and loaded
+ * from a file, so this file only computes the features.
+ *
+ * Features are extracted from packed ::StateKey values in batches.
+ * A batch is split into the 24-bit piece masks of both players, which
+ * are stored as separate arrays.  Then every mill and every adjacency
+ * of the board is tested against the whole batch in an inner loop,
+ * using only masks, shifts and compares with a fixed mask or shift
+ * count.  These loops vectorize without any help, so the cost per
+ * position falls as the batch grows.  A search can still evaluate one
+ * position at a time with evaluate().
+ *
+ * A weights file holds one feature per line, given by its name from
+ * #eval_feature_names and its weight.  Features that are not given
+ * keep their default weight.  A `#' starts a comment.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "morris.h"
+#include "eval.h"
+
+/* The generated mill_bits, neighbor_mask and adjacent_places
+   tables.  */
+#include "tables-gen.h"
+
+/** The bits of the board that are set for player 1's pieces.  */
+#define BOARD_EVEN_BITS G_GUINT64_CONSTANT (0x555555555555)
+/** A mask of every board position.  */
+#define BOARD_MASK ((1 << BOARD_SIZE) - 1)
+/** The number of positions whose features are extracted together.  */
+#define EVAL_CHUNK 64
+
+/** The names of the features in weights files.  */
+const char *eval_feature_names[EVAL_NUM_FEATURES] = {
+  "pieces", "mobility", "mills", "open-mills", "blocked", "setup",
+  "remove"
+};
+
+/** Weights that were picked by hand.  */
+const EvalWeights eval_default_weights = {
+  { 100, 5, 20, 30, -10, 0, 90 }
+};
+
+/** The weights that evaluate() uses.  */
+EvalWeights eval_weights = {
+  { 100, 5, 20, 30, -10, 0, 90 }
+};
+
+/* Gather the even bits of the 48-bit board into a 24-bit mask.  */
+static inline guint32
+compress_board (guint64 bits)
+{
+  bits &= BOARD_EVEN_BITS;
+  bits = (bits | bits >> 1) & G_GUINT64_CONSTANT (0x3333333333333333);
+  bits = (bits | bits >> 2) & G_GUINT64_CONSTANT (0x0f0f0f0f0f0f0f0f);
+  bits = (bits | bits >> 4) & G_GUINT64_CONSTANT (0x00ff00ff00ff00ff);
+  bits = (bits | bits >> 8) & G_GUINT64_CONSTANT (0x0000ffff0000ffff);
+  bits = (bits | bits >> 16) & G_GUINT64_CONSTANT (0x00000000ffffffff);
+  return bits;
+}
+
+/* Split a packed position into the pieces of the player to move, the
+   pieces of the opponent and the empty places, and fill in the
+   features that do not depend on the layout of the board.  */
+static inline void
+decode_key (StateKey key, guint32 *own, guint32 *opp, guint32 *empty,
+	    gint16 *f)
+{
+  guint32 p1 = compress_board (key), p2 = compress_board (key >> 1);
+  guint setup = (key >> 48) & 0x0f;
+  bool remove = (key >> 52) & 0x01;
+  bool p2_to_move = (key >> 53) & 0x01;
+  /* The pieces that each player still has to place.  Player 1 places
+     first in every round, and the round is only counted down after
+     player 2 has placed and removed.  */
+  gint hand1 = (setup > 0) ? setup - (p2_to_move || remove) : 0;
+  gint hand2 = (setup > 0) ? setup - (p2_to_move && remove) : 0;
+
+  *own = p2_to_move ? p2 : p1;
+  *opp = p2_to_move ? p1 : p2;
+  *empty = ~(p1 | p2) & BOARD_MASK;
+  f[EVAL_PIECES] = __builtin_popcount (*own) - __builtin_popcount (*opp) +
+    (p2_to_move ? hand2 - hand1 : hand1 - hand2);
+  f[EVAL_SETUP] = setup;
+  f[EVAL_REMOVE] = remove;
+}
+
+/**
+ * Extract the evaluation features of a single position.
+ *
+ * This gives the same features as eval_extract(), without the setup
+ * cost of a batch.
+ *
+ * @param key the position
+ * @param f receives #EVAL_NUM_FEATURES features, indexed by
+ * ::EvalFeature_tag
+ */
+void
+eval_extract_one (StateKey key, gint16 *f)
+{
+  guint32 own, opp, empty, pieces;
+  gint mills = 0, open_mills = 0, mobility = 0, blocked = 0;
+  guint j;
+
+  decode_key (key, &own, &opp, &empty, f);
+  for (j = 0; j < TOTAL_MILLS; j++)
+    {
+      guint32 bits = mill_bits[j];
+      guint32 o = own & bits, t = opp & bits, e = empty & bits;
+      bool one_empty = (e != 0) && (e & (e - 1)) == 0;
+      mills += (o == bits) - (t == bits);
+      open_mills += (one_empty && t == 0) - (one_empty && o == 0);
+    }
+  for (pieces = own | opp; pieces != 0; pieces &= pieces - 1)
+    {
+      guint pos = __builtin_ctz (pieces);
+      gint sign = ((own >> pos) & 1) ? 1 : -1;
+      gint free = __builtin_popcount (empty & neighbor_mask[pos]);
+      mobility += sign * free;
+      blocked += sign * (free == 0);
+    }
+  f[EVAL_MOBILITY] = mobility;
+  f[EVAL_MILLS] = mills;
+  f[EVAL_OPEN_MILLS] = open_mills;
+  f[EVAL_BLOCKED] = blocked;
+}
+
+/* Extract the features of at most EVAL_CHUNK positions.  The mask
+   loops always run over a whole chunk, as a constant trip count lets
+   the compiler vectorize them even at -O2.  */
+static void
+extract_chunk (const StateKey *keys, guint n, gint16 *features)
+{
+  guint32 own[EVAL_CHUNK], opp[EVAL_CHUNK], empty[EVAL_CHUNK];
+  gint32 mills[EVAL_CHUNK], open_mills[EVAL_CHUNK];
+  gint32 mobility[EVAL_CHUNK], blocked[EVAL_CHUNK];
+  guint i, j;
+
+  for (i = 0; i < n; i++)
+    decode_key (keys[i], &own[i], &opp[i], &empty[i],
+		&features[i*EVAL_NUM_FEATURES]);
+  for (; i < EVAL_CHUNK; i++)
+    own[i] = opp[i] = empty[i] = 0;
+  memset (mills, 0, sizeof (mills));
+  memset (open_mills, 0, sizeof (open_mills));
+  memset (mobility, 0, sizeof (mobility));
+  memset (blocked, 0, sizeof (blocked));
+
+  for (j = 0; j < TOTAL_MILLS; j++)
+    {
+      guint32 bits = mill_bits[j];
+      for (i = 0; i < EVAL_CHUNK; i++)
+	{
+	  guint32 o = own[i] & bits, t = opp[i] & bits, e = empty[i] & bits;
+	  /* Exactly one place of the mill is empty.  */
+	  gint32 one_empty = (e != 0) & ((e & (e - 1)) == 0);
+	  mills[i] += (o == bits) - (t == bits);
+	  open_mills[i] += (one_empty & (t == 0)) - (one_empty & (o == 0));
+	}
+    }
+
+  for (j = 0; j < BOARD_SIZE; j++)
+    {
+      guint32 neighbors = neighbor_mask[j];
+      for (i = 0; i < EVAL_CHUNK; i++)
+	{
+	  gint32 stuck = (empty[i] & neighbors) == 0;
+	  blocked[i] += (stuck & (own[i] >> j)) - (stuck & (opp[i] >> j));
+	}
+    }
+
+  for (j = 0; j < BOARD_SIZE * 4; j++)
+    {
+      guint src = j / 4, dest = adjacent_places[j];
+      if (dest >= BOARD_SIZE)
+	continue;
+      for (i = 0; i < EVAL_CHUNK; i++)
+	{
+	  guint32 free = empty[i] >> dest;
+	  mobility[i] += (gint32) ((own[i] >> src) & free & 1) -
+	    (gint32) ((opp[i] >> src) & free & 1);
+	}
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      gint16 *f = &features[i*EVAL_NUM_FEATURES];
+      f[EVAL_MOBILITY] = mobility[i];
+      f[EVAL_MILLS] = mills[i];
+      f[EVAL_OPEN_MILLS] = open_mills[i];
+      f[EVAL_BLOCKED] = blocked[i];
+    }
+}
+
+/**
+ * Extract the evaluation features of a batch of positions.
+ *
+ * @param keys the positions
+ * @param count the number of positions
+ * @param features receives #EVAL_NUM_FEATURES features for each
+ * position, one position after the other, indexed by
+ * ::EvalFeature_tag
+ */
+void
+eval_extract (const StateKey *keys, gsize count, gint16 *features)
+{
+  gsize i;
+  for (i = 0; i < count; i += EVAL_CHUNK)
+    extract_chunk (&keys[i], MIN (count - i, EVAL_CHUNK),
+		   &features[i*EVAL_NUM_FEATURES]);
+}
+
+/**
+ * Combine the features of a position into a score.
+ *
+ * @param weights the weights of the features
+ * @param features the features of the position
+ * @return the score of the position for the player to move
+ */
+gint
+eval_score (const EvalWeights *weights, const gint16 *features)
+{
+  gint score = 0;
+  guint i;
+  for (i = 0; i < EVAL_NUM_FEATURES; i++)
+    score += weights->w[i] * features[i];
+  return score;
+}
+
+/**
+ * Evaluate a position with the given weights.
+ *
+ * @param weights the weights of the features
+ * @param state the position to evaluate
+ * @return the score of the position for the player to move, which is
+ * #EVAL_WIN or -#EVAL_WIN if the game is over
+ */
+gint
+eval_position (const EvalWeights *weights, GameState *state)
+{
+  gint16 features[EVAL_NUM_FEATURES];
+  StateKey key;
+  if (state->setup_rounds_left == 0)
+    {
+      Player winner = get_winner (state);
+      if (winner != EMPTY)
+	return (winner == state->cur_player) ? EVAL_WIN : -EVAL_WIN;
+    }
+  key = pack_state (state);
+  eval_extract_one (key, features);
+  return eval_score (weights, features);
+}
+
+/**
+ * Evaluate a position with #eval_weights.
+ *
+ * @param state the position to evaluate
+ * @return the score of the position for the player to move, which is
+ * #EVAL_WIN or -#EVAL_WIN if the game is over
+ */
+gint
+evaluate (GameState *state)
+{
+  return eval_position (&eval_weights, state);
+}
+
+/**
+ * Load evaluation weights from a file.
+ *
+ * @param path the weights file
+ * @param weights receives the weights.  Features that are not in the
+ * file keep their default weight.
+ * @return @a true on success, @a false if the file cannot be read or
+ * has an unknown feature or a bad weight
+ */
+bool
+eval_load_weights (const gchar *path, EvalWeights *weights)
+{
+  gchar line[256];
+  FILE *fp;
+  bool success = true;
+
+  fp = fopen (path, "r");
+  if (fp == NULL)
+    return false;
+  *weights = eval_default_weights;
+  while (success && fgets (line, sizeof (line), fp) != NULL)
+    {
+      gchar name[64];
+      long value;
+      int num_fields;
+      guint i;
+      gchar *comment = strchr (line, '#');
+      if (comment != NULL)
+	*comment = '\0';
+      num_fields = sscanf (line, "%63s %ld", name, &value);
+      if (num_fields <= 0)
+	continue;
+      success = false;
+      for (i = 0; i < EVAL_NUM_FEATURES && num_fields == 2; i++)
+	{
+	  if (!strcmp (name, eval_feature_names[i]))
+	    {
+	      weights->w[i] = value;
+	      success = true;
+	    }
+	}
+    }
+  success &= !ferror (fp);
+  fclose (fp);
+  return success;
+}
+
+/**
+ * Save evaluation weights to a file.
+ *
+ * @param path the weights file
+ * @param weights the weights to save
+ * @return @a true on success, @a false on an I/O error
+ */
+bool
+eval_save_weights (const gchar *path, const EvalWeights *weights)
+{
+  FILE *fp;
+  bool success;
+  guint i;
+  fp = fopen (path, "w");
+  if (fp == NULL)
+    return false;
+  for (i = 0; i < EVAL_NUM_FEATURES; i++)
+    fprintf (fp, "%s %d\n", eval_feature_names[i], weights->w[i]);
+  success = !ferror (fp);
+  success &= (fclose (fp) == 0);
+  return success;
+}
@@ -0,0 +1,73 @@
+/* Static evaluation of game positions.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Static evaluation of game positions.
+ */
+
+#ifndef EVAL_H
+#define EVAL_H
+
+/**
+ * The features that the evaluation is made of.  Each feature is
+ * counted for the player to move minus the same count for the
+ * opponent, except for the last two, which describe the whole
+ * position.
+ */
+enum EvalFeature_tag
+{
+  EVAL_PIECES, /**< Pieces on the board and still to be placed */
+  EVAL_MOBILITY, /**< Moves of a piece to an adjacent empty place */
+  EVAL_MILLS, /**< Formed mills */
+  EVAL_OPEN_MILLS, /**< Mills with two own pieces and an empty place */
+  EVAL_BLOCKED, /**< Pieces without an adjacent empty place */
+  EVAL_SETUP, /**< GameState::setup_rounds_left */
+  EVAL_REMOVE, /**< 1 if the player to move is about to remove a piece */
+  EVAL_NUM_FEATURES
+};
+
+/** The score of a won position.  Every other score is smaller.  */
+#define EVAL_WIN 1000000
+
+/** The weight of each feature, in hundredths of a piece.  */
+struct EvalWeights_tag
+{
+  gint32 w[EVAL_NUM_FEATURES];
+};
+typedef struct EvalWeights_tag EvalWeights;
+
+extern const char *eval_feature_names[EVAL_NUM_FEATURES];
+extern const EvalWeights eval_default_weights;
+extern EvalWeights eval_weights;
+
+void eval_extract (const StateKey *keys, gsize count, gint16 *features);
+void eval_extract_one (StateKey key, gint16 *f);
+gint eval_score (const EvalWeights *weights, const gint16 *features);
+gint eval_position (const EvalWeights *weights, GameState *state);
+gint evaluate (GameState *state);
+bool eval_load_weights (const gchar *path, EvalWeights *weights);
+bool eval_save_weights (const gchar *path, const EvalWeights *weights);
+
+#endif /* not EVAL_H */
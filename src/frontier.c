@@ -0,0 +1,710 @@
+/* Disk-backed state sets for breadth-first enumeration.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Disk-backed state sets for breadth-first enumeration.
+ *
+ * The simulator cannot keep every game state it has seen in memory,
+ * so each breadth-first search level lives on disk instead.  New
+ * states are collected in memory until a buffer fills up, and then the
+ * buffer is sorted, stripped of duplicates, and written out as a
+ * "run".  Once a level has been fully expanded, all of its runs are
+ * merged together in one streaming pass, which at the same time drops
+ * every state already present in the sorted file of visited states and
+ * writes out the next visited file.  All file access is sequential
+ * and goes through large buffers, so the disk is never asked to seek.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#include "wpthread.h"
+#else
+#include <pthread.h>
+#endif
+
+#include "morris.h"
+#include "frontier.h"
+
+struct RunSet_tag
+{
+  gchar *prefix;
+  guint num_runs;
+  guint next_run; /**< Serial number used to name the next run file */
+  pthread_mutex_t lock;
+};
+
+/********************************************************************/
+/* Key files  */
+
+static KeyStream *
+key_stream_new (const gchar *path, const char *mode, gsize buf_size)
+{
+  KeyStream *stream;
+  FILE *fp;
+  fp = fopen (path, mode);
+  if (fp == NULL)
+    return NULL;
+  stream = g_new (KeyStream, 1);
+  stream->fp = fp;
+  stream->path = g_strdup (path);
+  stream->count = 0;
+  if (buf_size == 0)
+    {
+      /* The caller reads and writes whole blocks of its own.  */
+      stream->io_buffer = NULL;
+      setvbuf (fp, NULL, _IONBF, 0);
+      return stream;
+    }
+  if (buf_size < MIN_IO_BUFFER)
+    buf_size = MIN_IO_BUFFER;
+  stream->io_buffer = g_malloc (buf_size);
+  setvbuf (fp, stream->io_buffer, _IOFBF, buf_size);
+  return stream;
+}
+
+/**
+ * Open a key file for reading.
+ *
+ * @param path the file to read
+ * @param buf_size the size of the I/O buffer to read through, or 0 to
+ * read without buffering
+ * @return a new key stream, or @a NULL if the file could not be opened
+ */
+KeyStream *
+key_stream_open (const gchar *path, gsize buf_size)
+{
+  return key_stream_new (path, "rb", buf_size);
+}
+
+/**
+ * Create or truncate a key file for writing.
+ *
+ * @param path the file to write
+ * @param buf_size the size of the I/O buffer to write through, or 0
+ * to write without buffering
+ * @return a new key stream, or @a NULL if the file could not be created
+ */
+KeyStream *
+key_stream_create (const gchar *path, gsize buf_size)
+{
+  return key_stream_new (path, "wb", buf_size);
+}
+
+/**
+ * Read keys from a key file.
+ *
+ * @param stream the key stream to read from
+ * @param keys the array that receives the keys
+ * @param count the maximum number of keys to read
+ * @return the number of keys read, which is zero at the end of the
+ * file
+ */
+gsize
+key_stream_read (KeyStream *stream, StateKey *keys, gsize count)
+{
+  gsize num_read;
+  num_read = fread (keys, sizeof (StateKey), count, stream->fp);
+  stream->count += num_read;
+  return num_read;
+}
+
+/**
+ * Append keys to a key file.
+ *
+ * @param stream the key stream to write to
+ * @param keys the keys to write
+ * @param count the number of keys to write
+ * @return @a true on success, @a false on a write error
+ */
+bool
+key_stream_write (KeyStream *stream, const StateKey *keys, gsize count)
+{
+  if (fwrite (keys, sizeof (StateKey), count, stream->fp) != count)
+    return false;
+  stream->count += count;
+  return true;
+}
+
+/**
+ * Close a key stream and free it.
+ *
+ * @param stream the key stream to close
+ * @return @a true if all buffered data was written successfully
+ */
+bool
+key_stream_close (KeyStream *stream)
+{
+  bool success;
+  success = (fclose (stream->fp) == 0);
+  g_free (stream->io_buffer);
+  g_free (stream->path);
+  g_free (stream);
+  return success;
+}
+
+/**
+ * Build the path of a level file or a visited file.
+ *
+ * @param dir the simulator's work directory
+ * @param kind either "level" or "visited"
+ * @param level the breadth-first search level
+ * @return the newly allocated path
+ */
+gchar *
+frontier_path (const gchar *dir, const char *kind, guint level)
+{
+  gchar *name, *path;
+  name = g_strdup_printf ("%s-%04u.keys", kind, level);
+  path = g_build_filename (dir, name, NULL);
+  g_free (name);
+  return path;
+}
+
+/**
+ * Write a whole key file at once.
+ *
+ * @param path the file to write
+ * @param keys the keys to write
+ * @param count the number of keys
+ * @return @a true on success, @a false on an I/O error
+ */
+bool
+write_key_file (const gchar *path, const StateKey *keys, gsize count)
+{
+  KeyStream *stream;
+  bool success;
+  stream = key_stream_create (path, MIN_IO_BUFFER);
+  if (stream == NULL)
+    return false;
+  success = key_stream_write (stream, keys, count);
+  success &= key_stream_close (stream);
+  return success;
+}
+
+/**
+ * Find out how many keys a key file holds without reading it.
+ *
+ * @param path the key file
+ * @return the number of keys, or 0 if the file does not exist
+ */
+guint64
+key_file_count (const gchar *path)
+{
+  struct stat st;
+  if (g_stat (path, &st) != 0)
+    return 0;
+  return st.st_size / sizeof (StateKey);
+}
+
+/********************************************************************/
+/* In-memory sorting  */
+
+/**
+ * Sort an array of keys and remove duplicates from it.
+ *
+ * This is a least significant digit radix sort over the 54 bits that
+ * a ::StateKey uses.  Digits that are the same in every key are
+ * skipped, which is common for the upper bits within one search
+ * level.
+ *
+ * @param keys the keys to sort, which also receive the result
+ * @param scratch a scratch array at least as large as @a keys
+ * @param count the number of keys
+ * @return the number of unique keys left at the front of @a keys
+ */
+gsize
+sort_unique_keys (StateKey *keys, StateKey *scratch, gsize count)
+{
+  StateKey *src = keys, *dest = scratch;
+  guint shift;
+  gsize i, num_unique;
+
+  if (count == 0)
+    return 0;
+
+  for (shift = 0; shift < 56; shift += 8)
+    {
+      gsize offsets[256];
+      memset (offsets, 0, sizeof (offsets));
+      for (i = 0; i < count; i++)
+	offsets[(src[i] >> shift) & 0xff]++;
+      if (offsets[(src[0] >> shift) & 0xff] == count)
+	continue;
+      {
+	gsize total = 0;
+	guint digit;
+	for (digit = 0; digit < 256; digit++)
+	  {
+	    gsize bucket = offsets[digit];
+	    offsets[digit] = total;
+	    total += bucket;
+	  }
+      }
+      for (i = 0; i < count; i++)
+	dest[offsets[(src[i] >> shift) & 0xff]++] = src[i];
+      {
+	StateKey *temp = src;
+	src = dest;
+	dest = temp;
+      }
+    }
+
+  num_unique = 1;
+  keys[0] = src[0];
+  for (i = 1; i < count; i++)
+    {
+      if (src[i] != keys[num_unique-1])
+	keys[num_unique++] = src[i];
+    }
+  return num_unique;
+}
+
+/********************************************************************/
+/* Streaming merge  */
+
+struct MergeInput_tag
+{
+  KeyStream *stream;
+  StateKey *block;
+  gsize len;
+  gsize pos;
+};
+typedef struct MergeInput_tag MergeInput;
+
+/** A key file that a merge writes a block at a time.  */
+struct MergeOutput_tag
+{
+  KeyStream *stream;
+  StateKey *block;
+  gsize len;
+};
+typedef struct MergeOutput_tag MergeOutput;
+
+/* Append a key to a merge output, writing out the block when it is
+   full.  */
+static bool
+merge_output_put (MergeOutput *output, StateKey key, gsize block_keys)
+{
+  output->block[output->len++] = key;
+  if (output->len < block_keys)
+    return true;
+  output->len = 0;
+  return key_stream_write (output->stream, output->block, block_keys);
+}
+
+/* Write out the keys left in the block of a merge output.  */
+static bool
+merge_output_flush (MergeOutput *output)
+{
+  gsize len = output->len;
+  output->len = 0;
+  return key_stream_write (output->stream, output->block, len);
+}
+
+static bool
+merge_input_fill (MergeInput *input, gsize block_keys)
+{
+  input->len = key_stream_read (input->stream, input->block, block_keys);
+  input->pos = 0;
+  return input->len > 0;
+}
+
+/* Restore the heap property at `pos' of a min-heap of inputs ordered
+   by their current key.  */
+static void
+sift_down (MergeInput **heap, guint heap_size, guint pos)
+{
+  while (1)
+    {
+      guint child = pos * 2 + 1;
+      MergeInput *temp;
+      if (child >= heap_size)
+	break;
+      if (child + 1 < heap_size &&
+	  heap[child+1]->block[heap[child+1]->pos] <
+	  heap[child]->block[heap[child]->pos])
+	child++;
+      if (heap[pos]->block[heap[pos]->pos] <=
+	  heap[child]->block[heap[child]->pos])
+	break;
+      temp = heap[pos];
+      heap[pos] = heap[child];
+      heap[child] = temp;
+      pos = child;
+    }
+}
+
+/**
+ * Merge sorted key files into one sorted, duplicate-free key file.
+ *
+ * If @a visited_path is given, keys found in that file are dropped
+ * from the output, and the union of the visited file and the output
+ * is written to @a new_visited_path.
+ *
+ * Every file is read or written a block of @a buf_size bytes at a
+ * time without any other buffering, so the merge uses one block for
+ * each input and for the output, and two more blocks for the visited
+ * files if they are given.
+ *
+ * @return the number of keys written to @a out_path, or -1 on an I/O
+ * error
+ */
+static gint64
+merge_files (gchar **paths, guint num_paths, const gchar *visited_path,
+	     const gchar *out_path, const gchar *new_visited_path,
+	     gsize buf_size)
+{
+  MergeInput *inputs;
+  MergeInput **heap;
+  guint heap_size = 0;
+  gsize block_keys;
+  MergeOutput out, new_visited;
+  KeyStream *visited = NULL;
+  StateKey *visited_block = NULL;
+  gsize visited_len = 0, visited_pos = 0;
+  StateKey last_key = 0;
+  bool have_last = false;
+  bool success = true;
+  gint64 num_written;
+  guint i;
+
+  block_keys = MAX (buf_size / sizeof (StateKey), 1);
+  inputs = g_new0 (MergeInput, num_paths);
+  heap = g_new (MergeInput *, num_paths);
+  for (i = 0; i < num_paths; i++)
+    {
+      inputs[i].stream = key_stream_open (paths[i], 0);
+      if (inputs[i].stream == NULL)
+	{
+	  success = false;
+	  continue;
+	}
+      inputs[i].block = g_new (StateKey, block_keys);
+      if (merge_input_fill (&inputs[i], block_keys))
+	heap[heap_size++] = &inputs[i];
+    }
+  for (i = heap_size / 2; i-- > 0; )
+    sift_down (heap, heap_size, i);
+
+  memset (&out, 0, sizeof (out));
+  memset (&new_visited, 0, sizeof (new_visited));
+  out.stream = key_stream_create (out_path, 0);
+  if (out.stream == NULL)
+    success = false;
+  out.block = g_new (StateKey, block_keys);
+  if (visited_path != NULL)
+    {
+      visited = key_stream_open (visited_path, 0);
+      new_visited.stream = key_stream_create (new_visited_path, 0);
+      if (new_visited.stream == NULL)
+	success = false;
+      new_visited.block = g_new (StateKey, block_keys);
+      visited_block = g_new (StateKey, block_keys);
+      if (visited != NULL)
+	visited_len = key_stream_read (visited, visited_block, block_keys);
+    }
+
+  while (success && heap_size > 0)
+    {
+      MergeInput *top = heap[0];
+      StateKey key = top->block[top->pos];
+
+      if (++top->pos >= top->len && !merge_input_fill (top, block_keys))
+	heap[0] = heap[--heap_size];
+      sift_down (heap, heap_size, 0);
+
+      if (have_last && key == last_key)
+	continue;
+      last_key = key;
+      have_last = true;
+
+      if (visited_path != NULL)
+	{
+	  /* Copy visited keys that come first, and skip this key if it
+	     has been visited already.  */
+	  bool seen = false;
+	  while (visited_len > 0)
+	    {
+	      StateKey old_key = visited_block[visited_pos];
+	      if (old_key > key)
+		break;
+	      seen = (old_key == key);
+	      success &= merge_output_put (&new_visited, old_key,
+					   block_keys);
+	      if (++visited_pos >= visited_len)
+		{
+		  visited_len = key_stream_read (visited, visited_block,
+						 block_keys);
+		  visited_pos = 0;
+		}
+	      if (seen)
+		break;
+	    }
+	  if (seen)
+	    continue;
+	  success &= merge_output_put (&new_visited, key, block_keys);
+	}
+      success &= merge_output_put (&out, key, block_keys);
+    }
+
+  if (visited_path != NULL)
+    {
+      /* Copy over the visited keys past the last new key.  */
+      if (success)
+	success &= merge_output_flush (&new_visited);
+      while (success && visited_len > 0)
+	{
+	  success &= key_stream_write (new_visited.stream,
+				       visited_block + visited_pos,
+				       visited_len - visited_pos);
+	  visited_len = key_stream_read (visited, visited_block, block_keys);
+	  visited_pos = 0;
+	}
+      if (visited != NULL)
+	key_stream_close (visited);
+      if (new_visited.stream != NULL)
+	success &= key_stream_close (new_visited.stream);
+      g_free (new_visited.block);
+      g_free (visited_block);
+    }
+
+  for (i = 0; i < num_paths; i++)
+    {
+      if (inputs[i].stream != NULL)
+	key_stream_close (inputs[i].stream);
+      g_free (inputs[i].block);
+    }
+  g_free (inputs);
+  g_free (heap);
+
+  if (out.stream == NULL)
+    {
+      g_free (out.block);
+      return -1;
+    }
+  if (success)
+    success &= merge_output_flush (&out);
+  num_written = out.stream->count;
+  success &= key_stream_close (out.stream);
+  g_free (out.block);
+  return success ? num_written : -1;
+}
+
+/********************************************************************/
+/* Run sets  */
+
+static gchar *
+run_set_path (RunSet *set, guint run)
+{
+  return g_strdup_printf ("%s-%06u.run", set->prefix, run);
+}
+
+/**
+ * Create an empty run set.
+ *
+ * @param prefix the path prefix used to name the run files
+ * @return a new run set
+ */
+RunSet *
+run_set_new (const gchar *prefix)
+{
+  RunSet *set;
+  set = g_new (RunSet, 1);
+  set->prefix = g_strdup (prefix);
+  set->num_runs = 0;
+  set->next_run = 0;
+  pthread_mutex_init (&set->lock, NULL);
+  return set;
+}
+
+/**
+ * Sort a buffer of keys and write it to disk as a new run.
+ *
+ * This function may be called from several threads at once.
+ *
+ * @param set the run set to add to
+ * @param keys the keys to write, which are sorted in place
+ * @param scratch a scratch array at least as large as @a keys
+ * @param count the number of keys
+ * @return @a true on success, @a false on an I/O error
+ */
+bool
+run_set_add (RunSet *set, StateKey *keys, StateKey *scratch, gsize count)
+{
+  KeyStream *stream;
+  gchar *path;
+  guint run;
+  bool success;
+
+  count = sort_unique_keys (keys, scratch, count);
+  if (count == 0)
+    return true;
+
+  pthread_mutex_lock (&set->lock);
+  run = set->next_run++;
+  pthread_mutex_unlock (&set->lock);
+
+  path = run_set_path (set, run);
+  stream = key_stream_create (path, MIN_IO_BUFFER);
+  g_free (path);
+  if (stream == NULL)
+    return false;
+  success = key_stream_write (stream, keys, count);
+  success &= key_stream_close (stream);
+
+  pthread_mutex_lock (&set->lock);
+  set->num_runs++;
+  pthread_mutex_unlock (&set->lock);
+  return success;
+}
+
+/**
+ * Get the number of runs written to a run set so far.
+ */
+guint
+run_set_length (RunSet *set)
+{
+  return set->num_runs;
+}
+
+/**
+ * Merge all runs of a level and subtract the visited states.
+ *
+ * If there are more runs than can be merged at once within the
+ * memory budget, groups of runs are merged into larger runs first.
+ * The run files are deleted as they are consumed.
+ *
+ * @param set the run set holding the unmerged level
+ * @param visited_path the sorted file of all states visited so far,
+ * which need not exist yet
+ * @param level_path the file that receives the new, unvisited states
+ * @param new_visited_path the file that receives the union of the
+ * visited states and the new states
+ * @param mem_budget the total amount of memory that may be used for
+ * merge buffers
+ * @return the number of new states, or -1 on an I/O error
+ */
+gint64
+run_set_merge (RunSet *set, const gchar *visited_path,
+	       const gchar *level_path, const gchar *new_visited_path,
+	       gsize mem_budget)
+{
+  guint max_fan_in;
+  gchar **paths;
+  guint num_paths, i;
+  gint64 result;
+
+  /* The final merge needs a block for each run plus three more for the
+     output and the visited files, and blocks of less than
+     MIN_IO_BUFFER would make the reads too small.  */
+  max_fan_in = mem_budget / MIN_IO_BUFFER;
+  if (max_fan_in > 3)
+    max_fan_in -= 3;
+  if (max_fan_in < 2)
+    max_fan_in = 2;
+
+  num_paths = set->next_run;
+  paths = g_new (gchar *, num_paths + 1);
+  for (i = 0; i < num_paths; i++)
+    paths[i] = run_set_path (set, i);
+
+  /* Write out empty runs as zero length files, so that every path can
+     be opened.  */
+  for (i = 0; i < num_paths; i++)
+    {
+      FILE *fp = fopen (paths[i], "ab");
+      if (fp != NULL)
+	fclose (fp);
+    }
+
+  while (num_paths > max_fan_in)
+    {
+      guint num_merged = 0;
+      for (i = 0; i < num_paths; i += max_fan_in)
+	{
+	  guint group = MIN (max_fan_in, num_paths - i);
+	  gchar *merged_path;
+	  guint j;
+	  merged_path = run_set_path (set, set->next_run++);
+	  result = merge_files (paths + i, group, NULL, merged_path, NULL,
+				mem_budget / (group + 1));
+	  for (j = i; j < i + group; j++)
+	    {
+	      g_unlink (paths[j]);
+	      g_free (paths[j]);
+	    }
+	  paths[num_merged++] = merged_path;
+	  if (result < 0)
+	    {
+	      for (j = 0; j < num_merged; j++)
+		g_free (paths[j]);
+	      for (j = i + group; j < num_paths; j++)
+		g_free (paths[j]);
+	      g_free (paths);
+	      return -1;
+	    }
+	}
+      num_paths = num_merged;
+    }
+
+  result = merge_files (paths, num_paths, visited_path, level_path,
+			new_visited_path, mem_budget / (num_paths + 3));
+  for (i = 0; i < num_paths; i++)
+    {
+      g_unlink (paths[i]);
+      g_free (paths[i]);
+    }
+  g_free (paths);
+  set->num_runs = 0;
+  return result;
+}
+
+/**
+ * Free a run set, deleting any remaining run files.
+ */
+void
+run_set_free (RunSet *set)
+{
+  guint i;
+  for (i = 0; i < set->next_run; i++)
+    {
+      gchar *path = run_set_path (set, i);
+      g_unlink (path);
+      g_free (path);
+    }
+  pthread_mutex_destroy (&set->lock);
+  g_free (set->prefix);
+  g_free (set);
+}
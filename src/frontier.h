@@ -0,0 +1,80 @@
+/* Disk-backed state sets for breadth-first enumeration.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Disk-backed state sets for breadth-first enumeration.
+ */
+
+#ifndef FRONTIER_H
+#define FRONTIER_H
+
+#include <stdio.h>
+
+/** The smallest I/O buffer that will be used for a key file.  */
+#define MIN_IO_BUFFER (64 * 1024)
+
+/**
+ * A sequentially read or written file of ::StateKey values.
+ *
+ * Keys are stored in host byte order, as the files are only scratch
+ * space for a single simulator run.
+ */
+struct KeyStream_tag
+{
+  FILE *fp;
+  gchar *path;
+  guint64 count; /**< Number of keys read or written so far */
+  gchar *io_buffer;
+};
+typedef struct KeyStream_tag KeyStream;
+
+/**
+ * A set of sorted, duplicate-free runs that together hold one
+ * breadth-first search level before it has been merged.
+ */
+typedef struct RunSet_tag RunSet;
+
+gchar *frontier_path (const gchar *dir, const char *kind, guint level);
+bool write_key_file (const gchar *path, const StateKey *keys, gsize count);
+guint64 key_file_count (const gchar *path);
+
+KeyStream *key_stream_open (const gchar *path, gsize buf_size);
+KeyStream *key_stream_create (const gchar *path, gsize buf_size);
+gsize key_stream_read (KeyStream *stream, StateKey *keys, gsize count);
+bool key_stream_write (KeyStream *stream, const StateKey *keys,
+		       gsize count);
+bool key_stream_close (KeyStream *stream);
+
+gsize sort_unique_keys (StateKey *keys, StateKey *scratch, gsize count);
+
+RunSet *run_set_new (const gchar *prefix);
+bool run_set_add (RunSet *set, StateKey *keys, StateKey *scratch,
+		  gsize count);
+guint run_set_length (RunSet *set);
+gint64 run_set_merge (RunSet *set, const gchar *visited_path,
+		      const gchar *level_path, const gchar *new_visited_path,
+		      gsize mem_budget);
+void run_set_free (RunSet *set);
+
+#endif /* not FRONTIER_H */
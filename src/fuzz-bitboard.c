@@ -0,0 +1,347 @@
+/* An independent bitboard rules engine for differential fuzzing.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * An independent bitboard rules engine for differential fuzzing.
+ *
+ * This engine shares no code and no tables with morris.c, so that a
+ * mistake in one of them shows up as a disagreement rather than being
+ * repeated.  Each player's pieces are kept in a 24-bit mask, with bit
+ * N standing for board position N.  The mills are written out as
+ * lists of positions from the board diagram in tables.h, and the
+ * adjacency of positions is derived from the mills, since two
+ * positions are adjacent exactly when they are next to each other in
+ * some mill.
+ *
+ * The engine follows morris.c where the rules leave room for choice.
+ * In particular, play_move() only checks the move itself, like
+ * place_piece() and friends do, and not whether that kind of move is
+ * allowed in the current phase of the game.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <string.h>
+#include <glib.h>
+
+#include "morris.h"
+#include "fuzz.h"
+
+#if HAVE_DIAGONALS
+#  define NUM_MILLS 20
+#else
+#  define NUM_MILLS 16
+#endif
+
+struct BitState_tag
+{
+  guint32 pieces[NUM_PLAYERS]; /**< Position masks of each player */
+  Player cur_player;
+  guchar setup_rounds_left;
+  bool remove_state;
+};
+typedef struct BitState_tag BitState;
+
+static const guchar mills[NUM_MILLS][3] = {
+  /* Horizontal lines.  */
+  { 0, 1, 2 }, { 3, 4, 5 }, { 6, 7, 8 }, { 9, 10, 11 },
+  { 12, 13, 14 }, { 15, 16, 17 }, { 18, 19, 20 }, { 21, 22, 23 },
+  /* Vertical lines.  */
+  { 0, 9, 21 }, { 3, 10, 18 }, { 6, 11, 15 }, { 1, 4, 7 },
+  { 16, 19, 22 }, { 8, 12, 17 }, { 5, 13, 20 }, { 2, 14, 23 },
+#if HAVE_DIAGONALS
+  /* Diagonal lines in the corners.  */
+  { 0, 3, 6 }, { 2, 5, 8 }, { 21, 18, 15 }, { 23, 20, 17 }
+#endif
+};
+
+static guint32 mill_bits[NUM_MILLS];
+static guint32 neighbors[BOARD_SIZE];
+static bool tables_ready = false;
+
+static void
+init_tables (void)
+{
+  guint i;
+  if (tables_ready)
+    return;
+  for (i = 0; i < NUM_MILLS; i++)
+    {
+      const guchar *mill = mills[i];
+      mill_bits[i] = 1 << mill[0] | 1 << mill[1] | 1 << mill[2];
+      neighbors[mill[0]] |= 1 << mill[1];
+      neighbors[mill[1]] |= 1 << mill[0] | 1 << mill[2];
+      neighbors[mill[2]] |= 1 << mill[1];
+    }
+  tables_ready = true;
+}
+
+static Player
+bit_board_ref (void *state, guchar pos)
+{
+  BitState *bits = (BitState *) state;
+  if (bits->pieces[0] & 1 << pos)
+    return PLAYER1;
+  if (bits->pieces[1] & 1 << pos)
+    return PLAYER2;
+  return EMPTY;
+}
+
+/* Get the positions of a player's pieces that are in a mill.  */
+static guint32
+pieces_in_mills (guint32 pieces)
+{
+  guint32 result = 0;
+  guint i;
+  for (i = 0; i < NUM_MILLS; i++)
+    {
+      if ((pieces & mill_bits[i]) == mill_bits[i])
+	result |= mill_bits[i];
+    }
+  return result;
+}
+
+/* Get the positions that the current player's piece at the given
+   position may move to, ignoring whether they are empty.  */
+static guint32
+reachable (BitState *bits, guchar pos)
+{
+  if (FLYING_RULE && bits->setup_rounds_left == 0 &&
+      __builtin_popcount (bits->pieces[bits->cur_player-1]) ==
+      FLYING_PIECES)
+    return (1 << BOARD_SIZE) - 1;
+  return neighbors[pos];
+}
+
+static void
+bit_init_game_state (void *state)
+{
+  BitState *bits = (BitState *) state;
+  init_tables ();
+  memset (bits, 0, sizeof (BitState));
+  bits->cur_player = PLAYER1;
+  bits->setup_rounds_left = NUM_MEN;
+  bits->remove_state = false;
+}
+
+static void
+bit_unpack_state (StateKey key, void *state)
+{
+  BitState *bits = (BitState *) state;
+  guint pos;
+  init_tables ();
+  memset (bits, 0, sizeof (BitState));
+  for (pos = 0; pos < BOARD_SIZE; pos++)
+    {
+      Player player = (key >> (pos * 2)) & 0x03;
+      if (player == PLAYER1 || player == PLAYER2)
+	bits->pieces[player-1] |= 1 << pos;
+    }
+  bits->setup_rounds_left = (key >> 48) & 0x0f;
+  bits->remove_state = (key >> 52) & 0x01;
+  bits->cur_player = ((key >> 53) & 0x01) ? PLAYER2 : PLAYER1;
+}
+
+static StateKey
+bit_pack_state (void *state)
+{
+  BitState *bits = (BitState *) state;
+  StateKey key = 0;
+  guint pos;
+  for (pos = 0; pos < BOARD_SIZE; pos++)
+    key |= (StateKey) bit_board_ref (state, pos) << (pos * 2);
+  key |= (StateKey) bits->setup_rounds_left << 48;
+  key |= (StateKey) (bits->remove_state ? 1 : 0) << 52;
+  key |= (StateKey) (bits->cur_player == PLAYER2 ? 1 : 0) << 53;
+  return key;
+}
+
+static bool
+bit_is_valid_place (void *state, guchar pos)
+{
+  return bit_board_ref (state, pos) == EMPTY;
+}
+
+static bool
+bit_is_valid_move (void *state, guchar src, guchar dest)
+{
+  BitState *bits = (BitState *) state;
+  return (reachable (bits, src) & 1 << dest) &&
+    bit_board_ref (state, src) == bits->cur_player &&
+    bit_board_ref (state, dest) == EMPTY;
+}
+
+static bool
+bit_is_valid_remove (void *state, guchar pos)
+{
+  BitState *bits = (BitState *) state;
+  Player owner = bit_board_ref (state, pos);
+  guint32 opp_pieces, protected;
+  if (owner == EMPTY || owner == bits->cur_player)
+    return false;
+  /* Pieces in mills are safe, unless every piece is in a mill.  */
+  opp_pieces = bits->pieces[owner-1];
+  protected = pieces_in_mills (opp_pieces);
+  if (protected == opp_pieces)
+    return true;
+  return !(protected & 1 << pos);
+}
+
+static bool
+bit_is_mill_formed (void *state, guchar pos)
+{
+  BitState *bits = (BitState *) state;
+  if (bit_board_ref (state, pos) != bits->cur_player)
+    return false;
+  return (pieces_in_mills (bits->pieces[bits->cur_player-1]) &
+	  1 << pos) != 0;
+}
+
+static Player
+bit_get_winner (void *state)
+{
+  BitState *bits = (BitState *) state;
+  if (__builtin_popcount (bits->pieces[0]) == 2)
+    return PLAYER2;
+  if (__builtin_popcount (bits->pieces[1]) == 2)
+    return PLAYER1;
+  return EMPTY;
+}
+
+static guint
+bit_gen_moves (void *state, Move *moves)
+{
+  BitState *bits = (BitState *) state;
+  guint32 empty = ~(bits->pieces[0] | bits->pieces[1]) &
+    ((1 << BOARD_SIZE) - 1);
+  guint num_moves = 0;
+  guchar pos, dest;
+
+  if (bits->setup_rounds_left == 0 && bit_get_winner (state) != EMPTY)
+    return 0;
+
+  for (pos = 0; pos < BOARD_SIZE; pos++)
+    {
+      if (bits->remove_state)
+	{
+	  if (bit_is_valid_remove (state, pos))
+	    {
+	      moves[num_moves].type = MOVE_REMOVE;
+	      moves[num_moves].src = 0;
+	      moves[num_moves++].dest = pos;
+	    }
+	}
+      else if (bits->setup_rounds_left > 0)
+	{
+	  if (empty & 1 << pos)
+	    {
+	      moves[num_moves].type = MOVE_PLACE;
+	      moves[num_moves].src = 0;
+	      moves[num_moves++].dest = pos;
+	    }
+	}
+      else if (bits->pieces[bits->cur_player-1] & 1 << pos)
+	{
+	  for (dest = 0; dest < BOARD_SIZE; dest++)
+	    {
+	      if (reachable (bits, pos) & empty & 1 << dest)
+		{
+		  moves[num_moves].type = MOVE_MOVE;
+		  moves[num_moves].src = pos;
+		  moves[num_moves++].dest = dest;
+		}
+	    }
+	}
+    }
+  return num_moves;
+}
+
+/* End the current player's turn, or start a removal if a mill was
+   formed at the given position.  */
+static void
+finish_move (BitState *bits, guchar pos)
+{
+  if (bit_is_mill_formed (bits, pos))
+    bits->remove_state = true;
+  else
+    bits->cur_player = (bits->cur_player == PLAYER1) ? PLAYER2 : PLAYER1;
+}
+
+static bool
+bit_play_move (void *state, Move *move)
+{
+  BitState *bits = (BitState *) state;
+  guint32 *own = &bits->pieces[bits->cur_player-1];
+
+  switch (move->type)
+    {
+    case MOVE_PLACE:
+      if (!bit_is_valid_place (state, move->dest))
+	return false;
+      *own |= 1 << move->dest;
+      finish_move (bits, move->dest);
+      break;
+    case MOVE_MOVE:
+      if (!bit_is_valid_move (state, move->src, move->dest))
+	return false;
+      *own &= ~(1 << move->src);
+      *own |= 1 << move->dest;
+      finish_move (bits, move->dest);
+      break;
+    case MOVE_REMOVE:
+      if (!bit_is_valid_remove (state, move->dest))
+	return false;
+      bits->pieces[0] &= ~(1 << move->dest);
+      bits->pieces[1] &= ~(1 << move->dest);
+      bits->remove_state = false;
+      bits->cur_player = (bits->cur_player == PLAYER1) ? PLAYER2 : PLAYER1;
+      break;
+    default:
+      return false;
+    }
+  /* A round of setup is over once both players have placed.  */
+  if (bits->setup_rounds_left > 0 && !bits->remove_state &&
+      bits->cur_player == PLAYER1)
+    bits->setup_rounds_left--;
+  return true;
+}
+
+const FuzzEngine fuzz_bitboard_engine = {
+  "bitboard",
+  sizeof (BitState),
+  bit_init_game_state,
+  bit_unpack_state,
+  bit_pack_state,
+  bit_gen_moves,
+  bit_play_move,
+  bit_board_ref,
+  bit_is_valid_place,
+  bit_is_valid_move,
+  bit_is_valid_remove,
+  bit_is_mill_formed,
+  bit_get_winner
+};
@@ -0,0 +1,151 @@
+/* Wrap a build of morris.c as a fuzzing engine.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Wrap a build of morris.c as a fuzzing engine.
+ *
+ * morris.c is built for a single board layout, chosen by USE_PACKED
+ * and HAVE_X86_ASM.  To get several layouts into one fuzzer, each
+ * engine source file sets up these macros and then includes this
+ * file, which includes morris.c itself.  Every global function of
+ * morris.c is renamed with FUZZ_PREFIX() first, so the copies do not
+ * clash.  The tables are static, so every engine has its own copy.
+ * The including file must also define FUZZ_ENGINE to the name of the
+ * ::FuzzEngine to define and FUZZ_ENGINE_NAME to its display name.
+ *
+ * config.h must not be included again by morris.c, or it would undo
+ * the choice of layout, so HAVE_CONFIG_H must be undefined before
+ * this file is included.
+ */
+
+/* Functions from morris.c.  */
+#define board_ref FUZZ_PREFIX (board_ref)
+#define set_board_pos FUZZ_PREFIX (set_board_pos)
+#define get_opponent FUZZ_PREFIX (get_opponent)
+#define are_adjacent FUZZ_PREFIX (are_adjacent)
+#define is_valid_place FUZZ_PREFIX (is_valid_place)
+#define is_valid_move FUZZ_PREFIX (is_valid_move)
+#define can_fly FUZZ_PREFIX (can_fly)
+#define player_positions FUZZ_PREFIX (player_positions)
+#define empty_neighbors FUZZ_PREFIX (empty_neighbors)
+#define count_mobility FUZZ_PREFIX (count_mobility)
+#define is_valid_remove FUZZ_PREFIX (is_valid_remove)
+#define is_mill_formed FUZZ_PREFIX (is_mill_formed)
+#define next_player FUZZ_PREFIX (next_player)
+#define place_piece FUZZ_PREFIX (place_piece)
+#define move_piece FUZZ_PREFIX (move_piece)
+#define remove_piece FUZZ_PREFIX (remove_piece)
+#define get_winner FUZZ_PREFIX (get_winner)
+#define init_game_state FUZZ_PREFIX (init_game_state)
+#define gen_moves FUZZ_PREFIX (gen_moves)
+#define play_move FUZZ_PREFIX (play_move)
+#define pack_state FUZZ_PREFIX (pack_state)
+#define is_valid_state_key FUZZ_PREFIX (is_valid_state_key)
+#define unpack_state FUZZ_PREFIX (unpack_state)
+#define hash_state_key FUZZ_PREFIX (hash_state_key)
+
+#include "morris.c"
+#include "fuzz.h"
+
+static void
+engine_init_game_state (void *state)
+{
+  init_game_state ((GameState *) state);
+}
+
+static void
+engine_unpack_state (StateKey key, void *state)
+{
+  unpack_state (key, (GameState *) state);
+}
+
+static StateKey
+engine_pack_state (void *state)
+{
+  return pack_state ((GameState *) state);
+}
+
+static guint
+engine_gen_moves (void *state, Move *moves)
+{
+  return gen_moves ((GameState *) state, moves);
+}
+
+static bool
+engine_play_move (void *state, Move *move)
+{
+  return play_move ((GameState *) state, move);
+}
+
+static Player
+engine_board_ref (void *state, guchar pos)
+{
+  return board_ref (((GameState *) state)->board, pos);
+}
+
+static bool
+engine_is_valid_place (void *state, guchar pos)
+{
+  return is_valid_place ((GameState *) state, pos);
+}
+
+static bool
+engine_is_valid_move (void *state, guchar src, guchar dest)
+{
+  return is_valid_move ((GameState *) state, src, dest);
+}
+
+static bool
+engine_is_valid_remove (void *state, guchar pos)
+{
+  return is_valid_remove ((GameState *) state, pos);
+}
+
+static bool
+engine_is_mill_formed (void *state, guchar pos)
+{
+  return is_mill_formed ((GameState *) state, pos);
+}
+
+static Player
+engine_get_winner (void *state)
+{
+  return get_winner ((GameState *) state);
+}
+
+const FuzzEngine FUZZ_ENGINE = {
+  FUZZ_ENGINE_NAME,
+  sizeof (GameState),
+  engine_init_game_state,
+  engine_unpack_state,
+  engine_pack_state,
+  engine_gen_moves,
+  engine_play_move,
+  engine_board_ref,
+  engine_is_valid_place,
+  engine_is_valid_move,
+  engine_is_valid_remove,
+  engine_is_mill_formed,
+  engine_get_winner
+};
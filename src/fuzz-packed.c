@@ -0,0 +1,41 @@
+/* The configured packed build of morris.c as a fuzzing engine.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * The configured packed build of morris.c as a fuzzing engine.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#  undef HAVE_CONFIG_H
+#endif
+
+#ifndef USE_PACKED
+#define USE_PACKED 1
+#endif
+
+#define FUZZ_PREFIX(name) packed_ ## name
+#define FUZZ_ENGINE fuzz_packed_engine
+#define FUZZ_ENGINE_NAME "packed"
+#include "fuzz-engine.h"
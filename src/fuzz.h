@@ -0,0 +1,68 @@
+/* Rules engines for differential fuzzing.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Rules engines for differential fuzzing.
+ */
+
+#ifndef FUZZ_H
+#define FUZZ_H
+
+/**
+ * A complete implementation of the game rules.
+ *
+ * The fuzzer runs the same games on every engine and checks that
+ * they all agree.  The engines store their game states in different
+ * layouts, so the states are handled through untyped pointers to
+ * buffers of FuzzEngine::state_size bytes.  Game states are exchanged
+ * between engines as ::StateKey values.
+ */
+struct FuzzEngine_tag
+{
+  const char *name;
+  gsize state_size;
+  void (*init_game_state) (void *state);
+  void (*unpack_state) (StateKey key, void *state);
+  StateKey (*pack_state) (void *state);
+  guint (*gen_moves) (void *state, Move *moves);
+  bool (*play_move) (void *state, Move *move);
+  Player (*board_ref) (void *state, guchar pos);
+  bool (*is_valid_place) (void *state, guchar pos);
+  bool (*is_valid_move) (void *state, guchar src, guchar dest);
+  bool (*is_valid_remove) (void *state, guchar pos);
+  bool (*is_mill_formed) (void *state, guchar pos);
+  Player (*get_winner) (void *state);
+};
+typedef struct FuzzEngine_tag FuzzEngine;
+
+/** morris.c with packed boards, as configured.  */
+extern const FuzzEngine fuzz_packed_engine;
+/** morris.c with packed boards and without x86 assembly.  */
+extern const FuzzEngine fuzz_portable_engine;
+/** morris.c with one byte per board position.  */
+extern const FuzzEngine fuzz_unpacked_engine;
+/** An independent engine that uses one bit mask per player.  */
+extern const FuzzEngine fuzz_bitboard_engine;
+
+#endif /* not FUZZ_H */
@@ -0,0 +1,201 @@
+/* Kernel bodies, built once for each instruction set.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Kernel bodies, built once for each instruction set.
+ *
+ * kernels.c includes this file several times, each time under a
+ * different target pragma and with KERNEL_SUFFIX() defined to give
+ * the functions distinct names.  The code is plain C written so that
+ * the compiler can use whatever the target offers: POPCNT for piece
+ * counts, BMI2 for gathering the pieces of a player out of a key, and
+ * wide vectors for the loops over batches.
+ */
+
+/* Gather the even bits of the 48-bit board into a 24-bit mask.  */
+static inline guint32
+KERNEL_SUFFIX (compress_board) (guint64 bits)
+{
+#if defined (__BMI2__) && defined (__x86_64__)
+  return _pext_u64 (bits, BOARD_EVEN_BITS);
+#else
+  bits &= BOARD_EVEN_BITS;
+  bits = (bits | bits >> 1) & G_GUINT64_CONSTANT (0x3333333333333333);
+  bits = (bits | bits >> 2) & G_GUINT64_CONSTANT (0x0f0f0f0f0f0f0f0f);
+  bits = (bits | bits >> 4) & G_GUINT64_CONSTANT (0x00ff00ff00ff00ff);
+  bits = (bits | bits >> 8) & G_GUINT64_CONSTANT (0x0000ffff0000ffff);
+  bits = (bits | bits >> 16) & G_GUINT64_CONSTANT (0x00000000ffffffff);
+  return bits;
+#endif
+}
+
+static inline guint32
+KERNEL_SUFFIX (mills_of) (guint32 pieces)
+{
+  guint32 result = 0;
+  guint i;
+  for (i = 0; i < TOTAL_MILLS; i++)
+    result |= ((pieces & mill_bits[i]) == mill_bits[i]) ? mill_bits[i] : 0;
+  return result;
+}
+
+/* Does the piece at the given position complete a mill?  */
+static inline bool
+KERNEL_SUFFIX (forms_mill) (guint32 pieces, guint pos)
+{
+  const guint32 *mills = pos_mill_bits[pos];
+  return (pieces & mills[0]) == mills[0] ||
+    (pieces & mills[1]) == mills[1] ||
+    (pieces & mills[2]) == mills[2];
+}
+
+static guint
+KERNEL_SUFFIX (expand_key) (StateKey key, StateKey *children)
+{
+  guint64 board = key & BOARD_BITS;
+  guint setup = (key >> 48) & 0x0f;
+  guint cur = (key >> 53) & 0x01; /* 0 for player 1, 1 for player 2 */
+  guint32 pieces[NUM_PLAYERS], own, opp, empty;
+  guint64 piece_value = cur + 1;
+  StateKey pass_header, mill_header;
+  guint num_children = 0;
+
+  pieces[0] = KERNEL_SUFFIX (compress_board) (board);
+  pieces[1] = KERNEL_SUFFIX (compress_board) (board >> 1);
+  if (setup == 0 && (__builtin_popcount (pieces[0]) == 2 ||
+		     __builtin_popcount (pieces[1]) == 2))
+    return 0;
+  own = pieces[cur];
+  opp = pieces[cur ^ 1];
+  empty = ~(pieces[0] | pieces[1]) & BOARD_MASK;
+
+  /* The header bits of a child where the turn passes to the other
+     player, and of one where the same player goes on to remove a
+     piece.  A round of setup is over once player 1 is next.  */
+  pass_header = (StateKey) (cur ^ 1) << 53;
+  if (setup > 0)
+    pass_header |= (StateKey) (setup - (cur == 1)) << 48;
+  mill_header = (key & ~BOARD_BITS) | (StateKey) 1 << 52;
+
+  if ((key >> 52) & 0x01)
+    {
+      guint32 safe = KERNEL_SUFFIX (mills_of) (opp);
+      guint32 targets = (safe == opp) ? opp : opp & ~safe;
+      while (targets != 0)
+	{
+	  guint pos = __builtin_ctz (targets);
+	  targets &= targets - 1;
+	  children[num_children++] =
+	    (board & ~((guint64) 0x03 << (pos * 2))) | pass_header;
+	}
+    }
+  else if (setup > 0)
+    {
+      guint32 targets = empty;
+      while (targets != 0)
+	{
+	  guint pos = __builtin_ctz (targets);
+	  targets &= targets - 1;
+	  children[num_children++] = (board | piece_value << (pos * 2)) |
+	    (KERNEL_SUFFIX (forms_mill) (own | 1 << pos, pos) ?
+	     mill_header : pass_header);
+	}
+    }
+  else
+    {
+      guint32 sources = own;
+      bool flying = FLYING_RULE && __builtin_popcount (own) == FLYING_PIECES;
+      while (sources != 0)
+	{
+	  guint src = __builtin_ctz (sources);
+	  guint32 dests = flying ? empty : neighbor_mask[src] & empty;
+	  guint64 from_board = board & ~((guint64) 0x03 << (src * 2));
+	  guint32 from_pieces = own & ~(1 << src);
+	  sources &= sources - 1;
+	  while (dests != 0)
+	    {
+	      guint dest = __builtin_ctz (dests);
+	      dests &= dests - 1;
+	      children[num_children++] =
+		(from_board | piece_value << (dest * 2)) |
+		(KERNEL_SUFFIX (forms_mill) (from_pieces | 1 << dest, dest) ?
+		 mill_header : pass_header);
+	    }
+	}
+    }
+  return num_children;
+}
+
+static gsize
+KERNEL_SUFFIX (expand_keys) (const StateKey *keys, gsize count,
+			     StateKey *children, guint *num_children)
+{
+  gsize total = 0, i;
+  for (i = 0; i < count; i++)
+    {
+      num_children[i] = KERNEL_SUFFIX (expand_key) (keys[i],
+						    children + total);
+      total += num_children[i];
+    }
+  return total;
+}
+
+static void
+KERNEL_SUFFIX (hash_keys) (const StateKey *keys, guint64 *hashes,
+			   gsize count)
+{
+  gsize i;
+  for (i = 0; i < count; i++)
+    {
+      guint64 key = keys[i];
+      key ^= key >> 33;
+      key *= G_GUINT64_CONSTANT (0xff51afd7ed558ccd);
+      key ^= key >> 33;
+      key *= G_GUINT64_CONSTANT (0xc4ceb9fe1a85ec53);
+      key ^= key >> 33;
+      hashes[i] = key;
+    }
+}
+
+static void
+KERNEL_SUFFIX (mill_scan) (const StateKey *keys, guint32 *mills,
+			   gsize count)
+{
+  gsize i;
+  for (i = 0; i < count; i++)
+    {
+      guint64 board = keys[i] & BOARD_BITS;
+      mills[i] =
+	KERNEL_SUFFIX (mills_of) (KERNEL_SUFFIX (compress_board) (board)) |
+	KERNEL_SUFFIX (mills_of) (KERNEL_SUFFIX (compress_board)
+				  (board >> 1));
+    }
+}
+
+static const Kernels KERNEL_SUFFIX (kernels) = {
+  KERNEL_NAME,
+  KERNEL_SUFFIX (expand_keys),
+  KERNEL_SUFFIX (hash_keys),
+  KERNEL_SUFFIX (mill_scan)
+};
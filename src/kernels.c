@@ -0,0 +1,156 @@
+/* Hot simulator kernels with runtime CPU dispatch.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Hot simulator kernels with runtime CPU dispatch.
+ *
+ * The rules code in morris.c is built for one instruction set, chosen
+ * when the program is configured, so a binary built for old machines
+ * never uses the newer instructions of the machine it runs on.  The
+ * kernels that the simulator spends its time in are therefore built
+ * several times, each for a different instruction set, and the best
+ * one that the processor supports is chosen at startup with
+ * __builtin_cpu_supports().  There are three variants on x86:
+ *
+ * - "scalar", for any processor, which on x86-64 already means SSE2
+ * - "sse4.2", which adds POPCNT
+ * - "avx2", which adds AVX2 and BMI2
+ *
+ * Other architectures only get the "scalar" variant, built for
+ * whatever the compiler targets.  The environment variable
+ * MORRIS_KERNELS can name a variant to use instead of the best one,
+ * which is useful for comparing them.
+ *
+ * The kernels use bit masks with one bit per board position, like
+ * the bitboard engine of the fuzzer, which checks that every variant
+ * agrees with morris.c.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "morris.h"
+#include "kernels.h"
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+/** The 48 bits of a ::StateKey that hold the board.  */
+#define BOARD_BITS G_GUINT64_CONSTANT (0xffffffffffff)
+/** The bits of the board that are set for player 1's pieces.  */
+#define BOARD_EVEN_BITS G_GUINT64_CONSTANT (0x555555555555)
+/** A mask of every board position.  */
+#define BOARD_MASK ((1 << BOARD_SIZE) - 1)
+
+/* The generated mill_bits, pos_mill_bits and neighbor_mask tables.  */
+#include "tables-gen.h"
+
+#define KERNEL_SUFFIX(name) name ## _scalar
+#define KERNEL_NAME "scalar"
+#include "kernels-impl.h"
+#undef KERNEL_SUFFIX
+#undef KERNEL_NAME
+
+#ifdef KERNELS_X86
+#pragma GCC push_options
+#pragma GCC target ("sse4.2,popcnt")
+#define KERNEL_SUFFIX(name) name ## _sse42
+#define KERNEL_NAME "sse4.2"
+#include "kernels-impl.h"
+#undef KERNEL_SUFFIX
+#undef KERNEL_NAME
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target ("avx2,bmi,bmi2,popcnt")
+#define KERNEL_SUFFIX(name) name ## _avx2
+#define KERNEL_NAME "avx2"
+#include "kernels-impl.h"
+#undef KERNEL_SUFFIX
+#undef KERNEL_NAME
+#pragma GCC pop_options
+#endif /* KERNELS_X86 */
+
+const Kernels *kernels = &kernels_scalar;
+
+static const Kernels *available[3];
+static guint num_available = 0;
+
+/**
+ * Choose the best kernels for this processor.
+ *
+ * This must be called before any kernels are used.
+ */
+void
+kernels_init (void)
+{
+  const char *choice = getenv ("MORRIS_KERNELS");
+  guint i;
+
+  if (num_available > 0)
+    return;
+  available[num_available++] = &kernels_scalar;
+#ifdef KERNELS_X86
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("sse4.2") && __builtin_cpu_supports ("popcnt"))
+    available[num_available++] = &kernels_sse42;
+  /* Check every extension that the avx2 kernels are compiled for;
+     the compiler uses bmi for tzcnt and blsr on its own.  */
+  if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("bmi") &&
+      __builtin_cpu_supports ("bmi2") && __builtin_cpu_supports ("popcnt"))
+    available[num_available++] = &kernels_avx2;
+#endif
+
+  kernels = available[num_available-1];
+  if (choice != NULL)
+    {
+      for (i = 0; i < num_available; i++)
+	{
+	  if (!strcmp (choice, available[i]->name))
+	    kernels = available[i];
+	}
+    }
+}
+
+/**
+ * Get every kernel variant that this processor can run.
+ *
+ * @param count receives the number of variants
+ * @return the variants, from the slowest to the fastest
+ */
+const Kernels *const *
+kernels_available (guint *count)
+{
+  kernels_init ();
+  *count = num_available;
+  return available;
+}
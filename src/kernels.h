@@ -0,0 +1,77 @@
+/* Hot simulator kernels with runtime CPU dispatch.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Hot simulator kernels with runtime CPU dispatch.
+ */
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+/**
+ * A set of kernels built for one instruction set.
+ *
+ * All kernels work directly on ::StateKey values, so that the
+ * simulator never has to unpack game states.  Every variant gives
+ * exactly the same results as the rules in morris.c; only the speed
+ * differs.
+ */
+struct Kernels_tag
+{
+  const char *name;
+  /**
+   * Generate the children of a batch of game states.
+   *
+   * The children of each state are what gen_moves() and play_move()
+   * would give, in no particular order.
+   *
+   * @param keys the game states to expand
+   * @param count the number of game states
+   * @param children receives the children of all game states, one
+   * after another, and must have room for @a count times ::MAX_MOVES
+   * keys
+   * @param num_children receives the number of children of each game
+   * state
+   * @return the total number of children
+   */
+  gsize (*expand_keys) (const StateKey *keys, gsize count,
+			StateKey *children, guint *num_children);
+  /** Compute hash_state_key() for a batch of keys.  */
+  void (*hash_keys) (const StateKey *keys, guint64 *hashes, gsize count);
+  /**
+   * Find the pieces that are in mills for a batch of game states.
+   * Bit N of each result is set if the piece on position N, of
+   * either player, is part of a mill.
+   */
+  void (*mill_scan) (const StateKey *keys, guint32 *mills, gsize count);
+};
+typedef struct Kernels_tag Kernels;
+
+/** The kernels chosen by kernels_init().  */
+extern const Kernels *kernels;
+
+void kernels_init (void);
+const Kernels *const *kernels_available (guint *count);
+
+#endif /* not KERNELS_H */
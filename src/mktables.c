@@ -0,0 +1,548 @@
+/* Generate the rule tables for the board.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Generate the rule tables for the board.
+ *
+ * Every lookup table that morris.c and the simulator kernels use is
+ * derived from two hand-written lists in this file: the pairs of
+ * adjacent places and the mills.  This program checks those lists,
+ * derives the tables in every board layout, and writes them as C
+ * source to standard output.  The build stores the result in
+ * tables-gen.h, which tables.h includes.
+ *
+ * There are two boards.  9 Mens Morris is played on the plain board,
+ * while 11 and 12 Mens Morris add the diagonal lines in the corners,
+ * with their adjacencies and four more mills.  Both are written, and
+ * HAVE_DIAGONALS from morris.h picks one when the tables are
+ * compiled.
+ *
+ * The generated tables are static, const and aligned to cache lines,
+ * so that every file that includes them can have the compiler fold
+ * them into its code.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "morris.h"
+
+/** Size of a cache line, which the tables are aligned to.  */
+#define CACHE_LINE_SIZE 64
+/** Number of symmetries of the board: the rotations and mirrors.  */
+#define NUM_SYMMETRIES 8
+/** Marks the end of a list in adjacent_places.  */
+#define NO_PLACE 99
+/** The largest number of mills on any board.  */
+#define MAX_MILLS 20
+
+/**
+ * Every pair of adjacent places.  The last eight pairs are the
+ * diagonal lines, which only the board with diagonals has.
+ */
+static const guchar adjacent_places_canonical[][2] =
+  {
+    { 0,  1}, { 1,  2}, { 2, 14}, {14, 23},
+    {23, 22}, {22, 21}, {21,  9}, { 9,  0},
+    { 3,  4}, { 4,  5}, { 5, 13}, {13, 20},
+    {20, 19}, {19, 18}, {18, 10}, {10,  3},
+    { 6,  7}, { 7,  8}, { 8, 12}, {12, 17},
+    {17, 16}, {16, 15}, {15, 11}, {11,  6},
+    { 1,  4}, { 4,  7}, {14, 13}, {13, 12},
+    {22, 19}, {19, 16}, { 9, 10}, {10, 11},
+    { 0,  3}, { 3,  6}, { 2,  5}, { 5,  8},
+    {23, 20}, {20, 17}, {21, 18}, {18, 15},
+  };
+#define NUM_ADJACENT (sizeof (adjacent_places_canonical) / 2)
+#define NUM_DIAGONAL_ADJACENT 8
+
+/**
+ * Every mill, in the order of the mill mask tables.  The last column
+ * is set for the diagonal mills.
+ */
+static const guchar mills_canonical[MAX_MILLS][4] =
+  {
+    { 0,  1,  2, 0}, { 2, 14, 23, 0}, {21, 22, 23, 0}, { 0,  9, 21, 0},
+    { 3,  4,  5, 0}, { 5, 13, 20, 0}, {18, 19, 20, 0}, { 3, 10, 18, 0},
+    { 6,  7,  8, 0}, { 8, 12, 17, 0}, {15, 16, 17, 0}, { 6, 11, 15, 0},
+    { 0,  3,  6, 1}, { 1,  4,  7, 0}, { 2,  5,  8, 1}, {12, 13, 14, 0},
+    {17, 20, 23, 1}, {16, 19, 22, 0}, {15, 18, 21, 1}, { 9, 10, 11, 0},
+  };
+
+/**
+ * The column and row of each place on a 7 by 7 grid laid over the
+ * board, which is used to find the symmetries of the board.
+ */
+static const guchar place_coords[BOARD_SIZE][2] =
+  {
+    {0, 0}, {3, 0}, {6, 0}, {1, 1}, {3, 1}, {5, 1}, {2, 2}, {3, 2},
+    {4, 2}, {0, 3}, {1, 3}, {2, 3}, {4, 3}, {5, 3}, {6, 3}, {2, 4},
+    {3, 4}, {4, 4}, {1, 5}, {3, 5}, {5, 5}, {0, 6}, {3, 6}, {6, 6},
+  };
+
+/** The board diagram from tables.h, used to draw the mill masks.  */
+static const char *const board_diagram[] =
+  {
+    "    0-----------1-----------2",
+    "    | \\         |         / |",
+    "    |  \\3-------4-------5/  |",
+    "    |   |\\      |     / |   |",
+    "    |   | \\ 6---7---8/  |   |",
+    "    |   |   |       |   |   |",
+    "    9--10--11      12--13--14",
+    "    |   |   |       |   |   |",
+    "    |   | /15--16--17\\  |   |",
+    "    |   |/      |     \\ |   |",
+    "    | /18------19------20\\  |",
+    "    |/          |         \\ |",
+    "   21----------22----------23",
+  };
+#define DIAGRAM_LINES (sizeof (board_diagram) / sizeof (char *))
+
+/* The board that the tables below are derived for.  */
+static bool diagonals;
+static guint num_mills;
+static guchar mills[MAX_MILLS][3];
+static guint32 neighbor_mask[BOARD_SIZE];
+static guint32 mill_bits[MAX_MILLS];
+static guchar mill_from_pos[BOARD_SIZE][3];
+static guchar symmetries[NUM_SYMMETRIES][BOARD_SIZE];
+
+static void
+fail (const char *message, guint pos)
+{
+  fprintf (stderr, "mktables: %s (place %u)\n", message, pos);
+  exit (1);
+}
+
+/* Check the hand-written lists and derive the bit sets of one board
+   from them.  */
+static void
+derive_tables (bool with_diagonals)
+{
+  guint i, j, pos;
+
+  diagonals = with_diagonals;
+  num_mills = 0;
+  for (i = 0; i < MAX_MILLS; i++)
+    {
+      if (mills_canonical[i][3] && !diagonals)
+	continue;
+      memcpy (mills[num_mills++], mills_canonical[i], 3);
+    }
+  memset (neighbor_mask, 0, sizeof (neighbor_mask));
+  memset (mill_bits, 0, sizeof (mill_bits));
+  memset (mill_from_pos, 0, sizeof (mill_from_pos));
+
+  for (i = 0; i < NUM_ADJACENT; i++)
+    {
+      guchar a = adjacent_places_canonical[i][0];
+      guchar b = adjacent_places_canonical[i][1];
+      if (i >= NUM_ADJACENT - NUM_DIAGONAL_ADJACENT && !diagonals)
+	break;
+      if (a >= BOARD_SIZE || b >= BOARD_SIZE || a == b)
+	fail ("bad adjacent pair", a);
+      if (neighbor_mask[a] & 1 << b)
+	fail ("adjacent pair listed twice", a);
+      neighbor_mask[a] |= 1 << b;
+      neighbor_mask[b] |= 1 << a;
+    }
+
+  for (i = 0; i < num_mills; i++)
+    {
+      for (j = 0; j < 3; j++)
+	{
+	  if (mills[i][j] >= BOARD_SIZE)
+	    fail ("bad mill", mills[i][j]);
+	  mill_bits[i] |= 1 << mills[i][j];
+	}
+      if (__builtin_popcount (mill_bits[i]) != 3)
+	fail ("mill with a repeated place", mills[i][0]);
+      /* The places of a mill must be connected in a line.  */
+      if (!(neighbor_mask[mills[i][1]] & 1 << mills[i][0]) ||
+	  !(neighbor_mask[mills[i][1]] & 1 << mills[i][2]))
+	fail ("mill that is not a line of adjacent places", mills[i][1]);
+    }
+
+  for (pos = 0; pos < BOARD_SIZE; pos++)
+    {
+      guint count = 0;
+      if (__builtin_popcount (neighbor_mask[pos]) > 4)
+	fail ("place with more than four neighbors", pos);
+      for (i = 0; i < num_mills; i++)
+	{
+	  if (!(mill_bits[i] & 1 << pos))
+	    continue;
+	  if (count == 3)
+	    fail ("place in more than three mills", pos);
+	  mill_from_pos[pos][count++] = i;
+	}
+      if (count == 0)
+	fail ("place in no mill", pos);
+      /* Pad with the last mill, so that every entry is a real mill
+	 that contains the place.  */
+      for (; count < 3; count++)
+	mill_from_pos[pos][count] = mill_from_pos[pos][count-1];
+    }
+}
+
+/* Find where a rotation or mirror of the grid takes every place, and
+   check that it keeps the mills and adjacencies.  */
+static void
+derive_symmetries (void)
+{
+  guint sym, pos, other, i;
+
+  for (sym = 0; sym < NUM_SYMMETRIES; sym++)
+    {
+      for (pos = 0; pos < BOARD_SIZE; pos++)
+	{
+	  gint x = place_coords[pos][0], y = place_coords[pos][1];
+	  gint tx, ty;
+	  /* Symmetries 0 to 3 rotate by quarter turns, and 4 to 7 mirror
+	     left to right before rotating.  */
+	  if (sym >= 4)
+	    x = 6 - x;
+	  switch (sym % 4)
+	    {
+	    case 0: tx = x; ty = y; break;
+	    case 1: tx = 6 - y; ty = x; break;
+	    case 2: tx = 6 - x; ty = 6 - y; break;
+	    default: tx = y; ty = 6 - x; break;
+	    }
+	  for (other = 0; other < BOARD_SIZE; other++)
+	    {
+	      if (place_coords[other][0] == tx && place_coords[other][1] == ty)
+		break;
+	    }
+	  if (other == BOARD_SIZE)
+	    fail ("symmetry moves a place off the board", pos);
+	  symmetries[sym][pos] = other;
+	}
+
+      for (pos = 0; pos < BOARD_SIZE; pos++)
+	{
+	  guint32 image = 0;
+	  for (other = 0; other < BOARD_SIZE; other++)
+	    {
+	      if (neighbor_mask[pos] & 1 << other)
+		image |= 1 << symmetries[sym][other];
+	    }
+	  if (image != neighbor_mask[symmetries[sym][pos]])
+	    fail ("symmetry does not keep the adjacencies", pos);
+	}
+      for (i = 0; i < num_mills; i++)
+	{
+	  guint32 image = 0;
+	  guint k;
+	  for (k = 0; k < 3; k++)
+	    image |= 1 << symmetries[sym][mills[i][k]];
+	  for (k = 0; k < num_mills; k++)
+	    {
+	      if (mill_bits[k] == image)
+		break;
+	    }
+	  if (k == num_mills)
+	    fail ("symmetry does not keep the mills", mills[i][0]);
+	}
+    }
+}
+
+/* Draw a mill mask as the board diagram with the mill marked.  */
+static void
+print_mill_diagram (guint mill)
+{
+  guint line;
+  printf ("mill_masks[%2u]\n", mill);
+  for (line = 0; line < DIAGRAM_LINES; line++)
+    {
+      const char *p = board_diagram[line];
+      while (*p != '\0')
+	{
+	  if (*p >= '0' && *p <= '9')
+	    {
+	      char *end;
+	      guint pos = strtoul (p, &end, 10);
+	      bool in_mill = (mill_bits[mill] & 1 << pos) != 0;
+	      for (p++; p < end; p++)
+		putchar ('-');
+	      putchar (in_mill ? 'X' : '-');
+	    }
+	  else if ((*p == '\\' || *p == '/') && !diagonals)
+	    {
+	      putchar (' ');
+	      p++;
+	    }
+	  else
+	    putchar (*p++);
+	}
+      putchar ('\n');
+    }
+}
+
+/* Print one board or mask in the given layout.  VALUES holds the
+   value of each place.  */
+static void
+print_mask (const guchar *values, bool packed, const char *indent)
+{
+  guint mask_size = packed ? 8 : 32;
+  guchar bytes[32];
+  guint i;
+
+  memset (bytes, 0, sizeof (bytes));
+  for (i = 0; i < BOARD_SIZE; i++)
+    {
+      if (packed)
+	bytes[i/4] |= (values[i] & 3) << (i % 4 * 2);
+      else
+	bytes[i] = values[i];
+    }
+  printf ("%s{ ", indent);
+  for (i = 0; i < mask_size; i++)
+    {
+      if (i > 0 && i % 8 == 0)
+	printf ("\n%s  ", indent);
+      printf ("0x%02x,%s", bytes[i], (i % 8 == 7) ? "" : " ");
+    }
+  printf (" }");
+}
+
+/* Print a mask that has the same value on every place.  */
+static void
+print_uniform_mask (const char *name, guchar value, bool packed)
+{
+  guchar values[BOARD_SIZE];
+  memset (values, value, sizeof (values));
+  printf ("static const guchar %s[MASK_SIZE] TABLE_ATTRS =\n", name);
+  print_mask (values, packed, "  ");
+  printf (";\n\n");
+}
+
+/* Print the mill masks with the given value on the places of each
+   mill.  */
+static void
+print_mill_masks (const char *name, guchar value, bool packed)
+{
+  guint i, pos;
+  printf ("static const guchar %s[TOTAL_MILLS][MASK_SIZE] TABLE_ATTRS =\n"
+	  "  {\n", name);
+  for (i = 0; i < num_mills; i++)
+    {
+      guchar values[BOARD_SIZE];
+      for (pos = 0; pos < BOARD_SIZE; pos++)
+	values[pos] = (mill_bits[i] & 1 << pos) ? value : 0;
+      print_mask (values, packed, "    ");
+      printf (",\n");
+    }
+  printf ("  };\n\n");
+}
+
+/* Print the tables that depend on the board layout.  */
+static void
+print_layout_tables (bool packed)
+{
+  guchar full = packed ? 0x03 : 0xff;
+  guint i;
+
+  print_uniform_mask ("null_mask", 0x00, packed);
+  print_uniform_mask ("saturated_mask", full, packed);
+  print_uniform_mask ("p1_mask", PLAYER1, packed);
+  print_uniform_mask ("p2_mask", PLAYER2, packed);
+
+  if (!packed)
+    {
+      printf ("/**\n"
+	      " * Mill masks.  These are logically ANDed with a game board, and\n"
+	      " * if the result is equal to the mask, then there is a mill.\n"
+	      " * These are graphical representations of the mill masks.\n"
+	      "\n"
+	      "@verbatim\n");
+      for (i = 0; i < num_mills; i++)
+	print_mill_diagram (i);
+      printf ("@endverbatim\n"
+	      " */\n");
+    }
+  print_mill_masks ("mill_masks", full, packed);
+  print_mill_masks ("p1_mill_masks", PLAYER1, packed);
+  print_mill_masks ("p2_mill_masks", PLAYER2, packed);
+}
+
+/* Print the tables of the board that was derived last.  */
+static void
+print_board_tables (void)
+{
+  guint pos, i;
+
+  printf ("#if TOTAL_MILLS != %u\n"
+	  "#  error \"tables-gen.h does not match morris.h\"\n"
+	  "#endif\n"
+	  "\n", num_mills);
+
+  printf ("/** The places adjacent to each place, ended by %u.  */\n"
+	  "static const guchar adjacent_places[BOARD_SIZE*4] TABLE_ATTRS =\n"
+	  "  {\n", NO_PLACE);
+  for (pos = 0; pos < BOARD_SIZE; pos++)
+    {
+      guint count = 0;
+      printf ("    ");
+      for (i = 0; i < BOARD_SIZE; i++)
+	{
+	  if (neighbor_mask[pos] & 1 << i)
+	    {
+	      printf ("%2u, ", i);
+	      count++;
+	    }
+	}
+      for (; count < 4; count++)
+	printf ("%2u, ", NO_PLACE);
+      printf ("/* {%2u, nn} */\n", pos);
+    }
+  printf ("  };\n\n");
+
+  printf ("/**\n"
+	  " * The places adjacent to each place as a bit set, with bit @a n set\n"
+	  " * for place @a n.\n"
+	  " */\n"
+	  "static const guint32 neighbor_mask[BOARD_SIZE] TABLE_ATTRS =\n"
+	  "  {\n");
+  for (pos = 0; pos < BOARD_SIZE; pos++)
+    printf ("    0x%06x, /* Position %2u */\n", neighbor_mask[pos], pos);
+  printf ("  };\n\n");
+
+  printf ("/** The places of each mill as a bit set.  */\n"
+	  "static const guint32 mill_bits[TOTAL_MILLS] TABLE_ATTRS =\n"
+	  "  {\n");
+  for (i = 0; i < num_mills; i++)
+    printf ("    0x%06x, /* Mill %2u: %2u, %2u, %2u */\n", mill_bits[i], i,
+	    mills[i][0], mills[i][1], mills[i][2]);
+  printf ("  };\n\n");
+
+  printf ("/**\n"
+	  " * Take a board position and find all potential mills that the piece\n"
+	  " * could be part of.  Places in only two mills repeat the last one.\n"
+	  " */\n"
+	  "static const guchar mill_from_pos[BOARD_SIZE*3] TABLE_ATTRS =\n"
+	  "  {\n");
+  for (pos = 0; pos < BOARD_SIZE; pos++)
+    printf ("    %2u, %2u, %2u, /* Position %2u */\n", mill_from_pos[pos][0],
+	    mill_from_pos[pos][1], mill_from_pos[pos][2], pos);
+  printf ("  };\n\n");
+
+  printf ("/** The mills of each place as bit sets, padded like "
+	  "mill_from_pos.  */\n"
+	  "static const guint32 pos_mill_bits[BOARD_SIZE][3] TABLE_ATTRS =\n"
+	  "  {\n");
+  for (pos = 0; pos < BOARD_SIZE; pos++)
+    printf ("    { 0x%06x, 0x%06x, 0x%06x }, /* Position %2u */\n",
+	    mill_bits[mill_from_pos[pos][0]],
+	    mill_bits[mill_from_pos[pos][1]],
+	    mill_bits[mill_from_pos[pos][2]], pos);
+  printf ("  };\n\n");
+
+  printf ("#ifdef USE_PACKED\n\n");
+  print_layout_tables (true);
+  printf ("#else /* not USE_PACKED */\n\n");
+  print_layout_tables (false);
+  printf ("#endif /* not USE_PACKED */\n\n");
+}
+
+/* Print the symmetries, which are the same on both boards.  */
+static void
+print_symmetries (void)
+{
+  guint pos, sym;
+
+  printf ("#define NUM_SYMMETRIES %u\n"
+	  "\n"
+	  "/**\n"
+	  " * The symmetries of the board.  Each row maps every place to the\n"
+	  " * place that it goes to.  Row 0 is the identity, rows 1 to 3 rotate\n"
+	  " * by quarter turns clockwise, and rows 4 to 7 mirror the board left\n"
+	  " * to right before rotating it.\n"
+	  " */\n"
+	  "static const guchar symmetries[NUM_SYMMETRIES][BOARD_SIZE] "
+	  "TABLE_ATTRS =\n"
+	  "  {\n", NUM_SYMMETRIES);
+  for (sym = 0; sym < NUM_SYMMETRIES; sym++)
+    {
+      printf ("    {");
+      for (pos = 0; pos < BOARD_SIZE; pos++)
+	{
+	  if (pos == 12)
+	    printf ("\n     ");
+	  printf (" %2u%s", symmetries[sym][pos],
+		  (pos == BOARD_SIZE - 1) ? " " : ",");
+	}
+      printf ("},\n");
+    }
+  printf ("  };\n\n");
+}
+
+int
+main (void)
+{
+  printf ("/* tables-gen.h -- Rule tables generated by mktables.  "
+	  "Do not edit.  */\n"
+	  "\n"
+	  "#ifndef TABLES_GEN_H\n"
+	  "#define TABLES_GEN_H\n"
+	  "\n"
+	  "#if BOARD_SIZE != %u\n"
+	  "#  error \"tables-gen.h does not match morris.h\"\n"
+	  "#endif\n"
+	  "\n"
+	  "#ifdef __GNUC__\n"
+	  "#  define TABLE_ATTRS __attribute__ ((aligned (%u), unused))\n"
+	  "#else\n"
+	  "#  define TABLE_ATTRS\n"
+	  "#endif\n"
+	  "\n", BOARD_SIZE, CACHE_LINE_SIZE);
+
+  derive_tables (true);
+  derive_symmetries ();
+  print_symmetries ();
+  printf ("#if HAVE_DIAGONALS\n\n");
+  print_board_tables ();
+
+  derive_tables (false);
+  derive_symmetries ();
+  printf ("#else /* not HAVE_DIAGONALS */\n\n");
+  print_board_tables ();
+  printf ("#endif /* not HAVE_DIAGONALS */\n"
+	  "\n"
+	  "#endif /* not TABLES_GEN_H */\n");
+  if (fflush (stdout) != 0 || ferror (stdout))
+    {
+      fputs ("mktables: write error\n", stderr);
+      return 1;
+    }
+  return 0;
+}
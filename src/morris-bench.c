@@ -0,0 +1,438 @@
+/* Micro-benchmarks for the game rules.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Micro-benchmarks for the game rules.
+ *
+ * The rules primitives in morris.c are called billions of times by
+ * the simulator, so a small slowdown in one of them adds hours to a
+ * full simulation.  This program times each primitive over a fixed
+ * corpus of positions, so that runs on different commits and with
+ * different build options can be compared.
+ *
+ * The corpus is made up of positions from random games, chosen as
+ * described in corpus.c.  The random games are seeded with a
+ * constant, so every run uses the same positions, unless a corpus
+ * file made by morris-corpus is given instead.  Each primitive is
+ * first run a few times to warm up the caches and the branch
+ * predictors.  Then it is timed over a number of repetitions, each
+ * of which takes long enough for the clock resolution not to matter.
+ * The median is the figure to compare; the percentiles show how noisy
+ * the machine was.
+ *
+ * Results are written as CSV with one line per primitive.  The
+ * USE_PACKED and HAVE_X86_ASM columns tell which build produced a
+ * line, since these options can only be changed by configuring the
+ * program again.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "morris.h"
+#include "corpus.h"
+#include "eval.h"
+#include "stats.h"
+
+/** Number of positions in the default corpus.  */
+#define DEFAULT_CORPUS_SIZE 4096
+/** Minimum duration of one timed repetition in microseconds.  */
+#define MIN_REP_USEC 5000
+
+/** A rules primitive to time.  */
+struct Benchmark_tag
+{
+  const char *name;
+  /** Calls per position in the corpus.  */
+  guint ops_per_state;
+  /**
+   * Run the primitive over the corpus once.  The return value only
+   * serves to keep the compiler from optimizing the calls away.
+   */
+  guint (*run) (GameState *corpus, guint count);
+};
+typedef struct Benchmark_tag Benchmark;
+
+/* Keeps results alive so that the benchmarked calls are not
+   optimized away.  */
+static volatile guint sink;
+
+static guint
+run_board_ref (GameState *corpus, guint count)
+{
+  guint i, sum = 0;
+  guchar pos;
+  for (i = 0; i < count; i++)
+    {
+      for (pos = 0; pos < BOARD_SIZE; pos++)
+	sum += board_ref (corpus[i].board, pos);
+    }
+  return sum;
+}
+
+static guint
+run_set_board_pos (GameState *corpus, guint count)
+{
+  GameState state;
+  guint i, sum = 0;
+  guchar pos;
+  init_game_state (&state);
+  /* Copy every board into a scratch board, one position at a time and
+     in reverse, so that every call changes the board.  */
+  for (i = 0; i < count; i++)
+    {
+      for (pos = 0; pos < BOARD_SIZE; pos++)
+	set_board_pos (state.board, pos,
+		       board_ref (corpus[i].board, BOARD_SIZE - 1 - pos));
+      sum += ((guchar *) state.board)[i % MASK_SIZE];
+    }
+  return sum;
+}
+
+static guint
+run_are_adjacent (GameState *corpus, guint count)
+{
+  guint i, sum = 0;
+  guchar pos1, pos2;
+  for (i = 0; i < count; i++)
+    {
+      pos1 = i % BOARD_SIZE;
+      for (pos2 = 0; pos2 < BOARD_SIZE; pos2++)
+	sum += are_adjacent (pos1, pos2);
+    }
+  return sum;
+}
+
+static guint
+run_is_valid_remove (GameState *corpus, guint count)
+{
+  guint i, sum = 0;
+  guchar pos;
+  for (i = 0; i < count; i++)
+    {
+      for (pos = 0; pos < BOARD_SIZE; pos++)
+	sum += is_valid_remove (&corpus[i], pos);
+    }
+  return sum;
+}
+
+static guint
+run_is_mill_formed (GameState *corpus, guint count)
+{
+  guint i, sum = 0;
+  guchar pos;
+  for (i = 0; i < count; i++)
+    {
+      for (pos = 0; pos < BOARD_SIZE; pos++)
+	sum += is_mill_formed (&corpus[i], pos);
+    }
+  return sum;
+}
+
+static guint
+run_get_winner (GameState *corpus, guint count)
+{
+  guint i, sum = 0;
+  for (i = 0; i < count; i++)
+    sum += get_winner (&corpus[i]);
+  return sum;
+}
+
+static guint
+run_count_mobility (GameState *corpus, guint count)
+{
+  guint i, sum = 0;
+  for (i = 0; i < count; i++)
+    sum += count_mobility (&corpus[i], corpus[i].cur_player);
+  return sum;
+}
+
+static guint
+run_gen_moves (GameState *corpus, guint count)
+{
+  Move moves[MAX_MOVES];
+  guint i, sum = 0;
+  for (i = 0; i < count; i++)
+    sum += gen_moves (&corpus[i], moves);
+  return sum;
+}
+
+static guint
+run_evaluate (GameState *corpus, guint count)
+{
+  guint i, sum = 0;
+  for (i = 0; i < count; i++)
+    sum += evaluate (&corpus[i]);
+  return sum;
+}
+
+static guint
+run_eval_extract (GameState *corpus, guint count)
+{
+  StateKey keys[256];
+  gint16 features[256*EVAL_NUM_FEATURES];
+  guint i, j, sum = 0;
+  for (i = 0; i < count; i += 256)
+    {
+      guint n = MIN (count - i, 256);
+      for (j = 0; j < n; j++)
+	keys[j] = pack_state (&corpus[i+j]);
+      eval_extract (keys, n, features);
+      sum += features[(n - 1)*EVAL_NUM_FEATURES + EVAL_MOBILITY];
+    }
+  return sum;
+}
+
+static const Benchmark benchmarks[] = {
+  { "board_ref", BOARD_SIZE, run_board_ref },
+  /* This one also counts the board_ref () calls that feed it.  */
+  { "set_board_pos", BOARD_SIZE, run_set_board_pos },
+  { "are_adjacent", BOARD_SIZE, run_are_adjacent },
+  { "is_valid_remove", BOARD_SIZE, run_is_valid_remove },
+  { "is_mill_formed", BOARD_SIZE, run_is_mill_formed },
+  { "get_winner", 1, run_get_winner },
+  { "count_mobility", 1, run_count_mobility },
+  { "gen_moves", 1, run_gen_moves },
+  { "evaluate", 1, run_evaluate },
+  /* This one also counts the pack_state () calls that feed it.  */
+  { "eval_extract", 1, run_eval_extract },
+};
+#define NUM_BENCHMARKS (sizeof (benchmarks) / sizeof (Benchmark))
+
+static int
+compare_doubles (const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+/* Time one pass count over the corpus, in microseconds.  */
+static gint64
+time_passes (const Benchmark *bench, GameState *corpus, guint count,
+	     guint passes)
+{
+  gint64 start = g_get_monotonic_time ();
+  guint i;
+  for (i = 0; i < passes; i++)
+    sink += bench->run (corpus, count);
+  return g_get_monotonic_time () - start;
+}
+
+/**
+ * Time one benchmark and write its CSV line.
+ */
+static void
+run_benchmark (FILE *fp, const char *label, const Benchmark *bench,
+	       GameState *corpus, guint count, guint warmup, guint reps)
+{
+  double *samples = g_new (double, reps);
+  guint passes = 1;
+  guint64 ops;
+  guint i;
+
+  for (i = 0; i < warmup; i++)
+    time_passes (bench, corpus, count, 1);
+  /* Find a pass count that makes a repetition long enough to time
+     accurately.  */
+  while (time_passes (bench, corpus, count, passes) < MIN_REP_USEC)
+    passes *= 2;
+
+  ops = (guint64) passes * count * bench->ops_per_state;
+  for (i = 0; i < reps; i++)
+    samples[i] = time_passes (bench, corpus, count, passes) * 1000.0 / ops;
+  qsort (samples, reps, sizeof (double), compare_doubles);
+
+  fprintf (fp, "%s,%s,%d,%d,%u,%" G_GUINT64_FORMAT ",%u,"
+	   "%.3f,%.3f,%.3f,%.3f,%.3f\n",
+	   label, bench->name,
+#ifdef USE_PACKED
+	   1,
+#else
+	   0,
+#endif
+#ifdef HAVE_X86_ASM
+	   1,
+#else
+	   0,
+#endif
+	   count, ops, reps, samples[0],
+	   samples[stats_percentile_index (reps, 10)],
+	   samples[stats_percentile_index (reps, 50)],
+	   samples[stats_percentile_index (reps, 90)], samples[reps-1]);
+  fflush (fp);
+  g_free (samples);
+}
+
+static void
+print_usage (void)
+{
+  puts ("Usage: morris-bench [OPTION]... [BENCHMARK]...\n"
+	"Time the game rules primitives and print the results as CSV.\n"
+	"\n"
+	"  -o, --output FILE     append the results to FILE\n"
+	"  -l, --label TEXT      put TEXT in the first column, such as a\n"
+	"                        commit ID (default: none)\n"
+	"  -n, --corpus N        number of positions to use (default: 4096)\n"
+	"  -c, --corpus-file FILE\n"
+	"                        use the positions in a corpus file instead\n"
+	"  -w, --warmup N        untimed runs before timing (default: 3)\n"
+	"  -r, --reps N          timed repetitions (default: 21)\n"
+	"  -h, --help            display this help and exit\n"
+	"\n"
+	"By default, every benchmark is run.");
+}
+
+int
+main (int argc, char *argv[])
+{
+  const char *output = NULL;
+  const char *label = "";
+  const char *corpus_file = NULL;
+  guint corpus_size = DEFAULT_CORPUS_SIZE;
+  guint warmup = 3, reps = 21;
+  const char **names;
+  guint num_names = 0;
+  StateKey *keys;
+  GameState *corpus;
+  FILE *fp = stdout;
+  bool new_file = true;
+  guint i, j;
+  int status = 0;
+
+  names = g_new (const char *, argc);
+  for (i = 1; i < (guint) argc; i++)
+    {
+      const char *arg = argv[i];
+      const char *value = (i + 1 < (guint) argc) ? argv[i+1] : NULL;
+      if (!strcmp ("-h", arg) || !strcmp ("--help", arg))
+	{
+	  print_usage ();
+	  return 0;
+	}
+      else if (arg[0] != '-')
+	names[num_names++] = arg;
+      else if (value == NULL)
+	{
+	  g_printerr ("morris-bench: missing argument for `%s'\n", arg);
+	  return 1;
+	}
+      else if (!strcmp ("-o", arg) || !strcmp ("--output", arg))
+	output = argv[++i];
+      else if (!strcmp ("-l", arg) || !strcmp ("--label", arg))
+	label = argv[++i];
+      else if (!strcmp ("-n", arg) || !strcmp ("--corpus", arg))
+	corpus_size = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-c", arg) || !strcmp ("--corpus-file", arg))
+	corpus_file = argv[++i];
+      else if (!strcmp ("-w", arg) || !strcmp ("--warmup", arg))
+	warmup = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-r", arg) || !strcmp ("--reps", arg))
+	reps = strtoul (argv[++i], NULL, 10);
+      else
+	{
+	  g_printerr ("morris-bench: unknown option `%s'\n", arg);
+	  print_usage ();
+	  return 1;
+	}
+    }
+  if (corpus_size == 0)
+    corpus_size = 1;
+  if (reps == 0)
+    reps = 1;
+
+  for (i = 0; i < num_names; i++)
+    {
+      for (j = 0; j < NUM_BENCHMARKS; j++)
+	{
+	  if (!strcmp (names[i], benchmarks[j].name))
+	    break;
+	}
+      if (j == NUM_BENCHMARKS)
+	{
+	  g_printerr ("morris-bench: unknown benchmark `%s'\n", names[i]);
+	  return 1;
+	}
+    }
+
+  if (corpus_file != NULL)
+    {
+      keys = corpus_read (corpus_file, &corpus_size);
+      if (keys == NULL || corpus_size == 0)
+	{
+	  g_printerr ("morris-bench: cannot read corpus %s\n", corpus_file);
+	  return 1;
+	}
+    }
+  else
+    {
+      keys = g_new (StateKey, corpus_size);
+      corpus_size = corpus_generate (keys, corpus_size, CORPUS_DEFAULT_SEED);
+    }
+  corpus = g_new (GameState, corpus_size);
+  for (i = 0; i < corpus_size; i++)
+    unpack_state (keys[i], &corpus[i]);
+  g_free (keys);
+
+  if (output != NULL)
+    {
+      fp = fopen (output, "a");
+      if (fp == NULL)
+	{
+	  g_printerr ("morris-bench: cannot open %s\n", output);
+	  return 1;
+	}
+      /* Only start a file with a header, so that results of several
+	 runs can be collected in one file.  */
+      new_file = (ftell (fp) == 0);
+    }
+  if (new_file)
+    fputs ("label,benchmark,packed,x86_asm,corpus,ops,reps,"
+	   "min_ns,p10_ns,median_ns,p90_ns,max_ns\n", fp);
+
+  for (j = 0; j < NUM_BENCHMARKS; j++)
+    {
+      bool selected = (num_names == 0);
+      for (i = 0; i < num_names && !selected; i++)
+	selected = !strcmp (names[i], benchmarks[j].name);
+      if (selected)
+	run_benchmark (fp, label, &benchmarks[j], corpus, corpus_size,
+		       warmup, reps);
+    }
+
+  if (fp != stdout && fclose (fp) != 0)
+    {
+      g_printerr ("morris-bench: error writing %s\n", output);
+      status = 1;
+    }
+  g_free (corpus);
+  g_free (names);
+  return status;
+}
@@ -0,0 +1,291 @@
+/* Build opening books from game records.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Build opening books from game records.
+ *
+ * Every game in the given game record files is replayed, and each
+ * move of the placement phase is credited with the result of the game
+ * for the player who made it: two points for a win, one for a draw
+ * and none for a loss.  The book weight of a move is its total number
+ * of points, so that moves that won more games are played more often.
+ * Moves that were played in too few games are left out, as their
+ * results say little.
+ *
+ * There is no solver yet, but a solver could write its results as
+ * game records with the proven winner of each line of play, and they
+ * would be weighted the same way.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "morris.h"
+#include "record.h"
+#include "book.h"
+
+/** One placement-phase move of one game, in canonical orientation.  */
+struct BookSample_tag
+{
+  guint64 key;
+  guchar type;
+  guchar src;
+  guchar dest;
+  guchar points; /**< 2 for a win, 1 for a draw, 0 for a loss */
+};
+typedef struct BookSample_tag BookSample;
+
+static int
+compare_samples (const void *a, const void *b)
+{
+  const BookSample *sa = (const BookSample *) a;
+  const BookSample *sb = (const BookSample *) b;
+  if (sa->key != sb->key)
+    return (sa->key < sb->key) ? -1 : 1;
+  if (sa->type != sb->type)
+    return sa->type - sb->type;
+  if (sa->src != sb->src)
+    return sa->src - sb->src;
+  return sa->dest - sb->dest;
+}
+
+static int
+compare_entries (const void *a, const void *b)
+{
+  const BookEntry *ea = (const BookEntry *) a;
+  const BookEntry *eb = (const BookEntry *) b;
+  if (ea->key != eb->key)
+    return (ea->key < eb->key) ? -1 : 1;
+  if (ea->weight != eb->weight)
+    return (ea->weight > eb->weight) ? -1 : 1;
+  return 0;
+}
+
+/**
+ * Replay the games of a game record file and collect the moves of
+ * their placement phase.
+ *
+ * @param path the game record file
+ * @param samples the array that the moves are appended to
+ * @param num_games incremented for every game read
+ * @return @a true on success, @a false if the file cannot be read or
+ * holds an illegal move
+ */
+static bool
+collect_samples (const gchar *path, GArray *samples, guint64 *num_games)
+{
+  RecordReader *reader;
+  RecordGame game;
+  int status;
+
+  reader = record_reader_open (path);
+  if (reader == NULL)
+    {
+      g_printerr ("morris-book: %s is not a game record file for %s\n",
+		  path, VARIANT_NAME);
+      return false;
+    }
+  while ((status = record_reader_next (reader, &game)) > 0)
+    {
+      const guchar *p = game.data, *end = game.data + game.size;
+      GameState state;
+      Move move;
+
+      init_game_state (&state);
+      while (p < end && state.setup_rounds_left > 0)
+	{
+	  BookSample sample;
+	  Move canon;
+	  guint sym;
+
+	  if (!record_decode_move (&p, end, &move))
+	    {
+	      status = -1;
+	      break;
+	    }
+	  sample.key = book_canonical_key (pack_state (&state), &sym);
+	  book_transform_move (&move, sym, false, &canon);
+	  sample.type = canon.type;
+	  sample.src = canon.src;
+	  sample.dest = canon.dest;
+	  if (game.winner == EMPTY)
+	    sample.points = 1;
+	  else
+	    sample.points = (game.winner == state.cur_player) ? 2 : 0;
+	  if (!record_play_move (&state, &move))
+	    {
+	      status = -1;
+	      break;
+	    }
+	  g_array_append_val (samples, sample);
+	}
+      if (status < 0)
+	break;
+      (*num_games)++;
+    }
+  if (!record_reader_close (reader) || status < 0)
+    {
+      g_printerr ("morris-book: %s is corrupt\n", path);
+      return false;
+    }
+  return true;
+}
+
+/**
+ * Merge the samples of each move of each position into book entries.
+ *
+ * @param samples the samples, which are sorted in place
+ * @param min_games the number of games a move must be played in to
+ * make it into the book
+ * @param num_positions receives the number of positions in the book
+ * @return the book entries, with their number in the @a len field
+ */
+static GArray *
+merge_samples (GArray *samples, guint min_games, guint64 *num_positions)
+{
+  GArray *entries = g_array_new (FALSE, FALSE, sizeof (BookEntry));
+  BookSample *s = (BookSample *) samples->data;
+  guint64 last_key = 0;
+  guint i = 0;
+
+  qsort (s, samples->len, sizeof (BookSample), compare_samples);
+  *num_positions = 0;
+  while (i < samples->len)
+    {
+      BookEntry entry;
+      guint64 points = 0;
+      guint j;
+      for (j = i; j < samples->len && compare_samples (&s[i], &s[j]) == 0;
+	   j++)
+	points += s[j].points;
+      if (j - i >= min_games)
+	{
+	  entry.key = s[i].key;
+	  entry.weight = MIN (points, G_MAXUINT32);
+	  entry.type = s[i].type;
+	  entry.src = s[i].src;
+	  entry.dest = s[i].dest;
+	  entry.reserved = 0;
+	  if (entries->len == 0 || entry.key != last_key)
+	    (*num_positions)++;
+	  last_key = entry.key;
+	  g_array_append_val (entries, entry);
+	}
+      i = j;
+    }
+  qsort (entries->data, entries->len, sizeof (BookEntry), compare_entries);
+  return entries;
+}
+
+static void
+print_usage (void)
+{
+  puts ("Usage: morris-book [OPTION]... RECORDS...\n"
+	"Build an opening book for the placement phase of " VARIANT_NAME
+	"\n"
+	"from the games in the given game record files.\n"
+	"\n"
+	"  -o, --output FILE     book file to write (default: book.bin)\n"
+	"  -g, --min-games N     leave out moves played in fewer than N\n"
+	"                        games (default: 2)\n"
+	"  -h, --help            display this help and exit");
+}
+
+int
+main (int argc, char *argv[])
+{
+  const char *output = "book.bin";
+  guint min_games = 2;
+  GArray *samples, *entries;
+  guint64 num_games = 0, num_positions;
+  guint num_inputs = 0;
+  int status = 0;
+  int i;
+
+  samples = g_array_new (FALSE, FALSE, sizeof (BookSample));
+  for (i = 1; i < argc && status == 0; i++)
+    {
+      const char *arg = argv[i];
+      const char *value = (i + 1 < argc) ? argv[i+1] : NULL;
+      if (!strcmp ("-h", arg) || !strcmp ("--help", arg))
+	{
+	  print_usage ();
+	  return 0;
+	}
+      else if (arg[0] != '-')
+	{
+	  if (!collect_samples (arg, samples, &num_games))
+	    status = 1;
+	  num_inputs++;
+	}
+      else if (value == NULL)
+	{
+	  g_printerr ("morris-book: missing argument for `%s'\n", arg);
+	  status = 1;
+	}
+      else if (!strcmp ("-o", arg) || !strcmp ("--output", arg))
+	output = argv[++i];
+      else if (!strcmp ("-g", arg) || !strcmp ("--min-games", arg))
+	min_games = strtoul (argv[++i], NULL, 10);
+      else
+	{
+	  g_printerr ("morris-book: unknown option `%s'\n", arg);
+	  print_usage ();
+	  status = 1;
+	}
+    }
+  if (status == 0 && num_inputs == 0)
+    {
+      g_printerr ("morris-book: no game records given\n");
+      print_usage ();
+      status = 1;
+    }
+  if (status != 0)
+    {
+      g_array_free (samples, TRUE);
+      return status;
+    }
+
+  entries = merge_samples (samples, MAX (min_games, 1), &num_positions);
+  g_array_free (samples, TRUE);
+  if (!book_write (output, (BookEntry *) entries->data, entries->len))
+    {
+      g_printerr ("morris-book: cannot write %s\n", output);
+      status = 1;
+    }
+  else
+    printf ("%" G_GUINT64_FORMAT " games, %" G_GUINT64_FORMAT
+	    " positions, %u moves\n", num_games, num_positions,
+	    entries->len);
+  g_array_free (entries, TRUE);
+  return status;
+}
@@ -0,0 +1,140 @@
+/* Generate corpora of representative game positions.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Generate corpora of representative game positions.
+ *
+ * This program writes a corpus file that the benchmarks and the
+ * fuzzer can load, so that they all work on the same positions.  See
+ * corpus.c for how the positions are chosen and for the file format.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "morris.h"
+#include "corpus.h"
+
+static void
+print_usage (void)
+{
+  puts ("Usage: morris-corpus [OPTION]... FILE\n"
+	"Write a corpus of positions from random games to FILE.\n"
+	"\n"
+	"  -n, --count N         number of positions (default: 4096)\n"
+	"  -s, --seed N          random seed (default: a fixed seed)\n"
+	"  -v, --verbose         print how many positions each stratum got\n"
+	"  -h, --help            display this help and exit");
+}
+
+static void
+print_strata (const StateKey *keys, guint count)
+{
+  guint histogram[CORPUS_NUM_STRATA];
+  guint i;
+  memset (histogram, 0, sizeof (histogram));
+  for (i = 0; i < count; i++)
+    {
+      GameState state;
+      unpack_state (keys[i], &state);
+      histogram[corpus_stratum (&state)]++;
+    }
+  for (i = 0; i < CORPUS_NUM_STRATA; i++)
+    {
+      if (histogram[i] == 0)
+	continue;
+      printf ("%-8s%2u pieces: %u\n",
+	      (i <= BOARD_SIZE) ? "placing" : "moving",
+	      i % (BOARD_SIZE + 1), histogram[i]);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  const char *output = NULL;
+  guint count = 4096;
+  guint64 seed = CORPUS_DEFAULT_SEED;
+  bool verbose = false;
+  StateKey *keys;
+  int i;
+
+  for (i = 1; i < argc; i++)
+    {
+      const char *arg = argv[i];
+      const char *value = (i + 1 < argc) ? argv[i+1] : NULL;
+      if (!strcmp ("-h", arg) || !strcmp ("--help", arg))
+	{
+	  print_usage ();
+	  return 0;
+	}
+      else if (!strcmp ("-v", arg) || !strcmp ("--verbose", arg))
+	verbose = true;
+      else if (arg[0] != '-' && output == NULL)
+	output = arg;
+      else if (value == NULL)
+	{
+	  g_printerr ("morris-corpus: missing argument for `%s'\n", arg);
+	  return 1;
+	}
+      else if (!strcmp ("-n", arg) || !strcmp ("--count", arg))
+	count = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-s", arg) || !strcmp ("--seed", arg))
+	seed = g_ascii_strtoull (argv[++i], NULL, 0);
+      else
+	{
+	  g_printerr ("morris-corpus: unknown option `%s'\n", arg);
+	  print_usage ();
+	  return 1;
+	}
+    }
+  if (output == NULL)
+    {
+      g_printerr ("morris-corpus: no output file given\n");
+      print_usage ();
+      return 1;
+    }
+  if (count == 0)
+    count = 1;
+
+  keys = g_new (StateKey, count);
+  count = corpus_generate (keys, count, seed);
+  if (!corpus_write (output, keys, count))
+    {
+      g_printerr ("morris-corpus: cannot write %s\n", output);
+      g_free (keys);
+      return 1;
+    }
+  if (verbose)
+    print_strata (keys, count);
+  g_free (keys);
+  return 0;
+}
@@ -0,0 +1,400 @@
+/* Text protocol engine for external programs.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Text protocol engine for external programs.
+ *
+ * morris-engine lets graphical interfaces and test harnesses drive the
+ * search through a line protocol on standard input and output, in the
+ * manner of the UCI protocol of chess engines.  Each line is one
+ * command:
+ *
+ * @code
+ * morris                      identify the engine, answered by
+ *                             "id ..." lines and "morrisok"
+ * isready                     answered by "readyok"
+ * newgame                     forget the position
+ * position startpos [moves M...]
+ * position key K [moves M...] set up the start or the position with
+ *                             the hexadecimal ::StateKey K, then play
+ *                             the moves M
+ * go [depth N] [movetime MS] [infinite]
+ *                             search the position
+ * stop                        stop the search
+ * quit                        stop the search and exit
+ * @endcode
+ *
+ * Moves are written in the notation of textual game records, see
+ * record_parse_move().  While it searches, the engine writes an
+ * "info" line after every iteration and a "bestmove" line at the
+ * end, with "bestmove none" if there is no legal move.  Scores are
+ * from the point of view of the player to move, and "win N" or "loss
+ * N" stands for a forced result in N plies.  A search with @c infinite
+ * only answers after @c stop, even if it has found a forced result.
+ *
+ * The search runs on its own thread, so that @c stop, @c isready and
+ * @c quit are answered at once.  A @c position or @c go command that
+ * comes during a search stops it first.  Errors in commands are
+ * reported on standard error.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#include "wpthread.h"
+#else
+#include <pthread.h>
+#endif
+
+#include "morris.h"
+#include "eval.h"
+#include "record.h"
+#include "search.h"
+
+/** The state of the engine.  */
+struct Engine_tag
+{
+  GameState state; /**< The position set up by the last command */
+  SearchContext search;
+  GameState search_state; /**< The position being searched */
+  bool infinite; /**< Whether the search waits for @c stop */
+  pthread_t thread;
+  bool thinking; /**< Whether the search thread has to be joined */
+  /** Keeps the lines of the two threads from mixing.  */
+  pthread_mutex_t output_lock;
+};
+typedef struct Engine_tag Engine;
+
+/* Write one line of the protocol and flush it, so that the program on
+   the other end of a pipe sees it at once.  */
+static void
+send_line (Engine *engine, const gchar *format, ...)
+{
+  va_list args;
+  va_start (args, format);
+  pthread_mutex_lock (&engine->output_lock);
+  vprintf (format, args);
+  putchar ('\n');
+  fflush (stdout);
+  pthread_mutex_unlock (&engine->output_lock);
+  va_end (args);
+}
+
+/* Write a score in the form of an "info" line.  */
+static void
+format_score (gint score, gchar *buf)
+{
+  if (score >= SEARCH_WIN_SCORE)
+    sprintf (buf, "win %d", EVAL_WIN - score);
+  else if (score <= -SEARCH_WIN_SCORE)
+    sprintf (buf, "loss %d", EVAL_WIN + score);
+  else
+    sprintf (buf, "%d", score);
+}
+
+/* Report an iteration of the search.  */
+static void
+report_iteration (const SearchInfo *info, gpointer data)
+{
+  Engine *engine = (Engine *) data;
+  gchar score[32], move[RECORD_MOVE_TEXT_SIZE];
+  format_score (info->score, score);
+  record_format_move (&info->best, move);
+  send_line (engine, "info depth %u score %s nodes %" G_GUINT64_FORMAT
+	     " time %" G_GINT64_FORMAT " pv %s", info->depth, score,
+	     info->nodes, info->usec / 1000, move);
+}
+
+/* Run one search and report its best move.  */
+static void *
+search_thread_main (void *data)
+{
+  Engine *engine = (Engine *) data;
+  SearchInfo result;
+  gchar move[RECORD_MOVE_TEXT_SIZE];
+  if (!search_run (&engine->search, &engine->search_state, &result))
+    {
+      send_line (engine, "bestmove none");
+      return NULL;
+    }
+  /* The protocol promises no answer to `go infinite' before `stop'.
+     This should be rare, so polling is good enough.  */
+  while (engine->infinite && !g_atomic_int_get (&engine->search.stop))
+    g_usleep (1000);
+  record_format_move (&result.best, move);
+  send_line (engine, "bestmove %s", move);
+  return NULL;
+}
+
+/* Stop the search, if any, and wait until it has reported its best
+   move.  */
+static void
+stop_search (Engine *engine)
+{
+  if (!engine->thinking)
+    return;
+  search_stop (&engine->search);
+  pthread_join (engine->thread, NULL);
+  engine->thinking = false;
+}
+
+/* Parse a non-negative integer argument of a command.  */
+static bool
+parse_count (const gchar *word, guint64 *value)
+{
+  gchar *end;
+  if (word == NULL || !g_ascii_isdigit (*word))
+    return false;
+  *value = g_ascii_strtoull (word, &end, 10);
+  return *end == '\0';
+}
+
+/* Handle the `position' command.  The position is only changed if the
+   whole command is valid.  */
+static void
+handle_position (Engine *engine, gchar *args)
+{
+  GameState state;
+  const gchar *p;
+  gchar *word = record_next_word (&args);
+  Move move;
+  int status;
+
+  if (word != NULL && !strcmp ("startpos", word))
+    init_game_state (&state);
+  else if (word != NULL && !strcmp ("key", word))
+    {
+      gchar *end;
+      StateKey key;
+      word = record_next_word (&args);
+      if (word == NULL)
+	{
+	  g_printerr ("morris-engine: missing position key\n");
+	  return;
+	}
+      key = g_ascii_strtoull (word, &end, 16);
+      if (*end != '\0' || !is_valid_state_key (key))
+	{
+	  g_printerr ("morris-engine: invalid position key %s\n", word);
+	  return;
+	}
+      unpack_state (key, &state);
+    }
+  else
+    {
+      g_printerr ("morris-engine: expected `startpos' or `key'\n");
+      return;
+    }
+
+  word = record_next_word (&args);
+  if (word != NULL && strcmp ("moves", word))
+    {
+      g_printerr ("morris-engine: expected `moves' instead of `%s'\n",
+		  word);
+      return;
+    }
+  p = args;
+  while ((status = record_parse_move (&p, &move)) > 0)
+    {
+      if (!record_play_move (&state, &move))
+	{
+	  gchar text[RECORD_MOVE_TEXT_SIZE];
+	  record_format_move (&move, text);
+	  g_printerr ("morris-engine: illegal move %s\n", text);
+	  return;
+	}
+    }
+  if (status < 0)
+    {
+      g_printerr ("morris-engine: cannot parse move `%s'\n", p);
+      return;
+    }
+  engine->state = state;
+}
+
+/* Handle the `go' command.  */
+static void
+handle_go (Engine *engine, gchar *args)
+{
+  guint64 depth = SEARCH_MAX_DEPTH, movetime = 0;
+  bool infinite = false;
+  gchar *word;
+
+  while ((word = record_next_word (&args)) != NULL)
+    {
+      if (!strcmp ("infinite", word))
+	infinite = true;
+      else if (!strcmp ("depth", word))
+	{
+	  if (!parse_count (record_next_word (&args), &depth) || depth == 0)
+	    {
+	      g_printerr ("morris-engine: invalid depth\n");
+	      return;
+	    }
+	}
+      else if (!strcmp ("movetime", word))
+	{
+	  if (!parse_count (record_next_word (&args), &movetime))
+	    {
+	      g_printerr ("morris-engine: invalid move time\n");
+	      return;
+	    }
+	}
+      else
+	{
+	  g_printerr ("morris-engine: unknown search limit `%s'\n", word);
+	  return;
+	}
+    }
+
+  stop_search (engine);
+  engine->search.max_depth = MIN (depth, SEARCH_MAX_DEPTH);
+  engine->search.deadline = (movetime > 0 && !infinite) ?
+    g_get_monotonic_time () + (gint64) movetime * 1000 : 0;
+  engine->search.stop = 0;
+  engine->search_state = engine->state;
+  engine->infinite = infinite;
+  if (pthread_create (&engine->thread, NULL, search_thread_main,
+		      engine) != 0)
+    {
+      g_printerr ("morris-engine: cannot start the search thread\n");
+      send_line (engine, "bestmove none");
+      return;
+    }
+  engine->thinking = true;
+}
+
+/* Handle one command.  Returns false on `quit'.  */
+static bool
+handle_command (Engine *engine, gchar *line)
+{
+  gchar *command = record_next_word (&line);
+  if (command == NULL)
+    return true;
+  if (!strcmp ("go", command))
+    handle_go (engine, line);
+  else if (!strcmp ("stop", command))
+    stop_search (engine);
+  else if (!strcmp ("isready", command))
+    send_line (engine, "readyok");
+  else if (!strcmp ("position", command))
+    {
+      stop_search (engine);
+      handle_position (engine, line);
+    }
+  else if (!strcmp ("newgame", command))
+    {
+      stop_search (engine);
+      init_game_state (&engine->state);
+    }
+  else if (!strcmp ("morris", command))
+    {
+      send_line (engine, "id name morris-engine " VERSION);
+      send_line (engine, "id variant " VARIANT_NAME);
+      send_line (engine, "id flying %s", FLYING_RULE ? "yes" : "no");
+      send_line (engine, "morrisok");
+    }
+  else if (!strcmp ("quit", command))
+    return false;
+  else
+    g_printerr ("morris-engine: unknown command `%s'\n", command);
+  return true;
+}
+
+static void
+print_usage (void)
+{
+  puts ("Usage: morris-engine [OPTION]...\n"
+	"Play " VARIANT_NAME " through a line protocol on standard "
+	"input and\n"
+	"output.\n"
+	"\n"
+	"  -w, --weights FILE    evaluation weights (default: built in)\n"
+	"  -h, --help            display this help and exit");
+}
+
+int
+main (int argc, char *argv[])
+{
+  Engine engine;
+  EvalWeights weights = eval_default_weights;
+  GString *line;
+  int i;
+
+  for (i = 1; i < argc; i++)
+    {
+      const char *arg = argv[i];
+      if (!strcmp ("-h", arg) || !strcmp ("--help", arg))
+	{
+	  print_usage ();
+	  return 0;
+	}
+      else if ((!strcmp ("-w", arg) || !strcmp ("--weights", arg)) &&
+	       i + 1 < argc)
+	{
+	  if (!eval_load_weights (argv[++i], &weights))
+	    {
+	      g_printerr ("morris-engine: cannot read weights from %s\n",
+			  argv[i]);
+	      return 1;
+	    }
+	}
+      else
+	{
+	  g_printerr ("morris-engine: unknown option `%s'\n", arg);
+	  print_usage ();
+	  return 1;
+	}
+    }
+
+  memset (&engine, 0, sizeof (engine));
+  init_game_state (&engine.state);
+  search_init (&engine.search);
+  engine.search.weights = &weights;
+  engine.search.report = report_iteration;
+  engine.search.report_data = &engine;
+  pthread_mutex_init (&engine.output_lock, NULL);
+
+  line = g_string_sized_new (1024);
+  while (record_read_line (stdin, line))
+    {
+      if (!handle_command (&engine, line->str))
+	break;
+    }
+  stop_search (&engine);
+  g_string_free (line, TRUE);
+  pthread_mutex_destroy (&engine.output_lock);
+  return 0;
+}
@@ -0,0 +1,903 @@
+/* Differential fuzzing of the rules engines.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Differential fuzzing of the rules engines.
+ *
+ * morris.c has two code paths chosen by USE_PACKED, plus assembly
+ * code chosen by HAVE_X86_ASM, and the unpacked path is not used as
+ * much as the packed one.  This program plays random games on every
+ * engine in fuzz.h at once.  After each move, it checks that the
+ * engines agree on every position of the board, on the legality of
+ * every placement, move and removal, on mill detection, on the winner,
+ * on the list of legal moves, and on the packed game state.  It also
+ * tries random moves, most of which are illegal, and checks that the
+ * engines agree on whether to accept them.  Finally, it checks that
+ * every variant of the simulator kernels in kernels.c that the
+ * processor can run gives the same children, hashes and mills, and
+ * that the batched feature extraction of eval.c gives the same
+ * features as the one for a single position.
+ *
+ * After the games, the value arrays of valarray.c are checked against
+ * plain byte arrays under random updates, including arrays that end
+ * in a partial word, and several threads race to update the same
+ * words to make sure that no update is lost.  Finally, opening books
+ * with corrupt entries are written, and book.c must refuse to open
+ * them.
+ *
+ * Games start from the empty board or from the positions in a corpus
+ * file written by morris-corpus.  Every game is seeded from the seed
+ * and the game number, so a failure can be reproduced with the same
+ * options.  On the first disagreement, the program prints the game,
+ * the position, and the check that failed, and exits with an error.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#include "wpthread.h"
+#else
+#include <pthread.h>
+#endif
+
+#ifndef G_OS_WIN32
+#include <unistd.h>
+#endif
+
+#include "morris.h"
+#include "book.h"
+#include "corpus.h"
+#include "eval.h"
+#include "fuzz.h"
+#include "kernels.h"
+#include "valarray.h"
+
+/** Random moves are tried in one out of this many positions.  */
+#define PROBE_INTERVAL 4
+/** Random updates applied to each value array.  */
+#define VALUE_UPDATES 20000
+/** Threads that race to update the same value array.  */
+#define VALUE_THREADS 4
+/** Entries of the value arrays that the threads race on.  */
+#define VALUE_RACE_LENGTH 100003
+
+static const FuzzEngine *engines[] = {
+  &fuzz_packed_engine,
+  &fuzz_portable_engine,
+  &fuzz_unpacked_engine,
+  &fuzz_bitboard_engine,
+};
+#define NUM_ENGINES (sizeof (engines) / sizeof (FuzzEngine *))
+
+/** The state of one game on every engine.  */
+struct FuzzGame_tag
+{
+  guint number;
+  guint num_moves;
+  void *states[NUM_ENGINES];
+  void *scratch[NUM_ENGINES];
+  StateKey *keys; /**< The positions of the game so far */
+};
+typedef struct FuzzGame_tag FuzzGame;
+
+static void
+print_move (const Move *move)
+{
+  switch (move->type)
+    {
+    case MOVE_PLACE:
+      g_printerr ("place %u", move->dest);
+      break;
+    case MOVE_MOVE:
+      g_printerr ("move %u-%u", move->src, move->dest);
+      break;
+    case MOVE_REMOVE:
+      g_printerr ("remove %u", move->dest);
+      break;
+    default:
+      g_printerr ("move of type %u", move->type);
+    }
+}
+
+/* Report a disagreement between the first engine and another.  */
+static bool
+report (FuzzGame *game, guint engine, const char *check, guint value0,
+	guint value)
+{
+  g_printerr ("morris-fuzz: game %u, move %u, state %#" G_GINT64_MODIFIER
+	      "x: %s: %s says %u, %s says %u\n",
+	      game->number, game->num_moves,
+	      engines[0]->pack_state (game->states[0]), check,
+	      engines[0]->name, value0, engines[engine]->name, value);
+  return false;
+}
+
+static int
+compare_keys (const void *a, const void *b)
+{
+  StateKey x = *(const StateKey *) a, y = *(const StateKey *) b;
+  return (x > y) - (x < y);
+}
+
+static int
+compare_moves (const void *a, const void *b)
+{
+  const Move *x = (const Move *) a, *y = (const Move *) b;
+  if (x->type != y->type)
+    return (x->type > y->type) - (x->type < y->type);
+  if (x->src != y->src)
+    return (x->src > y->src) - (x->src < y->src);
+  return (x->dest > y->dest) - (x->dest < y->dest);
+}
+
+/* Generate the legal moves in a canonical order, so that the moves of
+   different engines can be compared.  */
+static guint
+sorted_moves (const FuzzEngine *engine, void *state, Move *moves)
+{
+  guint num_moves = engine->gen_moves (state, moves);
+  guint i;
+  /* morris.c only sets the source of sliding moves.  */
+  for (i = 0; i < num_moves; i++)
+    {
+      if (moves[i].type != MOVE_MOVE)
+	moves[i].src = 0;
+    }
+  qsort (moves, num_moves, sizeof (Move), compare_moves);
+  return num_moves;
+}
+
+/**
+ * Check that every engine agrees with the first one about the
+ * current position.
+ */
+static bool
+check_position (FuzzGame *game, Move *moves, guint *num_moves)
+{
+  const FuzzEngine *ref = engines[0];
+  void *ref_state = game->states[0];
+  guint i;
+
+  *num_moves = sorted_moves (ref, ref_state, moves);
+  for (i = 1; i < NUM_ENGINES; i++)
+    {
+      const FuzzEngine *engine = engines[i];
+      void *state = game->states[i];
+      Move other_moves[MAX_MOVES];
+      guint num_other, j;
+      guchar pos, dest;
+
+      if (engine->pack_state (state) != ref->pack_state (ref_state))
+	{
+	  g_printerr ("morris-fuzz: game %u, move %u: state is %#"
+		      G_GINT64_MODIFIER "x on %s but %#" G_GINT64_MODIFIER
+		      "x on %s\n", game->number, game->num_moves,
+		      ref->pack_state (ref_state), ref->name,
+		      engine->pack_state (state), engine->name);
+	  return false;
+	}
+      if (engine->get_winner (state) != ref->get_winner (ref_state))
+	return report (game, i, "get_winner", ref->get_winner (ref_state),
+		       engine->get_winner (state));
+
+      for (pos = 0; pos < BOARD_SIZE; pos++)
+	{
+#define CHECK(func, desc)						\
+	  if (engine->func (state, pos) != ref->func (ref_state, pos))	\
+	    {								\
+	      gchar *msg = g_strdup_printf (desc " at %u", pos);	\
+	      report (game, i, msg, ref->func (ref_state, pos),		\
+		      engine->func (state, pos));			\
+	      g_free (msg);						\
+	      return false;						\
+	    }
+	  CHECK (board_ref, "board_ref");
+	  CHECK (is_valid_place, "is_valid_place");
+	  CHECK (is_valid_remove, "is_valid_remove");
+	  CHECK (is_mill_formed, "is_mill_formed");
+#undef CHECK
+	  for (dest = 0; dest < BOARD_SIZE; dest++)
+	    {
+	      bool ref_valid = ref->is_valid_move (ref_state, pos, dest);
+	      if (engine->is_valid_move (state, pos, dest) != ref_valid)
+		{
+		  gchar *msg = g_strdup_printf ("is_valid_move from %u to %u",
+						pos, dest);
+		  report (game, i, msg, ref_valid, !ref_valid);
+		  g_free (msg);
+		  return false;
+		}
+	    }
+	}
+
+      num_other = sorted_moves (engine, state, other_moves);
+      if (num_other != *num_moves)
+	return report (game, i, "number of legal moves", *num_moves,
+		       num_other);
+      for (j = 0; j < num_other; j++)
+	{
+	  if (compare_moves (&moves[j], &other_moves[j]) != 0)
+	    {
+	      g_printerr ("morris-fuzz: game %u, move %u: legal move %u is ",
+			  game->number, game->num_moves, j);
+	      print_move (&moves[j]);
+	      g_printerr (" for %s but ", ref->name);
+	      print_move (&other_moves[j]);
+	      g_printerr (" for %s\n", engine->name);
+	      return false;
+	    }
+	}
+    }
+  return true;
+}
+
+/**
+ * Check that every kernel variant agrees with the first engine about
+ * the children of the current position.
+ */
+static bool
+check_kernels (FuzzGame *game, Move *moves, guint num_moves)
+{
+  const FuzzEngine *ref = engines[0];
+  StateKey key = ref->pack_state (game->states[0]);
+  StateKey children[MAX_MOVES], kernel_children[MAX_MOVES];
+  const Kernels *const *variants;
+  guint64 hash;
+  guint32 mills = 0;
+  guint num_variants, i;
+
+  for (i = 0; i < num_moves; i++)
+    {
+      memcpy (game->scratch[0], game->states[0], ref->state_size);
+      ref->play_move (game->scratch[0], &moves[i]);
+      children[i] = ref->pack_state (game->scratch[0]);
+    }
+  qsort (children, num_moves, sizeof (StateKey), compare_keys);
+
+  variants = kernels_available (&num_variants);
+  for (i = 0; i < num_variants; i++)
+    {
+      guint num_children;
+      guint32 variant_mills;
+      variants[i]->expand_keys (&key, 1, kernel_children, &num_children);
+      qsort (kernel_children, num_children, sizeof (StateKey),
+	     compare_keys);
+      if (num_children != num_moves ||
+	  memcmp (children, kernel_children,
+		  num_moves * sizeof (StateKey)) != 0)
+	{
+	  g_printerr ("morris-fuzz: game %u, move %u, state %#"
+		      G_GINT64_MODIFIER "x: %s kernels give %u children, "
+		      "%s gives %u or different ones\n", game->number,
+		      game->num_moves, key, variants[i]->name, num_children,
+		      ref->name, num_moves);
+	  return false;
+	}
+
+      variants[i]->hash_keys (&key, &hash, 1);
+      variants[i]->mill_scan (&key, &variant_mills, 1);
+      if (hash != hash_state_key (key) ||
+	  (i > 0 && variant_mills != mills))
+	{
+	  g_printerr ("morris-fuzz: game %u, move %u, state %#"
+		      G_GINT64_MODIFIER "x: %s kernels give a different "
+		      "hash or different mills\n", game->number,
+		      game->num_moves, key, variants[i]->name);
+	  return false;
+	}
+      mills = variant_mills;
+    }
+  return true;
+}
+
+/**
+ * Check the bulk movement helpers of morris.c against the legal moves
+ * of the first engine.
+ */
+static bool
+check_mobility (FuzzGame *game, Move *moves, guint num_moves)
+{
+  StateKey key = engines[0]->pack_state (game->states[0]);
+  GameState state;
+  guint32 dests = 0;
+  guint mobility, i;
+
+  unpack_state (key, &state);
+  if (state.setup_rounds_left > 0 || state.remove_state || num_moves == 0)
+    return true;
+  for (i = 0; i < num_moves; i++)
+    dests |= 1 << moves[i].dest;
+  mobility = count_mobility (&state, state.cur_player);
+  if (mobility != num_moves || empty_neighbors (&state) != dests)
+    {
+      g_printerr ("morris-fuzz: game %u, move %u, state %#"
+		  G_GINT64_MODIFIER "x: count_mobility says %u and "
+		  "empty_neighbors says %#x, but there are %u moves to %#x\n",
+		  game->number, game->num_moves, key, mobility,
+		  empty_neighbors (&state), num_moves, dests);
+      return false;
+    }
+  return true;
+}
+
+/**
+ * Check that the batched feature extraction of eval.c gives the same
+ * features for every position of a game as the one for a single
+ * position.
+ */
+static bool
+check_eval (FuzzGame *game, guint num_keys)
+{
+  gint16 *batch = g_new (gint16, num_keys * EVAL_NUM_FEATURES);
+  gint16 single[EVAL_NUM_FEATURES];
+  bool success = true;
+  guint i, j;
+
+  eval_extract (game->keys, num_keys, batch);
+  for (i = 0; i < num_keys && success; i++)
+    {
+      eval_extract_one (game->keys[i], single);
+      for (j = 0; j < EVAL_NUM_FEATURES; j++)
+	{
+	  if (batch[i*EVAL_NUM_FEATURES+j] != single[j])
+	    {
+	      g_printerr ("morris-fuzz: game %u, move %u, state %#"
+			  G_GINT64_MODIFIER "x: feature %s is %d in a "
+			  "batch, %d alone\n", game->number, i,
+			  game->keys[i], eval_feature_names[j],
+			  batch[i*EVAL_NUM_FEATURES+j], single[j]);
+	      success = false;
+	      break;
+	    }
+	}
+    }
+  g_free (batch);
+  return success;
+}
+
+/* Play a move on every engine and check that they all accept or
+   reject it.  When probing, the move is played on scratch copies.  */
+static bool
+play_everywhere (FuzzGame *game, Move *move, bool probe)
+{
+  bool ref_played = false;
+  guint i;
+  for (i = 0; i < NUM_ENGINES; i++)
+    {
+      void *state = game->states[i];
+      bool played;
+      if (probe)
+	{
+	  memcpy (game->scratch[i], state, engines[i]->state_size);
+	  state = game->scratch[i];
+	}
+      played = engines[i]->play_move (state, move);
+      if (i == 0)
+	ref_played = played;
+      else if (played != ref_played)
+	{
+	  g_printerr ("morris-fuzz: game %u, move %u: ", game->number,
+		      game->num_moves);
+	  print_move (move);
+	  g_printerr (" is %s by %s but %s by %s\n",
+		      ref_played ? "accepted" : "rejected", engines[0]->name,
+		      played ? "accepted" : "rejected", engines[i]->name);
+	  return false;
+	}
+    }
+  if (probe && ref_played)
+    {
+      for (i = 1; i < NUM_ENGINES; i++)
+	{
+	  if (engines[i]->pack_state (game->scratch[i]) !=
+	      engines[0]->pack_state (game->scratch[0]))
+	    {
+	      g_printerr ("morris-fuzz: game %u, move %u: ", game->number,
+			  game->num_moves);
+	      print_move (move);
+	      g_printerr (" leads to different states on %s and %s\n",
+			  engines[0]->name, engines[i]->name);
+	      return false;
+	    }
+	}
+    }
+  return true;
+}
+
+/**
+ * Play one random game on every engine.
+ *
+ * @param game the game, with its number set
+ * @param start the position to start from, or @a NULL for a new game
+ * @param seed the random seed of the game
+ * @param max_moves the length at which to cut the game off
+ * @return @a true if the engines always agreed
+ */
+static bool
+fuzz_game (FuzzGame *game, const StateKey *start, guint64 seed,
+	   guint max_moves)
+{
+  guint64 rng_state = seed;
+  guint num_keys = 0, i;
+
+  for (i = 0; i < NUM_ENGINES; i++)
+    {
+      if (start != NULL)
+	engines[i]->unpack_state (*start, game->states[i]);
+      else
+	engines[i]->init_game_state (game->states[i]);
+    }
+
+  for (game->num_moves = 0; game->num_moves < max_moves; game->num_moves++)
+    {
+      Move moves[MAX_MOVES];
+      guint num_moves;
+
+      if (!check_position (game, moves, &num_moves) ||
+	  !check_kernels (game, moves, num_moves) ||
+	  !check_mobility (game, moves, num_moves))
+	return false;
+      game->keys[num_keys++] = engines[0]->pack_state (game->states[0]);
+      if (corpus_random (&rng_state) % PROBE_INTERVAL == 0)
+	{
+	  Move probe;
+	  probe.type = corpus_random (&rng_state) % 3;
+	  probe.src = corpus_random (&rng_state) % BOARD_SIZE;
+	  probe.dest = corpus_random (&rng_state) % BOARD_SIZE;
+	  if (!play_everywhere (game, &probe, true))
+	    return false;
+	}
+      if (num_moves == 0)
+	break;
+      if (!play_everywhere (game,
+			    &moves[corpus_random (&rng_state) % num_moves],
+			    false))
+	return false;
+    }
+  return check_eval (game, num_keys);
+}
+
+/* Report a difference between a value array and its model.  */
+static bool
+report_value (ValueArray *array, const char *check, guint64 index,
+	      guint value0, guint value)
+{
+  g_printerr ("morris-fuzz: %u-bit value array of %" G_GUINT64_FORMAT
+	      " entries: %s of entry %" G_GUINT64_FORMAT " is %u, "
+	      "should be %u\n", array->bits, array->length, check, index,
+	      value, value0);
+  return false;
+}
+
+/* Compare every entry and the count of every value with the model.  */
+static bool
+compare_value_array (ValueArray *array, const guchar *model)
+{
+  guint64 counts[16] = { 0 };
+  guchar max_value = (1 << array->bits) - 1;
+  guint64 i;
+  for (i = 0; i < array->length; i++)
+    {
+      if (value_array_get (array, i) != model[i])
+	return report_value (array, "get", i, model[i],
+			     value_array_get (array, i));
+      counts[model[i]]++;
+    }
+  for (i = 0; i <= max_value; i++)
+    {
+      guint64 count = value_array_count (array, i);
+      if (count != counts[i])
+	{
+	  g_printerr ("morris-fuzz: %u-bit value array of %"
+		      G_GUINT64_FORMAT " entries: %" G_GUINT64_FORMAT
+		      " entries counted with value %u, should be %"
+		      G_GUINT64_FORMAT "\n", array->bits, array->length,
+		      count, (guint) i, counts[i]);
+	  return false;
+	}
+    }
+  return true;
+}
+
+/**
+ * Apply random sets, compare and swaps and additions to a value array
+ * and to a plain byte array, and check that they agree.
+ *
+ * @param bits the number of bits per entry
+ * @param length the number of entries
+ * @param rng_state the random number generator to use
+ * @return @a true if the value array always agreed
+ */
+static bool
+check_value_array (guchar bits, guint64 length, guint64 *rng_state)
+{
+  ValueArray *array = value_array_new (length, bits);
+  guchar *model = g_new0 (guchar, length);
+  guchar max_value = (1 << bits) - 1;
+  bool success = compare_value_array (array, model);
+  guint i;
+
+  for (i = 0; i < VALUE_UPDATES && success; i++)
+    {
+      guint64 index = corpus_random (rng_state) % length;
+      guchar value = corpus_random (rng_state) & max_value;
+      guchar old_value = corpus_random (rng_state) & max_value;
+      gint delta = (gint) (corpus_random (rng_state) % 7) - 3;
+      gint sum;
+      switch (corpus_random (rng_state) % 3)
+	{
+	case 0:
+	  value_array_set (array, index, value);
+	  model[index] = value;
+	  break;
+	case 1:
+	  if (value_array_cas (array, index, old_value, value) !=
+	      (model[index] == old_value))
+	    success = report_value (array, "compare and swap", index,
+				    model[index], old_value);
+	  if (model[index] == old_value)
+	    model[index] = value;
+	  break;
+	default:
+	  sum = CLAMP (model[index] + delta, 0, max_value);
+	  if (value_array_add (array, index, delta) != sum)
+	    success = report_value (array, "sum", index, sum,
+				    value_array_get (array, index));
+	  model[index] = sum;
+	}
+      if (success && value_array_get (array, index) != model[index])
+	success = report_value (array, "get", index, model[index],
+				value_array_get (array, index));
+    }
+  if (success)
+    success = compare_value_array (array, model);
+  value_array_free (array);
+  g_free (model);
+  return success;
+}
+
+/** A thread that races the others to update a value array.  */
+struct ValueRacer_tag
+{
+  pthread_t thread;
+  ValueArray *claims; /**< Entries to claim with ValueRacer::value */
+  ValueArray *sums; /**< Entries to add one to */
+  guchar value;
+  guint64 num_claimed;
+};
+typedef struct ValueRacer_tag ValueRacer;
+
+static void *
+value_racer_main (void *user_data)
+{
+  ValueRacer *racer = (ValueRacer *) user_data;
+  guint64 i;
+  for (i = 0; i < racer->claims->length; i++)
+    {
+      if (value_array_cas (racer->claims, i, VALUE_UNKNOWN, racer->value))
+	racer->num_claimed++;
+      value_array_add (racer->sums, i, 1);
+    }
+  return NULL;
+}
+
+/**
+ * Let several threads claim every entry of a value array with their
+ * own value by compare and swap, and add one to every entry of
+ * another, at the same time.  Every entry must be claimed exactly
+ * once, and every addition must stay.
+ *
+ * @param bits the number of bits per entry of the claimed array
+ * @return @a true if no update was lost
+ */
+static bool
+race_value_array (guchar bits)
+{
+  ValueRacer racers[VALUE_THREADS];
+  ValueArray *claims = value_array_new (VALUE_RACE_LENGTH, bits);
+  ValueArray *sums = value_array_new (VALUE_RACE_LENGTH, 4);
+  guint64 counts[16] = { 0 };
+  guchar max_value = (1 << bits) - 1;
+  bool success = true;
+  guint i;
+
+  for (i = 0; i < VALUE_THREADS; i++)
+    {
+      racers[i].claims = claims;
+      racers[i].sums = sums;
+      racers[i].value = 1 + i % max_value;
+      racers[i].num_claimed = 0;
+      pthread_create (&racers[i].thread, NULL, value_racer_main,
+		      &racers[i]);
+    }
+  for (i = 0; i < VALUE_THREADS; i++)
+    {
+      pthread_join (racers[i].thread, NULL);
+      counts[racers[i].value] += racers[i].num_claimed;
+    }
+
+  for (i = 0; i <= max_value && success; i++)
+    {
+      guint64 count = value_array_count (claims, i);
+      if (count != counts[i])
+	{
+	  g_printerr ("morris-fuzz: %u-bit value array: %" G_GUINT64_FORMAT
+		      " entries have value %u, but %" G_GUINT64_FORMAT
+		      " were claimed with it\n", bits, count, i, counts[i]);
+	  success = false;
+	}
+    }
+  if (success && value_array_count (sums, VALUE_THREADS) != sums->length)
+    {
+      g_printerr ("morris-fuzz: 4-bit value array: only %"
+		  G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT " entries "
+		  "were counted up by all %u threads\n",
+		  value_array_count (sums, VALUE_THREADS), sums->length,
+		  (guint) VALUE_THREADS);
+      success = false;
+    }
+  value_array_free (claims);
+  value_array_free (sums);
+  return success;
+}
+
+/**
+ * Check the value arrays with 2-bit and 4-bit entries.
+ *
+ * @param seed the random seed
+ * @return @a true if all checks passed
+ */
+static bool
+check_value_arrays (guint64 seed)
+{
+  /* Lengths that fill whole words of both entry sizes, and lengths
+     that end in the middle of a word.  */
+  static const guint64 lengths[] = { 1, 15, 16, 31, 32, 33, 1021 };
+  guint64 rng_state = hash_state_key (seed);
+  guchar bits;
+  guint i;
+
+  if (rng_state == 0)
+    rng_state = 1;
+  for (bits = 2; bits <= 4; bits += 2)
+    {
+      for (i = 0; i < G_N_ELEMENTS (lengths); i++)
+	{
+	  if (!check_value_array (bits, lengths[i], &rng_state))
+	    return false;
+	}
+      if (!race_value_array (bits))
+	return false;
+    }
+  return true;
+}
+
+/* Write a book and check whether book_open() accepts it, and that a
+   book it accepts gives back its moves.  */
+static bool
+book_opens (const gchar *path, const BookEntry *entries, gsize count)
+{
+  Book *book;
+  bool opened;
+  if (!book_write (path, entries, count))
+    {
+      g_printerr ("morris-fuzz: cannot write %s\n", path);
+      return false;
+    }
+  book = book_open (path);
+  opened = (book != NULL);
+  if (opened)
+    book_free (book);
+  return opened;
+}
+
+/**
+ * Check that book_open() rejects books with entries that are out of
+ * range or out of order, and accepts the same book without the
+ * damage.
+ *
+ * @return @a true if every book was accepted or rejected as it should
+ */
+static bool
+check_books (void)
+{
+  static const char *damage[] = {
+    NULL, "a move type out of range", "a source outside the board",
+    "a destination outside the board", "an invalid position",
+    "positions out of order",
+  };
+  BookEntry entries[2];
+  GameState state;
+  Move first = { MOVE_PLACE, 0, 0 };
+  gchar *path;
+  bool success = true;
+  guint i;
+  int fd;
+
+  fd = g_file_open_tmp ("morris-fuzz-XXXXXX.book", &path, NULL);
+  if (fd < 0)
+    {
+      g_printerr ("morris-fuzz: cannot create a temporary book\n");
+      return false;
+    }
+  close (fd);
+
+  for (i = 0; i < G_N_ELEMENTS (damage) && success; i++)
+    {
+      memset (entries, 0, sizeof (entries));
+      init_game_state (&state);
+      entries[0].key = book_canonical_key (pack_state (&state), NULL);
+      play_move (&state, &first);
+      entries[1].key = book_canonical_key (pack_state (&state), NULL);
+      entries[1].dest = 1;
+      entries[0].weight = entries[1].weight = 1;
+      switch (i)
+	{
+	case 1:
+	  entries[1].type = MOVE_REMOVE + 1;
+	  break;
+	case 2:
+	  entries[1].type = MOVE_MOVE;
+	  entries[1].src = BOARD_SIZE;
+	  break;
+	case 3:
+	  entries[1].dest = 200;
+	  break;
+	case 4:
+	  entries[1].key |= 0x03 << 2;
+	  break;
+	case 5:
+	  entries[1].key = entries[0].key;
+	  entries[0].key = book_canonical_key (pack_state (&state), NULL);
+	  break;
+	}
+      if (book_opens (path, entries, G_N_ELEMENTS (entries)) !=
+	  (damage[i] == NULL))
+	{
+	  if (damage[i] == NULL)
+	    g_printerr ("morris-fuzz: a valid book was rejected\n");
+	  else
+	    g_printerr ("morris-fuzz: a book with %s was accepted\n",
+			damage[i]);
+	  success = false;
+	}
+    }
+  g_unlink (path);
+  g_free (path);
+  return success;
+}
+
+static void
+print_usage (void)
+{
+  puts ("Usage: morris-fuzz [OPTION]...\n"
+	"Play random games on every rules engine and check that they "
+	"agree.\n"
+	"\n"
+	"  -n, --games N         number of games to play (default: 1000)\n"
+	"  -s, --seed N          random seed (default: a fixed seed)\n"
+	"  -m, --max-moves N     cut games off after N moves (default: 300)\n"
+	"  -c, --corpus FILE     start games from the positions in FILE\n"
+	"  -h, --help            display this help and exit");
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint num_games = 1000, max_moves = 300;
+  guint64 seed = CORPUS_DEFAULT_SEED;
+  const char *corpus_file = NULL;
+  StateKey *corpus = NULL;
+  guint corpus_size = 0;
+  guint64 total_moves = 0;
+  FuzzGame game;
+  bool success = true;
+  guint num_variants, i;
+
+  for (i = 1; i < (guint) argc; i++)
+    {
+      const char *arg = argv[i];
+      const char *value = (i + 1 < (guint) argc) ? argv[i+1] : NULL;
+      if (!strcmp ("-h", arg) || !strcmp ("--help", arg))
+	{
+	  print_usage ();
+	  return 0;
+	}
+      else if (value == NULL)
+	{
+	  g_printerr ("morris-fuzz: missing argument for `%s'\n", arg);
+	  return 1;
+	}
+      else if (!strcmp ("-n", arg) || !strcmp ("--games", arg))
+	num_games = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-s", arg) || !strcmp ("--seed", arg))
+	seed = g_ascii_strtoull (argv[++i], NULL, 0);
+      else if (!strcmp ("-m", arg) || !strcmp ("--max-moves", arg))
+	max_moves = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-c", arg) || !strcmp ("--corpus", arg))
+	corpus_file = argv[++i];
+      else
+	{
+	  g_printerr ("morris-fuzz: unknown option `%s'\n", arg);
+	  print_usage ();
+	  return 1;
+	}
+    }
+
+  if (corpus_file != NULL)
+    {
+      corpus = corpus_read (corpus_file, &corpus_size);
+      if (corpus == NULL || corpus_size == 0)
+	{
+	  g_printerr ("morris-fuzz: cannot read corpus %s\n", corpus_file);
+	  return 1;
+	}
+    }
+
+  for (i = 0; i < NUM_ENGINES; i++)
+    {
+      game.states[i] = g_malloc0 (engines[i]->state_size);
+      game.scratch[i] = g_malloc0 (engines[i]->state_size);
+    }
+  game.keys = g_new (StateKey, MAX (max_moves, 1));
+  for (game.number = 0; game.number < num_games && success; game.number++)
+    {
+      /* Every game gets its own stream of random numbers, so that a
+	 failing game does not depend on the games before it.  */
+      guint64 game_seed = hash_state_key (seed + game.number);
+      if (game_seed == 0)
+	game_seed = 1;
+      success = fuzz_game (&game, (corpus != NULL) ?
+			   &corpus[game.number % corpus_size] : NULL,
+			   game_seed, max_moves);
+      total_moves += game.num_moves;
+    }
+  for (i = 0; i < NUM_ENGINES; i++)
+    {
+      g_free (game.states[i]);
+      g_free (game.scratch[i]);
+    }
+  g_free (game.keys);
+  g_free (corpus);
+
+  if (!success || !check_value_arrays (seed) || !check_books ())
+    return 1;
+  kernels_available (&num_variants);
+  printf ("%u games, %" G_GUINT64_FORMAT " moves: all %u engines and %u "
+	  "kernel variants agree\n", num_games, total_moves,
+	  (guint) NUM_ENGINES, num_variants);
+  printf ("value arrays agree with their models, and corrupt books "
+	  "are rejected\n");
+  return 0;
+}
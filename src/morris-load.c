@@ -0,0 +1,541 @@
+/* Load generator for the game server.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Load generator for the game server.
+ *
+ * morris-load opens many connections to morris-server and plays many
+ * games on each of them at once, taking both seats of every game and
+ * choosing random legal moves.  Each game always has one move on its
+ * way, so the server sees as many commands in flight as there are
+ * games.  The time from sending a move until its "ok" answer arrives
+ * is recorded, and at the end the number of moves per second and the
+ * percentiles of these latencies are printed.  A game that runs too
+ * long is resigned, so that new games keep starting.
+ *
+ * With --quitters, extra connections are opened during the run that
+ * ask for a game and reset the connection before the answer arrives,
+ * so that the server has to handle writes that fail.  The run fails
+ * if the server stops answering the other connections.
+ *
+ * The client is a single thread that waits with poll(), so run it on
+ * a different processor than the server, or on another machine, to
+ * measure the server alone.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <glib.h>
+
+#ifndef G_OS_WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#endif
+
+#include "morris.h"
+#include "corpus.h"
+#include "net.h"
+#include "record.h"
+#include "stats.h"
+
+#ifndef G_OS_WIN32
+
+/** Plies after which a game is resigned.  */
+#define LOAD_MAX_PLIES 200
+/** The size of the buffer that the server is read into.  */
+#define LOAD_READ_SIZE (64 * 1024)
+/** The number of errors from the server that are shown.  */
+#define LOAD_MAX_SHOWN_ERRORS 10
+
+/** A game that is being played.  */
+struct LoadGame_tag
+{
+  guint64 id; /**< The number of the game on the server */
+  bool numbered; /**< Whether LoadGame::id is known */
+  guint starts; /**< Number of "start" answers, 2 once it started */
+  GameState state;
+  guint plies;
+  gint64 sent; /**< When the last move was sent */
+};
+typedef struct LoadGame_tag LoadGame;
+
+/** A connection with the games that are played on it.  */
+struct LoadConn_tag
+{
+  int fd;
+  GString *in; /**< The start of an answer without its newline */
+  GString *out;
+  gsize out_pos; /**< Bytes of LoadConn::out that were already sent */
+  LoadGame *games;
+  /** Games that wait for a number, in the order they were opened.  */
+  guint *opening;
+  guint opening_head, opening_len;
+};
+typedef struct LoadConn_tag LoadConn;
+
+struct Load_tag
+{
+  LoadConn *conns;
+  guint num_conns;
+  guint games_per_conn;
+  guint64 rng_state;
+  bool running; /**< Whether new moves and games are started */
+  GArray *latencies; /**< Microseconds until each move was confirmed */
+  guint64 num_games;
+  guint64 num_errors;
+  guint64 num_quitters; /**< Connections that were reset on purpose */
+};
+typedef struct Load_tag Load;
+
+/* Queue one line for the server.  */
+static void
+send_line (LoadConn *conn, const gchar *format, ...)
+{
+  gchar buf[256];
+  va_list args;
+  int len;
+  va_start (args, format);
+  len = vsnprintf (buf, sizeof (buf) - 1, format, args);
+  va_end (args);
+  len = MIN (len, (int) sizeof (buf) - 2);
+  buf[len++] = '\n';
+  g_string_append_len (conn->out, buf, len);
+}
+
+static void
+open_game (LoadConn *conn, guint slot, guint games_per_conn)
+{
+  memset (&conn->games[slot], 0, sizeof (LoadGame));
+  init_game_state (&conn->games[slot].state);
+  conn->opening[(conn->opening_head + conn->opening_len) %
+		games_per_conn] = slot;
+  conn->opening_len++;
+  send_line (conn, "new");
+}
+
+/* Play a random move, or resign a game that has gone on too long.
+   The game must not be over.  */
+static void
+send_move (Load *load, LoadConn *conn, LoadGame *game)
+{
+  Move moves[MAX_MOVES];
+  gchar text[RECORD_MOVE_TEXT_SIZE];
+  guint num_moves;
+  if (game->plies >= LOAD_MAX_PLIES)
+    {
+      send_line (conn, "leave %" G_GUINT64_FORMAT, game->id);
+      return;
+    }
+  num_moves = gen_moves (&game->state, moves);
+  record_format_move (&moves[corpus_random (&load->rng_state) %
+			     num_moves], text);
+  game->sent = g_get_monotonic_time ();
+  send_line (conn, "move %" G_GUINT64_FORMAT " %s", game->id, text);
+}
+
+static LoadGame *
+find_game (Load *load, LoadConn *conn, guint64 id)
+{
+  guint i;
+  for (i = 0; i < load->games_per_conn; i++)
+    {
+      if (conn->games[i].numbered && conn->games[i].id == id)
+	return &conn->games[i];
+    }
+  return NULL;
+}
+
+/* Open a connection that asks for a game and resets the connection
+   right away, so that the server's answer cannot be delivered.  */
+static bool
+quit_abruptly (Load *load, const gchar *address)
+{
+  struct linger linger = { 1, 0 };
+  int fd = net_socket (address, false);
+  if (fd < 0)
+    return false;
+  if (send (fd, "new\n", 4, MSG_NOSIGNAL) < 0)
+    {
+      close (fd);
+      return false;
+    }
+  /* Closing with a zero linger time sends a reset on TCP.  */
+  setsockopt (fd, SOL_SOCKET, SO_LINGER, &linger, sizeof (linger));
+  close (fd);
+  load->num_quitters++;
+  return true;
+}
+
+/* Handle one answer of the server.  */
+static void
+handle_answer (Load *load, LoadConn *conn, const gchar *line)
+{
+  gchar word[16], arg[16];
+  guint64 id;
+  LoadGame *game;
+
+  if (sscanf (line, "%15s %" G_GINT64_MODIFIER "u %15s", word, &id,
+	      arg) < 2 || !strcmp ("error", word))
+    {
+      if (load->num_errors++ < LOAD_MAX_SHOWN_ERRORS)
+	g_printerr ("morris-load: unexpected answer `%s'\n", line);
+      return;
+    }
+  if (!strcmp ("game", word))
+    {
+      guint slot;
+      if (conn->opening_len == 0)
+	return;
+      slot = conn->opening[conn->opening_head];
+      conn->opening_head = (conn->opening_head + 1) % load->games_per_conn;
+      conn->opening_len--;
+      conn->games[slot].id = id;
+      conn->games[slot].numbered = true;
+      send_line (conn, "join %" G_GUINT64_FORMAT, id);
+      return;
+    }
+  game = find_game (load, conn, id);
+  if (game == NULL)
+    return;
+  if (!strcmp ("start", word))
+    {
+      /* Both seats are ours, so there is one "start" for each.  */
+      if (++game->starts == 2 && load->running)
+	send_move (load, conn, game);
+    }
+  else if (!strcmp ("ok", word))
+    {
+      const gchar *p = arg;
+      Move move, moves[MAX_MOVES];
+      if (load->running)
+	{
+	  guint32 usec = (guint32) (g_get_monotonic_time () - game->sent);
+	  g_array_append_val (load->latencies, usec);
+	}
+      if (record_parse_move (&p, &move) <= 0 ||
+	  !play_move (&game->state, &move))
+	{
+	  if (load->num_errors++ < LOAD_MAX_SHOWN_ERRORS)
+	    g_printerr ("morris-load: bad move in `%s'\n", line);
+	  return;
+	}
+      game->plies++;
+      /* The server ends a game without legal moves by itself.  */
+      if (load->running && gen_moves (&game->state, moves) > 0)
+	send_move (load, conn, game);
+    }
+  else if (!strcmp ("over", word))
+    {
+      load->num_games++;
+      game->numbered = false;
+      if (load->running)
+	open_game (conn, game - conn->games, load->games_per_conn);
+    }
+}
+
+/* Read the answers that have arrived on a connection.  Returns false
+   if the server closed it.  */
+static bool
+read_answers (Load *load, LoadConn *conn, gchar *buf)
+{
+  ssize_t num_read;
+  gchar *p, *end, *newline;
+  do
+    num_read = recv (conn->fd, buf, LOAD_READ_SIZE, 0);
+  while (num_read < 0 && errno == EINTR);
+  if (num_read < 0)
+    return (errno == EAGAIN || errno == EWOULDBLOCK);
+  if (num_read == 0)
+    return false;
+  p = buf;
+  end = buf + num_read;
+  while ((newline = memchr (p, '\n', end - p)) != NULL)
+    {
+      *newline = '\0';
+      if (conn->in->len > 0)
+	{
+	  g_string_append (conn->in, p);
+	  handle_answer (load, conn, conn->in->str);
+	  g_string_truncate (conn->in, 0);
+	}
+      else
+	handle_answer (load, conn, p);
+      p = newline + 1;
+    }
+  g_string_append_len (conn->in, p, end - p);
+  return true;
+}
+
+/* Send as much of the queued lines as the socket accepts.  */
+static bool
+write_lines (LoadConn *conn)
+{
+  while (conn->out_pos < conn->out->len)
+    {
+      ssize_t written = send (conn->fd, conn->out->str + conn->out_pos,
+			      conn->out->len - conn->out_pos, MSG_NOSIGNAL);
+      if (written < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return (errno == EAGAIN || errno == EWOULDBLOCK);
+	}
+      conn->out_pos += written;
+    }
+  g_string_truncate (conn->out, 0);
+  conn->out_pos = 0;
+  return true;
+}
+
+static int
+compare_guint32 (const void *a, const void *b)
+{
+  guint32 x = *(const guint32 *) a, y = *(const guint32 *) b;
+  return (x > y) - (x < y);
+}
+
+static int
+run_load (const gchar *address, guint num_conns, guint games_per_conn,
+	  guint seconds, guint quitters, guint64 seed)
+{
+  Load load;
+  struct pollfd *pfds;
+  gchar *buf;
+  gint64 start, deadline, next_quit;
+  gdouble elapsed;
+  guint i, j;
+  int status = 0;
+
+  memset (&load, 0, sizeof (load));
+  load.num_conns = num_conns;
+  load.games_per_conn = games_per_conn;
+  load.rng_state = seed;
+  load.latencies = g_array_new (FALSE, FALSE, sizeof (guint32));
+  load.conns = g_new0 (LoadConn, num_conns);
+  pfds = g_new0 (struct pollfd, num_conns);
+  buf = g_malloc (LOAD_READ_SIZE);
+  signal (SIGPIPE, SIG_IGN);
+
+  for (i = 0; i < num_conns; i++)
+    {
+      LoadConn *conn = &load.conns[i];
+      conn->fd = net_socket (address, false);
+      if (conn->fd < 0)
+	{
+	  g_printerr ("morris-load: cannot connect to %s\n", address);
+	  num_conns = i;
+	  status = 1;
+	  break;
+	}
+      net_set_nonblocking (conn->fd);
+      conn->in = g_string_sized_new (256);
+      conn->out = g_string_sized_new (4096);
+      conn->games = g_new0 (LoadGame, games_per_conn);
+      conn->opening = g_new (guint, games_per_conn);
+    }
+
+  load.running = true;
+  for (i = 0; i < num_conns && status == 0; i++)
+    {
+      for (j = 0; j < games_per_conn; j++)
+	open_game (&load.conns[i], j, games_per_conn);
+    }
+  start = g_get_monotonic_time ();
+  deadline = start + (gint64) seconds * 1000000;
+  next_quit = (quitters > 0) ? start : deadline;
+  while (status == 0 && g_get_monotonic_time () < deadline)
+    {
+      gint64 wait;
+      while (status == 0 && g_get_monotonic_time () >= next_quit &&
+	     next_quit < deadline)
+	{
+	  if (!quit_abruptly (&load, address))
+	    {
+	      g_printerr ("morris-load: cannot connect to %s\n", address);
+	      status = 1;
+	    }
+	  next_quit += 1000000 / quitters;
+	}
+      wait = (MIN (deadline, next_quit) - g_get_monotonic_time () + 999)
+	/ 1000;
+      for (i = 0; i < num_conns; i++)
+	{
+	  pfds[i].fd = load.conns[i].fd;
+	  pfds[i].events = POLLIN;
+	  if (load.conns[i].out->len > load.conns[i].out_pos)
+	    pfds[i].events |= POLLOUT;
+	}
+      if (poll (pfds, num_conns, (int) MAX (wait, 0)) < 0 &&
+	  errno != EINTR)
+	status = 1;
+      for (i = 0; i < num_conns && status == 0; i++)
+	{
+	  if ((pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) &&
+	      !read_answers (&load, &load.conns[i], buf))
+	    {
+	      g_printerr ("morris-load: the server closed the "
+			  "connection\n");
+	      status = 1;
+	    }
+	}
+      for (i = 0; i < num_conns && status == 0; i++)
+	{
+	  if (!write_lines (&load.conns[i]))
+	    status = 1;
+	}
+    }
+  load.running = false;
+  elapsed = (g_get_monotonic_time () - start) / 1e6;
+
+  if (status == 0)
+    {
+      guint32 *sorted = (guint32 *) load.latencies->data;
+      guint count = load.latencies->len;
+      printf ("%u connections, %u games at a time, %.1f s\n",
+	      num_conns, num_conns * games_per_conn, elapsed);
+      printf ("%u moves (%.0f moves/s), %" G_GUINT64_FORMAT " games, %"
+	      G_GUINT64_FORMAT " errors\n", count, count / elapsed,
+	      load.num_games, load.num_errors);
+      if (load.num_quitters > 0)
+	printf ("%" G_GUINT64_FORMAT " connections reset\n",
+		load.num_quitters);
+      if (count > 0)
+	{
+	  qsort (sorted, count, sizeof (guint32), compare_guint32);
+	  printf ("latency (usec): p50 %u  p90 %u  p99 %u  max %u\n",
+		  sorted[stats_percentile_index (count, 50)],
+		  sorted[stats_percentile_index (count, 90)],
+		  sorted[stats_percentile_index (count, 99)],
+		  sorted[count-1]);
+	}
+      if (load.num_errors > 0)
+	status = 1;
+    }
+
+  for (i = 0; i < num_conns; i++)
+    {
+      close (load.conns[i].fd);
+      g_string_free (load.conns[i].in, TRUE);
+      g_string_free (load.conns[i].out, TRUE);
+      g_free (load.conns[i].games);
+      g_free (load.conns[i].opening);
+    }
+  g_free (load.conns);
+  g_free (pfds);
+  g_free (buf);
+  g_array_free (load.latencies, TRUE);
+  return status;
+}
+
+#else /* G_OS_WIN32 */
+
+static int
+run_load (const gchar *address, guint num_conns, guint games_per_conn,
+	  guint seconds, guint quitters, guint64 seed)
+{
+  g_printerr ("morris-load: not supported on Windows\n");
+  return 1;
+}
+
+#endif /* G_OS_WIN32 */
+
+static void
+print_usage (void)
+{
+  puts ("Usage: morris-load [OPTION]...\n"
+	"Measure the moves per second and the latency of morris-server.\n"
+	"\n"
+	"  -a, --address ADDR    the server address (default: "
+	"localhost:7700)\n"
+	"  -c, --connections N   connections to open (default: 100)\n"
+	"  -g, --games N         games played on every connection at once\n"
+	"                        (default: 20)\n"
+	"  -d, --duration SECS   length of the run (default: 10)\n"
+	"  -q, --quitters N      connections per second that ask for a game\n"
+	"                        and reset before the answer (default: 0)\n"
+	"  -s, --seed N          random seed for the moves\n"
+	"  -h, --help            display this help and exit");
+}
+
+int
+main (int argc, char *argv[])
+{
+  const gchar *address = "localhost:7700";
+  guint num_conns = 100, games_per_conn = 20, seconds = 10;
+  guint quitters = 0;
+  guint64 seed = CORPUS_DEFAULT_SEED;
+  int i;
+
+  for (i = 1; i < argc; i++)
+    {
+      const char *arg = argv[i];
+      const char *value = (i + 1 < argc) ? argv[i+1] : NULL;
+      if (!strcmp ("-h", arg) || !strcmp ("--help", arg))
+	{
+	  print_usage ();
+	  return 0;
+	}
+      else if (value == NULL)
+	{
+	  g_printerr ("morris-load: missing argument for `%s'\n", arg);
+	  return 1;
+	}
+      else if (!strcmp ("-a", arg) || !strcmp ("--address", arg))
+	address = argv[++i];
+      else if (!strcmp ("-c", arg) || !strcmp ("--connections", arg))
+	num_conns = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-g", arg) || !strcmp ("--games", arg))
+	games_per_conn = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-d", arg) || !strcmp ("--duration", arg))
+	seconds = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-q", arg) || !strcmp ("--quitters", arg))
+	quitters = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-s", arg) || !strcmp ("--seed", arg))
+	seed = g_ascii_strtoull (argv[++i], NULL, 0);
+      else
+	{
+	  g_printerr ("morris-load: unknown option `%s'\n", arg);
+	  print_usage ();
+	  return 1;
+	}
+    }
+  if (num_conns == 0 || games_per_conn == 0 || seconds == 0)
+    {
+      g_printerr ("morris-load: the counts must be positive\n");
+      return 1;
+    }
+  return run_load (address, num_conns, games_per_conn, seconds, quitters,
+		   seed);
+}
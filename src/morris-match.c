@@ -0,0 +1,630 @@
+/* Engine-versus-engine matches.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Engine-versus-engine matches.
+ *
+ * Tuning a computer player takes thousands of games to tell whether
+ * a change made it stronger.  This program plays two engines against
+ * each other on every processor, one game per thread at a time, and
+ * reports the difference in Elo rating between them.
+ *
+ * Every game starts from a short random opening, so that the
+ * deterministic parts of the engines do not play the same game over
+ * and over.  Each opening is played twice, with the engines trading
+ * colors, so that an unbalanced opening favors neither engine.
+ *
+ * The rules engine has no notion of a player who cannot move, so a
+ * game where the current player has no legal move is scored as a
+ * draw, just like a game that reaches the move limit.
+ *
+ * With the @c --sprt option, the match stops as soon as a sequential
+ * probability ratio test decides between two hypotheses about the
+ * Elo difference.  The test uses the normal approximation of the
+ * log-likelihood ratio that is common in engine testing:
+ *
+ * @code
+ * LLR = n * (s1 - s0) * (2 * s - s0 - s1) / (2 * var)
+ * @endcode
+ *
+ * where @c s is the mean score per game, @c var its variance, and
+ * @c s0 and @c s1 the expected scores under the two hypotheses.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#include "wpthread.h"
+#else
+#include <pthread.h>
+#endif
+
+#include "morris.h"
+#include "corpus.h"
+#include "record.h"
+#include "book.h"
+#include "eval.h"
+
+/**
+ * A computer player.
+ *
+ * The engine is given the legal moves of the current player, of
+ * which there is at least one, and returns the index of the move it
+ * picks.  Engines that evaluate positions are also given their
+ * evaluation weights.  Engines must be reentrant, as every thread
+ * plays its own game.
+ */
+struct MatchEngine_tag
+{
+  const char *name;
+  const char *description;
+  guint (*choose) (GameState *state, Move *moves, guint num_moves,
+		   const EvalWeights *weights, guint64 *rng_state);
+};
+typedef struct MatchEngine_tag MatchEngine;
+
+/** Results of a match from the point of view of the first engine.  */
+enum MatchResult_tag { RESULT_LOSS, RESULT_DRAW, RESULT_WIN };
+
+/** Parameters and shared state of a match.  */
+struct MatchContext_tag
+{
+  const MatchEngine *engines[2];
+  EvalWeights weights[2]; /**< Evaluation weights of each engine */
+  guint num_games;
+  guint opening_plies;
+  guint max_plies; /**< Plies after which a game is a draw */
+  guint64 seed;
+  /* Settings of the sequential probability ratio test.  */
+  bool sprt;
+  gdouble elo0, elo1;
+  gdouble alpha, beta;
+  /* Shared state while playing.  */
+  pthread_mutex_t lock;
+  guint next_game;
+  guint64 results[3]; /**< Counts of each ::MatchResult_tag */
+  gdouble llr;
+  bool stop;
+  Book *book; /**< Opening book that both engines use, or NULL */
+  RecordWriter *writer; /**< Where finished games are saved, or NULL */
+  bool write_error;
+};
+typedef struct MatchContext_tag MatchContext;
+
+/** A thread that plays games.  */
+struct MatchWorker_tag
+{
+  MatchContext *ctx;
+  pthread_t thread;
+};
+typedef struct MatchWorker_tag MatchWorker;
+
+/********************************************************************/
+/* Engines  */
+
+/* Pick a random move.  */
+static guint
+choose_random (GameState *state, Move *moves, guint num_moves,
+	       const EvalWeights *weights, guint64 *rng_state)
+{
+  return corpus_random (rng_state) % num_moves;
+}
+
+/* Pick a random move among those that form a mill, or failing that,
+   among those that stop the opponent from forming one.  */
+static guint
+choose_greedy (GameState *state, Move *moves, guint num_moves,
+	       const EvalWeights *weights, guint64 *rng_state)
+{
+  guint best_score = 0, num_best = 0, best = 0;
+  guint i;
+  for (i = 0; i < num_moves; i++)
+    {
+      GameState next = *state;
+      guint score = 0;
+      play_move (&next, &moves[i]);
+      if (next.remove_state)
+	score = 2;
+      else if (moves[i].type != MOVE_REMOVE)
+	{
+	  /* Would the opponent form a mill on the same place?  */
+	  next = *state;
+	  next.cur_player = get_opponent (state);
+	  set_board_pos (next.board, moves[i].dest, next.cur_player);
+	  if (is_mill_formed (&next, moves[i].dest))
+	    score = 1;
+	}
+      /* Choose uniformly among the best moves by reservoir
+	 sampling.  */
+      if (score > best_score || num_best == 0)
+	{
+	  best_score = score;
+	  num_best = 0;
+	}
+      if (score == best_score &&
+	  corpus_random (rng_state) % ++num_best == 0)
+	best = i;
+    }
+  return best;
+}
+
+/* Pick a random move among those that leave the best evaluated
+   position.  */
+static guint
+choose_eval (GameState *state, Move *moves, guint num_moves,
+	     const EvalWeights *weights, guint64 *rng_state)
+{
+  gint best_score = 0;
+  guint num_best = 0, best = 0;
+  guint i;
+  for (i = 0; i < num_moves; i++)
+    {
+      GameState next = *state;
+      gint score;
+      play_move (&next, &moves[i]);
+      score = eval_position (weights, &next);
+      /* The evaluation is for the player to move next.  */
+      if (next.cur_player != state->cur_player)
+	score = -score;
+      if (score > best_score || num_best == 0)
+	{
+	  best_score = score;
+	  num_best = 0;
+	}
+      if (score == best_score &&
+	  corpus_random (rng_state) % ++num_best == 0)
+	best = i;
+    }
+  return best;
+}
+
+static const MatchEngine engines[] = {
+  { "random", "plays a random legal move", choose_random },
+  { "greedy", "forms and blocks mills when it can", choose_greedy },
+  { "eval", "plays the move with the best static evaluation",
+    choose_eval },
+};
+
+static const MatchEngine *
+find_engine (const char *name)
+{
+  guint i;
+  for (i = 0; i < G_N_ELEMENTS (engines); i++)
+    {
+      if (!strcmp (engines[i].name, name))
+	return &engines[i];
+    }
+  return NULL;
+}
+
+/********************************************************************/
+/* Statistics  */
+
+/* Convert an expected score to an Elo difference.  */
+static gdouble
+score_to_elo (gdouble score)
+{
+  return -400 * log10 (1 / score - 1);
+}
+
+/* Convert an Elo difference to an expected score.  */
+static gdouble
+elo_to_score (gdouble elo)
+{
+  return 1 / (1 + pow (10, -elo / 400));
+}
+
+/* Get the mean score per game and its variance.  */
+static void
+score_stats (const guint64 *results, gdouble *mean, gdouble *var)
+{
+  gdouble n = results[RESULT_LOSS] + results[RESULT_DRAW] +
+    results[RESULT_WIN];
+  gdouble s;
+  if (n == 0)
+    {
+      *mean = 0.5;
+      *var = 0;
+      return;
+    }
+  s = (results[RESULT_WIN] + 0.5 * results[RESULT_DRAW]) / n;
+  *mean = s;
+  *var = (results[RESULT_WIN] * (1 - s) * (1 - s) +
+	  results[RESULT_DRAW] * (0.5 - s) * (0.5 - s) +
+	  results[RESULT_LOSS] * s * s) / n;
+}
+
+/* Compute the log-likelihood ratio of the SPRT.  The variance is
+   taken with one more win, draw and loss than were played, as a clean
+   sweep has no variance at all, and the test could then never stop
+   in the case where the result is the clearest.  */
+static gdouble
+sprt_llr (MatchContext *ctx)
+{
+  gdouble n = ctx->results[RESULT_LOSS] + ctx->results[RESULT_DRAW] +
+    ctx->results[RESULT_WIN];
+  guint64 padded[RESULT_WIN + 1];
+  gdouble s, var, padded_mean, s0, s1;
+  guint i;
+  if (n == 0)
+    return 0;
+  for (i = 0; i <= RESULT_WIN; i++)
+    padded[i] = ctx->results[i] + 1;
+  score_stats (ctx->results, &s, &var);
+  score_stats (padded, &padded_mean, &var);
+  s0 = elo_to_score (ctx->elo0);
+  s1 = elo_to_score (ctx->elo1);
+  return n * (s1 - s0) * (2 * s - s0 - s1) / (2 * var);
+}
+
+/********************************************************************/
+/* Playing games  */
+
+/**
+ * Play one game of the match.
+ *
+ * @param ctx the match
+ * @param game_num the number of the game, which selects the opening
+ * and which engine plays player 1
+ * @param moves receives the moves of the game, which must have room
+ * for the opening plus MatchContext::max_plies moves
+ * @param num_moves receives the number of moves
+ * @param winner receives the winner by the rules, or #EMPTY
+ * @return the result for the first engine
+ */
+static guint
+play_game (MatchContext *ctx, guint game_num, Move *moves,
+	   guint *num_moves, Player *winner)
+{
+  Move legal[MAX_MOVES];
+  GameState state;
+  guint64 rng_state;
+  /* The player that the first engine plays.  */
+  Player first = (game_num % 2 == 0) ? PLAYER1 : PLAYER2;
+  guint num_legal, plies = 0;
+
+  init_game_state (&state);
+  *num_moves = 0;
+
+  /* Both games of an opening get the same random opening.  */
+  rng_state = (ctx->seed ^ (game_num / 2 + 1) *
+	       G_GUINT64_CONSTANT (0x9e3779b97f4a7c15)) | 1;
+  while (plies < ctx->opening_plies &&
+	 (num_legal = gen_moves (&state, legal)) > 0)
+    {
+      Move *move = &legal[corpus_random (&rng_state) % num_legal];
+      play_move (&state, move);
+      moves[(*num_moves)++] = *move;
+      plies++;
+    }
+
+  /* The engines may use the generator for their own choices.  */
+  rng_state ^= (guint64) (game_num % 2 + 1) << 32;
+  plies = 0;
+  while (plies < ctx->max_plies &&
+	 (num_legal = gen_moves (&state, legal)) > 0)
+    {
+      const MatchEngine *engine;
+      Move book_move, *move;
+      guint which;
+      plies++;
+      /* Play from the opening book while the pieces are placed.  */
+      if (ctx->book != NULL && state.setup_rounds_left > 0 &&
+	  book_choose (ctx->book, &state, &rng_state, &book_move) &&
+	  play_move (&state, &book_move))
+	{
+	  moves[(*num_moves)++] = book_move;
+	  continue;
+	}
+      which = (state.cur_player == first) ? 0 : 1;
+      engine = ctx->engines[which];
+      move = &legal[engine->choose (&state, legal, num_legal,
+				    &ctx->weights[which], &rng_state)];
+      play_move (&state, move);
+      moves[(*num_moves)++] = *move;
+    }
+
+  *winner = (state.setup_rounds_left == 0) ? get_winner (&state) : EMPTY;
+  if (*winner == EMPTY)
+    return RESULT_DRAW;
+  return (*winner == first) ? RESULT_WIN : RESULT_LOSS;
+}
+
+static void *
+match_worker_main (void *data)
+{
+  MatchWorker *worker = (MatchWorker *) data;
+  MatchContext *ctx = worker->ctx;
+  Move *moves = g_new (Move, ctx->opening_plies + ctx->max_plies);
+
+  while (1)
+    {
+      guint game_num, num_moves, result;
+      Player winner;
+
+      pthread_mutex_lock (&ctx->lock);
+      if (ctx->stop || ctx->next_game >= ctx->num_games)
+	{
+	  pthread_mutex_unlock (&ctx->lock);
+	  break;
+	}
+      game_num = ctx->next_game++;
+      pthread_mutex_unlock (&ctx->lock);
+
+      result = play_game (ctx, game_num, moves, &num_moves, &winner);
+
+      pthread_mutex_lock (&ctx->lock);
+      /* Games that finish after the SPRT decided are not counted.  */
+      if (!ctx->stop)
+	{
+	  ctx->results[result]++;
+	  if (ctx->writer != NULL &&
+	      !record_writer_add (ctx->writer, winner, moves, num_moves))
+	    ctx->write_error = true;
+	  if (ctx->sprt)
+	    {
+	      ctx->llr = sprt_llr (ctx);
+	      if (ctx->llr <= log (ctx->beta / (1 - ctx->alpha)) ||
+		  ctx->llr >= log ((1 - ctx->beta) / ctx->alpha))
+		ctx->stop = true;
+	    }
+	}
+      pthread_mutex_unlock (&ctx->lock);
+    }
+
+  g_free (moves);
+  return NULL;
+}
+
+/********************************************************************/
+/* Reporting  */
+
+static void
+print_report (MatchContext *ctx)
+{
+  guint64 *results = ctx->results;
+  guint64 n = results[RESULT_LOSS] + results[RESULT_DRAW] +
+    results[RESULT_WIN];
+  gdouble s, var, margin;
+
+  printf ("%s vs %s: %" G_GUINT64_FORMAT " games, +%" G_GUINT64_FORMAT
+	  " =%" G_GUINT64_FORMAT " -%" G_GUINT64_FORMAT "\n",
+	  ctx->engines[0]->name, ctx->engines[1]->name, n,
+	  results[RESULT_WIN], results[RESULT_DRAW], results[RESULT_LOSS]);
+  if (n == 0)
+    return;
+  score_stats (results, &s, &var);
+  /* The 95% confidence interval of the mean score.  */
+  margin = 1.96 * sqrt (var / n);
+  printf ("score %.1f%%", 100 * s);
+  if (s <= 0 || s >= 1)
+    printf (", Elo difference %s\n", (s <= 0) ? "-inf" : "+inf");
+  else if (s - margin <= 0 || s + margin >= 1)
+    printf (", Elo difference %+.1f, error bars unbounded\n",
+	    score_to_elo (s));
+  else
+    printf (", Elo difference %+.1f +/- %.1f (95%%)\n", score_to_elo (s),
+	    (score_to_elo (s + margin) - score_to_elo (s - margin)) / 2);
+
+  if (ctx->sprt)
+    {
+      gdouble lower = log (ctx->beta / (1 - ctx->alpha));
+      gdouble upper = log ((1 - ctx->beta) / ctx->alpha);
+      printf ("SPRT elo0 %g elo1 %g: LLR %.2f (%.2f, %.2f), %s\n",
+	      ctx->elo0, ctx->elo1, ctx->llr, lower, upper,
+	      (ctx->llr >= upper) ? "H1 accepted" :
+	      (ctx->llr <= lower) ? "H0 accepted" : "inconclusive");
+    }
+}
+
+static void
+print_usage (void)
+{
+  guint i;
+  puts ("Usage: morris-match [OPTION]...\n"
+	"Play two engines against each other at " VARIANT_NAME ".\n"
+	"\n"
+	"  -1, --engine1 NAME    first engine (default: greedy)\n"
+	"  -2, --engine2 NAME    second engine (default: random)\n"
+	"      --weights1 FILE   evaluation weights of the first engine\n"
+	"      --weights2 FILE   evaluation weights of the second engine\n"
+	"  -n, --games N         number of games, rounded up to an even\n"
+	"                        number (default: 1000)\n"
+	"  -j, --threads N       number of threads\n"
+	"                        (default: one per processor)\n"
+	"  -p, --opening N       random plies before the engines take over\n"
+	"                        (default: 4)\n"
+	"  -m, --max-plies N     plies after which a game is a draw\n"
+	"                        (default: 500)\n"
+	"  -s, --seed N          random seed (default: a fixed seed)\n"
+	"      --sprt E0,E1      stop as soon as an SPRT decides between\n"
+	"                        Elo differences E0 and E1\n"
+	"      --alpha P         SPRT false positive rate (default: 0.05)\n"
+	"      --beta P          SPRT false negative rate (default: 0.05)\n"
+	"  -b, --book FILE       play from an opening book while the\n"
+	"                        pieces are placed\n"
+	"  -o, --output FILE     save the games as binary game records\n"
+	"  -h, --help            display this help and exit\n"
+	"\n"
+	"Engines:");
+  for (i = 0; i < G_N_ELEMENTS (engines); i++)
+    printf ("  %-20s  %s\n", engines[i].name, engines[i].description);
+}
+
+int
+main (int argc, char *argv[])
+{
+  MatchContext ctx;
+  MatchWorker *workers;
+  const char *output = NULL;
+  guint num_threads = g_get_num_processors ();
+  int i;
+
+  memset (&ctx, 0, sizeof (ctx));
+  ctx.engines[0] = find_engine ("greedy");
+  ctx.engines[1] = find_engine ("random");
+  ctx.weights[0] = eval_default_weights;
+  ctx.weights[1] = eval_default_weights;
+  ctx.num_games = 1000;
+  ctx.opening_plies = 4;
+  ctx.max_plies = 500;
+  ctx.seed = CORPUS_DEFAULT_SEED;
+  ctx.alpha = 0.05;
+  ctx.beta = 0.05;
+
+  for (i = 1; i < argc; i++)
+    {
+      const char *arg = argv[i];
+      const char *value = (i + 1 < argc) ? argv[i+1] : NULL;
+      if (!strcmp ("-h", arg) || !strcmp ("--help", arg))
+	{
+	  print_usage ();
+	  return 0;
+	}
+      else if (value == NULL)
+	{
+	  g_printerr ("morris-match: missing argument for `%s'\n", arg);
+	  return 1;
+	}
+      else if (!strcmp ("-1", arg) || !strcmp ("--engine1", arg) ||
+	       !strcmp ("-2", arg) || !strcmp ("--engine2", arg))
+	{
+	  guint which = (!strcmp ("-1", arg) ||
+			 !strcmp ("--engine1", arg)) ? 0 : 1;
+	  ctx.engines[which] = find_engine (argv[++i]);
+	  if (ctx.engines[which] == NULL)
+	    {
+	      g_printerr ("morris-match: unknown engine `%s'\n", argv[i]);
+	      return 1;
+	    }
+	}
+      else if (!strcmp ("--weights1", arg) || !strcmp ("--weights2", arg))
+	{
+	  guint which = !strcmp ("--weights1", arg) ? 0 : 1;
+	  if (!eval_load_weights (argv[++i], &ctx.weights[which]))
+	    {
+	      g_printerr ("morris-match: cannot read weights from %s\n",
+			  argv[i]);
+	      return 1;
+	    }
+	}
+      else if (!strcmp ("-n", arg) || !strcmp ("--games", arg))
+	ctx.num_games = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-j", arg) || !strcmp ("--threads", arg))
+	num_threads = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-p", arg) || !strcmp ("--opening", arg))
+	ctx.opening_plies = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-m", arg) || !strcmp ("--max-plies", arg))
+	ctx.max_plies = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-s", arg) || !strcmp ("--seed", arg))
+	ctx.seed = g_ascii_strtoull (argv[++i], NULL, 0);
+      else if (!strcmp ("--sprt", arg))
+	{
+	  if (sscanf (argv[++i], "%lf,%lf", &ctx.elo0, &ctx.elo1) != 2 ||
+	      ctx.elo0 >= ctx.elo1)
+	    {
+	      g_printerr ("morris-match: bad SPRT bounds `%s'\n", argv[i]);
+	      return 1;
+	    }
+	  ctx.sprt = true;
+	}
+      else if (!strcmp ("--alpha", arg))
+	ctx.alpha = g_ascii_strtod (argv[++i], NULL);
+      else if (!strcmp ("--beta", arg))
+	ctx.beta = g_ascii_strtod (argv[++i], NULL);
+      else if (!strcmp ("-b", arg) || !strcmp ("--book", arg))
+	{
+	  ctx.book = book_open (argv[++i]);
+	  if (ctx.book == NULL)
+	    {
+	      g_printerr ("morris-match: %s is not an opening book for %s\n",
+			  argv[i], VARIANT_NAME);
+	      return 1;
+	    }
+	}
+      else if (!strcmp ("-o", arg) || !strcmp ("--output", arg))
+	output = argv[++i];
+      else
+	{
+	  g_printerr ("morris-match: unknown option `%s'\n", arg);
+	  print_usage ();
+	  return 1;
+	}
+    }
+  if (num_threads == 0)
+    num_threads = 1;
+  if (ctx.max_plies == 0)
+    ctx.max_plies = 1;
+  ctx.num_games += ctx.num_games % 2;
+  if (ctx.alpha <= 0 || ctx.alpha >= 1 || ctx.beta <= 0 || ctx.beta >= 1)
+    {
+      g_printerr ("morris-match: SPRT error rates must be between "
+		  "0 and 1\n");
+      return 1;
+    }
+  if (output != NULL)
+    {
+      ctx.writer = record_writer_create (output);
+      if (ctx.writer == NULL)
+	{
+	  g_printerr ("morris-match: cannot create %s\n", output);
+	  return 1;
+	}
+    }
+
+  pthread_mutex_init (&ctx.lock, NULL);
+  workers = g_new (MatchWorker, num_threads);
+  for (i = 0; i < num_threads; i++)
+    {
+      workers[i].ctx = &ctx;
+      pthread_create (&workers[i].thread, NULL, match_worker_main,
+		      &workers[i]);
+    }
+  for (i = 0; i < num_threads; i++)
+    pthread_join (workers[i].thread, NULL);
+  g_free (workers);
+  pthread_mutex_destroy (&ctx.lock);
+
+  print_report (&ctx);
+  if (ctx.book != NULL)
+    book_free (ctx.book);
+  if (ctx.writer != NULL &&
+      (!record_writer_close (ctx.writer) || ctx.write_error))
+    {
+      g_printerr ("morris-match: error writing %s\n", output);
+      return 1;
+    }
+  return 0;
+}
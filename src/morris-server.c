@@ -0,0 +1,817 @@
+/* Game server for network play.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Game server for network play.
+ *
+ * morris-server hosts any number of games between clients that
+ * connect over TCP or a Unix socket.  It speaks a line protocol, with
+ * moves in the notation of textual game records (see
+ * record_parse_move()) and games named by the number that the server
+ * gave them:
+ *
+ * @code
+ * new               open a game as player 1, answered by "game ID"
+ * join ID           take the other seat, after which both players
+ *                   get "start ID P" with their player number P
+ * move ID M         play a move, answered by "ok ID M", while the
+ *                   opponent gets "moved ID M"
+ * state ID          answered by "state ID K" with the hexadecimal
+ *                   ::StateKey K of the game
+ * leave ID          resign the game
+ * @endcode
+ *
+ * When a game ends, both players get "over ID W", where W is the
+ * number of the winning player, or 0 for a draw when the player to
+ * move has no legal move.  Leaving a game, or closing the connection,
+ * hands the win to the opponent.  A command that cannot be carried
+ * out is answered by "error ID MESSAGE", with ID 0 if no game is
+ * involved.  A client may play any number of games at once, and may
+ * even take both seats of a game.
+ *
+ * The server runs a single thread around an epoll loop.  Every move is
+ * checked against the rules engine, but a game only stores its
+ * ::StateKey and the two clients that play it, so a session takes up
+ * 24 bytes of an array that grows as needed, and the sessions of
+ * finished games are reused.  Clients are read as data arrives and
+ * the answers to all of their commands are written together once every
+ * ready client has been served, which keeps the number of system calls
+ * per move low under load.  A client that does not read its answers
+ * is not read from until it has caught up.
+ *
+ * morris-load measures the server under load.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <glib.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#endif
+
+#include "morris.h"
+#include "net.h"
+#include "record.h"
+
+#ifdef HAVE_SYS_EPOLL_H
+
+/** The address that the server listens on by default.  */
+#define SERVER_DEFAULT_ADDRESS ":7700"
+/** The most epoll events that are handled at once.  */
+#define SERVER_MAX_EVENTS 256
+/** The longest command line that is accepted, without the newline.  */
+#define SERVER_MAX_LINE 255
+/** The size of the buffer that clients are read into.  */
+#define SERVER_READ_SIZE (64 * 1024)
+/** Unsent answers at which a client is no longer read from.  */
+#define SERVER_MAX_PENDING (256 * 1024)
+
+/**
+ * One game.  A seat holds the file descriptor of the client plus one,
+ * or 0 while it is open.
+ */
+struct Session_tag
+{
+  StateKey key; /**< The position of the game */
+  /** Tells apart the games that used the session, 0 when free.  */
+  guint32 serial;
+  guint32 seats[NUM_PLAYERS];
+  guint32 next_free; /**< Next free session plus one, if free */
+};
+typedef struct Session_tag Session;
+
+/** All sessions, with a free list threaded through the unused ones.  */
+struct SessionArena_tag
+{
+  Session *sessions;
+  guint32 size; /**< Number of sessions ever used */
+  guint32 capacity;
+  guint32 free_head; /**< First free session plus one, or 0 */
+  guint32 last_serial;
+  guint32 num_active;
+};
+typedef struct SessionArena_tag SessionArena;
+
+/** A connected client.  */
+struct Client_tag
+{
+  int fd;
+  guint32 events; /**< The epoll events that are being waited for */
+  bool dirty; /**< Whether the client is on the list to flush */
+  bool closed;
+  /** The start of a command whose newline has not yet arrived.  */
+  gchar line[SERVER_MAX_LINE];
+  guint line_len;
+  GString *out; /**< Answers that have not been sent */
+  gsize out_pos; /**< Bytes of Client::out that were already sent */
+  GArray *games; /**< Indexes of the sessions that the client plays */
+};
+typedef struct Client_tag Client;
+
+struct Server_tag
+{
+  int epoll_fd;
+  int listen_fd;
+  SessionArena arena;
+  Client **clients; /**< Clients by file descriptor */
+  guint clients_size;
+  /** Clients with answers to send or that were closed.  */
+  GPtrArray *dirty;
+  gchar *read_buf;
+  guint64 num_moves;
+  guint64 num_games;
+};
+typedef struct Server_tag Server;
+
+static volatile sig_atomic_t quit_requested = 0;
+
+/********************************************************************/
+/* Sessions  */
+
+/* Get a free session, growing the arena if there is none.  */
+static guint32
+arena_alloc (SessionArena *arena)
+{
+  guint32 index;
+  if (arena->free_head != 0)
+    {
+      index = arena->free_head - 1;
+      arena->free_head = arena->sessions[index].next_free;
+    }
+  else
+    {
+      if (arena->size == arena->capacity)
+	{
+	  arena->capacity = MAX (arena->capacity * 2, 1024);
+	  arena->sessions = g_renew (Session, arena->sessions,
+				     arena->capacity);
+	}
+      index = arena->size++;
+    }
+  memset (&arena->sessions[index], 0, sizeof (Session));
+  /* Serial 0 marks free sessions.  */
+  if (++arena->last_serial == 0)
+    arena->last_serial = 1;
+  arena->sessions[index].serial = arena->last_serial;
+  arena->num_active++;
+  return index;
+}
+
+static void
+arena_free (SessionArena *arena, guint32 index)
+{
+  Session *session = &arena->sessions[index];
+  session->serial = 0;
+  session->next_free = arena->free_head;
+  arena->free_head = index + 1;
+  arena->num_active--;
+}
+
+/* The number that clients know a session by.  */
+static guint64
+session_id (SessionArena *arena, guint32 index)
+{
+  return ((guint64) arena->sessions[index].serial << 32) | index;
+}
+
+/* Find a game by its number.  Returns false if it has ended.  */
+static bool
+arena_lookup (SessionArena *arena, guint64 id, guint32 *index)
+{
+  guint32 i = (guint32) id;
+  if (i >= arena->size || arena->sessions[i].serial == 0 ||
+      arena->sessions[i].serial != (guint32) (id >> 32))
+    return false;
+  *index = i;
+  return true;
+}
+
+/********************************************************************/
+/* Clients  */
+
+static void
+mark_dirty (Server *server, Client *client)
+{
+  if (!client->dirty)
+    {
+      client->dirty = true;
+      g_ptr_array_add (server->dirty, client);
+    }
+}
+
+/* Queue one line of output.  */
+static void
+send_line (Server *server, Client *client, const gchar *format, ...)
+{
+  gchar buf[SERVER_MAX_LINE + 2];
+  va_list args;
+  int len;
+  va_start (args, format);
+  len = vsnprintf (buf, sizeof (buf) - 1, format, args);
+  va_end (args);
+  len = MIN (len, (int) sizeof (buf) - 2);
+  buf[len++] = '\n';
+  g_string_append_len (client->out, buf, len);
+  mark_dirty (server, client);
+}
+
+static Client *
+seat_client (Server *server, guint32 seat)
+{
+  return (seat != 0) ? server->clients[seat-1] : NULL;
+}
+
+static void
+forget_game (Client *client, guint32 index)
+{
+  guint i;
+  for (i = 0; i < client->games->len; i++)
+    {
+      if (g_array_index (client->games, guint32, i) == index)
+	{
+	  g_array_index (client->games, guint32, i) =
+	    g_array_index (client->games, guint32, client->games->len - 1);
+	  g_array_set_size (client->games, client->games->len - 1);
+	  return;
+	}
+    }
+}
+
+/* Tell both players the result of a game and free its session.  */
+static void
+end_game (Server *server, guint32 index, Player winner)
+{
+  Session *session = &server->arena.sessions[index];
+  guint64 id = session_id (&server->arena, index);
+  Client *first = seat_client (server, session->seats[0]);
+  Client *second = seat_client (server, session->seats[1]);
+
+  if (first != NULL)
+    {
+      send_line (server, first, "over %" G_GUINT64_FORMAT " %u", id,
+		 (guint) winner);
+      forget_game (first, index);
+    }
+  if (second != NULL && second != first)
+    {
+      send_line (server, second, "over %" G_GUINT64_FORMAT " %u", id,
+		 (guint) winner);
+      forget_game (second, index);
+    }
+  arena_free (&server->arena, index);
+  server->num_games++;
+}
+
+/* Resign a game.  A client that holds both seats resigns for the
+   player to move, and a game that nobody has joined ends in a
+   draw.  */
+static void
+leave_game (Server *server, Client *client, guint32 index)
+{
+  Session *session = &server->arena.sessions[index];
+  guint32 seat = client->fd + 1;
+  GameState state;
+  Player loser;
+  if (session->seats[1] == 0)
+    {
+      /* Nobody has joined, so nobody wins.  */
+      end_game (server, index, EMPTY);
+      return;
+    }
+  unpack_state (session->key, &state);
+  if (session->seats[0] == seat && session->seats[1] == seat)
+    loser = state.cur_player;
+  else
+    loser = (session->seats[0] == seat) ? PLAYER1 : PLAYER2;
+  end_game (server, index, (loser == PLAYER1) ? PLAYER2 : PLAYER1);
+}
+
+static Client *
+client_new (Server *server, int fd)
+{
+  Client *client = g_new0 (Client, 1);
+  struct epoll_event event;
+
+  client->fd = fd;
+  client->out = g_string_sized_new (256);
+  client->games = g_array_new (FALSE, FALSE, sizeof (guint32));
+  client->events = EPOLLIN;
+  memset (&event, 0, sizeof (event));
+  event.events = client->events;
+  event.data.fd = fd;
+  if (epoll_ctl (server->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+      close (fd);
+      g_string_free (client->out, TRUE);
+      g_array_free (client->games, TRUE);
+      g_free (client);
+      return NULL;
+    }
+  if ((guint) fd >= server->clients_size)
+    {
+      guint old_size = server->clients_size;
+      server->clients_size = MAX ((guint) fd + 1, old_size * 2);
+      server->clients = g_renew (Client *, server->clients,
+				 server->clients_size);
+      memset (server->clients + old_size, 0,
+	      (server->clients_size - old_size) * sizeof (Client *));
+    }
+  server->clients[fd] = client;
+  return client;
+}
+
+/* Disconnect a client and resign its games.  The client itself is
+   freed when the dirty clients are flushed, since it may still be on
+   that list.  */
+static void
+client_close (Server *server, Client *client)
+{
+  if (client->closed)
+    return;
+  while (client->games->len > 0)
+    leave_game (server, client,
+		g_array_index (client->games, guint32, 0));
+  epoll_ctl (server->epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+  close (client->fd);
+  server->clients[client->fd] = NULL;
+  client->closed = true;
+  mark_dirty (server, client);
+}
+
+static void
+client_free (Client *client)
+{
+  g_string_free (client->out, TRUE);
+  g_array_free (client->games, TRUE);
+  g_free (client);
+}
+
+/* Wait for the events that the client needs next.  */
+static void
+client_update_events (Server *server, Client *client)
+{
+  gsize pending = client->out->len - client->out_pos;
+  guint32 events = (pending < SERVER_MAX_PENDING) ? EPOLLIN : 0;
+  if (pending > 0)
+    events |= EPOLLOUT;
+  if (events != client->events)
+    {
+      struct epoll_event event;
+      memset (&event, 0, sizeof (event));
+      event.events = events;
+      event.data.fd = client->fd;
+      epoll_ctl (server->epoll_fd, EPOLL_CTL_MOD, client->fd, &event);
+      client->events = events;
+    }
+}
+
+/* Send as much of the queued output as the socket accepts.  Returns
+   false if the connection is broken.  */
+static bool
+client_flush (Client *client)
+{
+  while (client->out_pos < client->out->len)
+    {
+      ssize_t written = send (client->fd, client->out->str + client->out_pos,
+			      client->out->len - client->out_pos,
+			      MSG_NOSIGNAL);
+      if (written < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return (errno == EAGAIN || errno == EWOULDBLOCK);
+	}
+      client->out_pos += written;
+    }
+  g_string_truncate (client->out, 0);
+  client->out_pos = 0;
+  return true;
+}
+
+/********************************************************************/
+/* Commands  */
+
+/* Find the game named by the next word of a command.  */
+static bool
+parse_game (Server *server, Client *client, gchar **cursor,
+	    guint32 *index)
+{
+  gchar *word = record_next_word (cursor), *end;
+  guint64 id;
+  if (word == NULL || !g_ascii_isdigit (*word))
+    {
+      send_line (server, client, "error 0 missing game number");
+      return false;
+    }
+  id = g_ascii_strtoull (word, &end, 10);
+  if (*end != '\0' || !arena_lookup (&server->arena, id, index))
+    {
+      send_line (server, client, "error %s no such game", word);
+      return false;
+    }
+  return true;
+}
+
+static void
+handle_join (Server *server, Client *client, guint32 index)
+{
+  Session *session = &server->arena.sessions[index];
+  guint64 id = session_id (&server->arena, index);
+  Client *first;
+  if (session->seats[1] != 0)
+    {
+      send_line (server, client,
+		 "error %" G_GUINT64_FORMAT " the game is full", id);
+      return;
+    }
+  session->seats[1] = client->fd + 1;
+  first = seat_client (server, session->seats[0]);
+  if (first != client)
+    g_array_append_val (client->games, index);
+  send_line (server, first, "start %" G_GUINT64_FORMAT " 1", id);
+  send_line (server, client, "start %" G_GUINT64_FORMAT " 2", id);
+}
+
+static void
+handle_move (Server *server, Client *client, guint32 index, gchar *args)
+{
+  Session *session = &server->arena.sessions[index];
+  guint64 id = session_id (&server->arena, index);
+  GameState state;
+  Move move, moves[MAX_MOVES];
+  const gchar *p = args;
+  gchar text[RECORD_MOVE_TEXT_SIZE];
+  Player mover;
+  Client *opponent;
+
+  if (session->seats[1] == 0)
+    {
+      send_line (server, client,
+		 "error %" G_GUINT64_FORMAT " the game has not started", id);
+      return;
+    }
+  unpack_state (session->key, &state);
+  mover = state.cur_player;
+  if (session->seats[mover-1] != (guint32) client->fd + 1)
+    {
+      send_line (server, client,
+		 "error %" G_GUINT64_FORMAT " not your turn", id);
+      return;
+    }
+  if (record_parse_move (&p, &move) <= 0)
+    {
+      send_line (server, client,
+		 "error %" G_GUINT64_FORMAT " cannot parse move", id);
+      return;
+    }
+  if (!record_play_move (&state, &move))
+    {
+      send_line (server, client,
+		 "error %" G_GUINT64_FORMAT " illegal move", id);
+      return;
+    }
+  session->key = pack_state (&state);
+  server->num_moves++;
+
+  record_format_move (&move, text);
+  send_line (server, client, "ok %" G_GUINT64_FORMAT " %s", id, text);
+  opponent = seat_client (server, session->seats[(mover == PLAYER1) ?
+						 1 : 0]);
+  if (opponent != client)
+    send_line (server, opponent, "moved %" G_GUINT64_FORMAT " %s", id,
+	       text);
+  if (gen_moves (&state, moves) == 0)
+    end_game (server, index, get_winner (&state));
+}
+
+/* Carry out one command line.  */
+static void
+handle_line (Server *server, Client *client, gchar *line)
+{
+  gchar *command = record_next_word (&line);
+  guint32 index;
+
+  if (command == NULL)
+    return;
+  if (!strcmp ("new", command))
+    {
+      GameState state;
+      index = arena_alloc (&server->arena);
+      init_game_state (&state);
+      server->arena.sessions[index].key = pack_state (&state);
+      server->arena.sessions[index].seats[0] = client->fd + 1;
+      g_array_append_val (client->games, index);
+      send_line (server, client, "game %" G_GUINT64_FORMAT,
+		 session_id (&server->arena, index));
+    }
+  else if (!strcmp ("join", command))
+    {
+      if (parse_game (server, client, &line, &index))
+	handle_join (server, client, index);
+    }
+  else if (!strcmp ("move", command))
+    {
+      if (parse_game (server, client, &line, &index))
+	handle_move (server, client, index, line);
+    }
+  else if (!strcmp ("state", command))
+    {
+      if (parse_game (server, client, &line, &index))
+	send_line (server, client, "state %" G_GUINT64_FORMAT " %014"
+		   G_GINT64_MODIFIER "x", session_id (&server->arena, index),
+		   server->arena.sessions[index].key);
+    }
+  else if (!strcmp ("leave", command))
+    {
+      if (parse_game (server, client, &line, &index))
+	{
+	  Session *session = &server->arena.sessions[index];
+	  if (session->seats[0] == (guint32) client->fd + 1 ||
+	      session->seats[1] == (guint32) client->fd + 1)
+	    leave_game (server, client, index);
+	  else
+	    send_line (server, client, "error %" G_GUINT64_FORMAT
+		       " not your game", session_id (&server->arena, index));
+	}
+    }
+  else
+    send_line (server, client, "error 0 unknown command");
+}
+
+/* Handle the commands in data read from a client.  Returns false if
+   the client sent a line that is too long.  */
+static bool
+client_feed (Server *server, Client *client, gchar *data, gsize len)
+{
+  gchar line[SERVER_MAX_LINE + 1];
+  while (len > 0)
+    {
+      gchar *newline = memchr (data, '\n', len);
+      gsize part = (newline != NULL) ? (gsize) (newline - data) : len;
+      if (client->line_len + part > SERVER_MAX_LINE)
+	return false;
+      if (newline == NULL)
+	{
+	  memcpy (client->line + client->line_len, data, part);
+	  client->line_len += part;
+	  return true;
+	}
+      memcpy (line, client->line, client->line_len);
+      memcpy (line + client->line_len, data, part);
+      line[client->line_len + part] = '\0';
+      client->line_len = 0;
+      handle_line (server, client, line);
+      data += part + 1;
+      len -= part + 1;
+    }
+  return true;
+}
+
+/* Read what has arrived from a client.  */
+static void
+client_read (Server *server, Client *client)
+{
+  ssize_t num_read;
+  do
+    num_read = recv (client->fd, server->read_buf, SERVER_READ_SIZE, 0);
+  while (num_read < 0 && errno == EINTR);
+  if (num_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    return;
+  if (num_read <= 0)
+    {
+      client_close (server, client);
+      return;
+    }
+  if (!client_feed (server, client, server->read_buf, num_read))
+    {
+      send_line (server, client, "error 0 line too long");
+      client_flush (client);
+      client_close (server, client);
+    }
+}
+
+/********************************************************************/
+/* Main loop  */
+
+static void
+accept_clients (Server *server)
+{
+  while (1)
+    {
+      int fd = accept (server->listen_fd, NULL, NULL);
+      if (fd < 0)
+	{
+	  if (errno == EINTR || errno == ECONNABORTED)
+	    continue;
+	  /* Usually EAGAIN, but running out of file descriptors also
+	     ends up here, and the clients can try again later.  */
+	  return;
+	}
+      net_set_nonblocking (fd);
+      client_new (server, fd);
+    }
+}
+
+/* Send the answers that were queued while handling the events.  A
+   client stays marked dirty until it has been handled, so closing it
+   here cannot put it on the list a second time.  Closing may queue
+   resignations for its opponents, which are appended and handled by
+   the same loop.  */
+static void
+flush_clients (Server *server)
+{
+  guint i;
+  for (i = 0; i < server->dirty->len; i++)
+    {
+      Client *client = g_ptr_array_index (server->dirty, i);
+      if (!client->closed && !client_flush (client))
+	client_close (server, client);
+      if (client->closed)
+	client_free (client);
+      else
+	{
+	  client->dirty = false;
+	  client_update_events (server, client);
+	}
+    }
+  g_ptr_array_set_size (server->dirty, 0);
+}
+
+static void
+handle_signal (int signum)
+{
+  quit_requested = 1;
+}
+
+static int
+run_server (const gchar *address)
+{
+  Server server;
+  struct epoll_event event, events[SERVER_MAX_EVENTS];
+  guint i;
+
+  memset (&server, 0, sizeof (server));
+  server.listen_fd = net_socket (address, true);
+  if (server.listen_fd < 0)
+    {
+      g_printerr ("morris-server: cannot listen on %s\n", address);
+      return 1;
+    }
+  net_set_nonblocking (server.listen_fd);
+  server.epoll_fd = epoll_create1 (0);
+  if (server.epoll_fd < 0)
+    {
+      g_printerr ("morris-server: cannot create an epoll instance\n");
+      close (server.listen_fd);
+      return 1;
+    }
+  memset (&event, 0, sizeof (event));
+  event.events = EPOLLIN;
+  event.data.fd = server.listen_fd;
+  epoll_ctl (server.epoll_fd, EPOLL_CTL_ADD, server.listen_fd, &event);
+  server.dirty = g_ptr_array_new ();
+  server.read_buf = g_malloc (SERVER_READ_SIZE);
+
+  signal (SIGPIPE, SIG_IGN);
+  signal (SIGINT, handle_signal);
+  signal (SIGTERM, handle_signal);
+  printf ("listening on %s\n", address);
+  fflush (stdout);
+  while (!quit_requested)
+    {
+      int num_events = epoll_wait (server.epoll_fd, events,
+				   SERVER_MAX_EVENTS, -1);
+      if (num_events < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  g_printerr ("morris-server: epoll_wait failed\n");
+	  break;
+	}
+      for (i = 0; i < (guint) num_events; i++)
+	{
+	  int fd = events[i].data.fd;
+	  Client *client;
+	  if (fd == server.listen_fd)
+	    {
+	      accept_clients (&server);
+	      continue;
+	    }
+	  client = server.clients[fd];
+	  if (client == NULL)
+	    continue;
+	  if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+	    client_read (&server, client);
+	  if (!client->closed && (events[i].events & EPOLLOUT))
+	    mark_dirty (&server, client);
+	}
+      flush_clients (&server);
+    }
+
+  printf ("%" G_GUINT64_FORMAT " games finished, %u open, %"
+	  G_GUINT64_FORMAT " moves\n", server.num_games,
+	  server.arena.num_active, server.num_moves);
+  for (i = 0; i < server.clients_size; i++)
+    {
+      if (server.clients[i] != NULL)
+	client_close (&server, server.clients[i]);
+    }
+  for (i = 0; i < server.dirty->len; i++)
+    client_free (g_ptr_array_index (server.dirty, i));
+  g_ptr_array_free (server.dirty, TRUE);
+  close (server.epoll_fd);
+  close (server.listen_fd);
+  if (strchr (address, '/') != NULL || strchr (address, ':') == NULL)
+    unlink (address);
+  g_free (server.clients);
+  g_free (server.arena.sessions);
+  g_free (server.read_buf);
+  return 0;
+}
+
+#else /* not HAVE_SYS_EPOLL_H */
+
+#define SERVER_DEFAULT_ADDRESS ":7700"
+
+static int
+run_server (const gchar *address)
+{
+  g_printerr ("morris-server: this system does not have epoll\n");
+  return 1;
+}
+
+#endif /* not HAVE_SYS_EPOLL_H */
+
+static void
+print_usage (void)
+{
+  puts ("Usage: morris-server [OPTION]...\n"
+	"Host games of " VARIANT_NAME " for clients on the network.\n"
+	"\n"
+	"  -a, --address ADDR    a \"host:port\" TCP address or a Unix "
+	"socket\n"
+	"                        path to listen on (default: "
+	SERVER_DEFAULT_ADDRESS ")\n"
+	"  -h, --help            display this help and exit");
+}
+
+int
+main (int argc, char *argv[])
+{
+  const gchar *address = SERVER_DEFAULT_ADDRESS;
+  int i;
+
+  for (i = 1; i < argc; i++)
+    {
+      const char *arg = argv[i];
+      if (!strcmp ("-h", arg) || !strcmp ("--help", arg))
+	{
+	  print_usage ();
+	  return 0;
+	}
+      else if ((!strcmp ("-a", arg) || !strcmp ("--address", arg)) &&
+	       i + 1 < argc)
+	address = argv[++i];
+      else
+	{
+	  g_printerr ("morris-server: unknown option `%s'\n", arg);
+	  print_usage ();
+	  return 1;
+	}
+    }
+  return run_server (address);
+}
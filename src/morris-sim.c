@@ -109,9 +109,10 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
  * game states that 11 Mens Morris may have.  The only way to find out
  * is to run the simulator.  I would hope that the total number of
  * game states is less than 4294967295 (2^32 - 1), but you never know.
- * As it turns out, I have not written the actual simulator code yet,
- * but rather have written how to write the simulator from a
- * conceptual level.
+ * In fact, the sorted heap of game states will not even fit in
+ * memory long before it reaches that size, so the simulator keeps it
+ * on disk instead.  See the section on external memory enumeration
+ * below.
  *
  * Finally, I have not mentioned all possible optimizations.  GPGPU
  * computation and networked computation could also be used as ways to
@@ -130,6 +131,37 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
  * existing game state.  However, the socket implementation involves
  * more data copying between the different process address spaces, so
  * it is not the best solution within a single computer.
+ *
+ * <h2>External memory enumeration</h2>
+ *
+ * The simulator that is actually implemented here enumerates the game
+ * states breadth first, one level of the game tree at a time, rather
+ * than recursively.  Every game state is packed into a ::StateKey, and
+ * each level is stored on disk as a sorted file of keys.  The sorted
+ * heap of all game states simulated so far is also a sorted file of
+ * keys, called the visited file.
+ *
+ * To simulate one level, worker threads (one per processor core, by
+ * default) pull blocks of keys off of the current level file, which
+ * acts as the job queue.  The keys are expanded directly, without
+ * unpacking them, by the kernels in kernels.c, which are chosen at
+ * startup to suit the processor.  Every child state that they
+ * generate is appended to a per-thread buffer.  When the buffer is full, it is
+ * sorted and written out as a run.  After the whole level has been
+ * read, the runs are merged together with the visited file in a
+ * single streaming pass.  Child states that are already in the
+ * visited file are dropped, and the remaining states become both the
+ * next level file and part of the next visited file.  All of this
+ * happens within a fixed memory budget, regardless of how many game
+ * states there are.  See frontier.c for the details.
+ *
+ * Since the level files are kept around and a progress file is
+ * atomically replaced after each level, an interrupted simulation
+ * can be continued with the @c --resume option.
+ *
+ * The same enumeration can also be spread over several processes,
+ * possibly on different computers, that each own a shard of the game
+ * states.  See netsim.c.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -137,9 +169,24 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
 #endif
 
 #include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <glib.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#include "wpthread.h"
+#else
+#include <pthread.h>
+#endif
 
 #include "morris.h"
+#include "frontier.h"
+#include "netsim.h"
+#include "stats.h"
+#include "kernels.h"
 
 typedef struct GameTreeNode_tag GameTreeNode;
 struct GameTreeNode_tag
@@ -148,7 +195,508 @@ struct GameTreeNode_tag
   GameTreeNode *links[BOARD_SIZE];
 };
 
-int main ()
+/** Number of keys that a worker takes off of the level at once.  */
+#define JOB_BLOCK_SIZE 4096
+/** Number of keys that are handed to the expansion kernel at once.  */
+#define EXPAND_CHUNK 16
+
+/** Parameters and shared state of one simulation run.  */
+struct SimContext_tag
+{
+  const gchar *work_dir;
+  guint num_threads;
+  gsize mem_budget;
+  /* Shared state while expanding one level.  */
+  KeyStream *level;
+  pthread_mutex_t level_lock;
+  RunSet *runs;
+  SimStats *stats; /**< Statistics collector, or NULL */
+  /** Where the summary of every level goes, which is standard error
+      when the JSON statistics take standard output.  */
+  FILE *report_fp;
+};
+typedef struct SimContext_tag SimContext;
+
+/** A worker thread that expands game states.  */
+struct SimWorker_tag
+{
+  pthread_t thread;
+  SimContext *ctx;
+  SimCounters *counters;
+  StateKey *children;
+  StateKey *scratch;
+  gsize capacity;
+  gsize num_children;
+  guint64 wins[NUM_PLAYERS];
+  bool failed;
+};
+typedef struct SimWorker_tag SimWorker;
+
+/* Count the pieces on the board of a packed game state.  Every
+   occupied position has exactly one of its two bits set.  */
+static inline guint
+count_pieces (StateKey key)
+{
+  return __builtin_popcountll (key & G_GUINT64_CONSTANT (0xffffffffffff));
+}
+
+/**
+ * Expand game states until the current level has been used up.
+ */
+static void *
+sim_worker_main (void *user_data)
+{
+  SimWorker *worker = (SimWorker *) user_data;
+  SimContext *ctx = worker->ctx;
+  SimCounters *counters = worker->counters;
+  StateKey block[JOB_BLOCK_SIZE];
+  guint64 num_chunks = 0;
+
+  while (!worker->failed)
+    {
+      gsize num_keys, i;
+
+      pthread_mutex_lock (&ctx->level_lock);
+      num_keys = key_stream_read (ctx->level, block, JOB_BLOCK_SIZE);
+      pthread_mutex_unlock (&ctx->level_lock);
+      if (num_keys == 0)
+	break;
+
+      for (i = 0; i < num_keys; i += EXPAND_CHUNK)
+	{
+	  gsize count = MIN (EXPAND_CHUNK, num_keys - i);
+	  guint num_children[EXPAND_CHUNK];
+	  bool sample;
+	  guint64 elapsed = 0;
+	  gsize j;
+
+	  if (worker->num_children + count * MAX_MOVES > worker->capacity)
+	    {
+	      if (!run_set_add (ctx->runs, worker->children, worker->scratch,
+				worker->num_children))
+		worker->failed = true;
+	      worker->num_children = 0;
+	    }
+
+	  sample = (num_chunks++ % STATS_SAMPLE_INTERVAL == 0);
+	  if (sample)
+	    elapsed = stats_clock_ns ();
+	  worker->num_children +=
+	    kernels->expand_keys (block + i, count,
+				  worker->children + worker->num_children,
+				  num_children);
+	  if (sample)
+	    elapsed = (stats_clock_ns () - elapsed) / count;
+
+	  for (j = 0; j < count; j++)
+	    {
+	      guint pieces = count_pieces (block[i+j]);
+	      counters->generated += num_children[j];
+	      counters->subspace_states[pieces]++;
+	      if (sample)
+		{
+		  counters->subspace_ns[pieces] += elapsed;
+		  counters->subspace_samples[pieces]++;
+		}
+	      if (num_children[j] == 0)
+		{
+		  GameState state;
+		  Player winner;
+		  unpack_state (block[i+j], &state);
+		  winner = get_winner (&state);
+		  if (state.setup_rounds_left == 0 && winner != EMPTY)
+		    worker->wins[winner-1]++;
+		}
+	    }
+	  counters->expanded += count;
+	}
+      counters->buffered = worker->num_children;
+    }
+
+  if (!worker->failed && worker->num_children > 0 &&
+      !run_set_add (ctx->runs, worker->children, worker->scratch,
+		    worker->num_children))
+    worker->failed = true;
+  worker->num_children = 0;
+  counters->buffered = 0;
+  return NULL;
+}
+
+/**
+ * Write the number of the last completed level to the progress file.
+ *
+ * The file is written under a temporary name and then renamed, so
+ * that there is always a valid progress file on disk.
+ */
+static bool
+write_progress (SimContext *ctx, guint level)
+{
+  gchar *path, *temp_path;
+  FILE *fp;
+  bool success;
+  path = g_build_filename (ctx->work_dir, "progress", NULL);
+  temp_path = g_build_filename (ctx->work_dir, "progress.tmp", NULL);
+  fp = fopen (temp_path, "w");
+  success = (fp != NULL);
+  if (success)
+    {
+      fprintf (fp, "%u\n", level);
+      success = (fclose (fp) == 0);
+    }
+#ifdef G_OS_WIN32
+  g_unlink (path); /* Windows cannot rename over an existing file.  */
+#endif
+  if (success)
+    success = (g_rename (temp_path, path) == 0);
+  g_free (path);
+  g_free (temp_path);
+  return success;
+}
+
+static bool
+read_progress (SimContext *ctx, guint *level)
+{
+  gchar *path;
+  FILE *fp;
+  bool success;
+  path = g_build_filename (ctx->work_dir, "progress", NULL);
+  fp = fopen (path, "r");
+  g_free (path);
+  if (fp == NULL)
+    return false;
+  success = (fscanf (fp, "%u", level) == 1);
+  fclose (fp);
+  return success;
+}
+
+/**
+ * Write the first level, which only holds the empty board.
+ */
+static bool
+write_first_level (SimContext *ctx)
+{
+  GameState state;
+  StateKey key;
+  const char *kinds[2] = { "level", "visited" };
+  guint i;
+
+  init_game_state (&state);
+  key = pack_state (&state);
+  for (i = 0; i < 2; i++)
+    {
+      gchar *path = frontier_path (ctx->work_dir, kinds[i], 0);
+      bool success = write_key_file (path, &key, 1);
+      g_free (path);
+      if (!success)
+	return false;
+    }
+  return write_progress (ctx, 0);
+}
+
+/**
+ * Expand one level and merge the children into the next level.
+ *
+ * @return the number of states in the next level, or -1 on error
+ */
+static gint64
+simulate_level (SimContext *ctx, guint level)
+{
+  SimWorker *workers;
+  SimCounters *counters;
+  gchar *cur_path, *visited_path, *next_path, *new_visited_path;
+  gchar *run_prefix, *run_name;
+  gsize capacity;
+  guint64 expanded = 0, wins[NUM_PLAYERS] = { 0, 0 };
+  bool failed = false;
+  gint64 num_new;
+  guint i;
+
+  cur_path = frontier_path (ctx->work_dir, "level", level);
+  visited_path = frontier_path (ctx->work_dir, "visited", level);
+  next_path = frontier_path (ctx->work_dir, "level", level + 1);
+  new_visited_path = frontier_path (ctx->work_dir, "visited", level + 1);
+  run_name = g_strdup_printf ("run-%04u", level);
+  run_prefix = g_build_filename (ctx->work_dir, run_name, NULL);
+  g_free (run_name);
+
+  ctx->level = key_stream_open (cur_path, ctx->mem_budget / 16);
+  if (ctx->level == NULL)
+    {
+      g_printerr ("morris-sim: cannot open %s\n", cur_path);
+      num_new = -1;
+      goto cleanup;
+    }
+  ctx->runs = run_set_new (run_prefix);
+
+  /* Half of the memory budget goes to the child buffers, and each
+     buffer needs an equally large scratch array for sorting.  */
+  capacity = ctx->mem_budget / 2 / ctx->num_threads / 2 / sizeof (StateKey);
+  if (capacity < EXPAND_CHUNK * MAX_MOVES)
+    capacity = EXPAND_CHUNK * MAX_MOVES;
+  workers = g_new0 (SimWorker, ctx->num_threads);
+  counters = g_new0 (SimCounters, ctx->num_threads);
+  if (ctx->stats != NULL)
+    sim_stats_begin_level (ctx->stats, level, key_file_count (cur_path),
+			   counters, ctx->num_threads);
+  for (i = 0; i < ctx->num_threads; i++)
+    {
+      workers[i].ctx = ctx;
+      workers[i].counters = &counters[i];
+      workers[i].capacity = capacity;
+      workers[i].children = g_new (StateKey, capacity);
+      workers[i].scratch = g_new (StateKey, capacity);
+      pthread_create (&workers[i].thread, NULL, sim_worker_main,
+		      &workers[i]);
+    }
+  for (i = 0; i < ctx->num_threads; i++)
+    {
+      guint j;
+      pthread_join (workers[i].thread, NULL);
+      expanded += counters[i].expanded;
+      for (j = 0; j < NUM_PLAYERS; j++)
+	wins[j] += workers[i].wins[j];
+      failed |= workers[i].failed;
+      g_free (workers[i].children);
+      g_free (workers[i].scratch);
+    }
+  g_free (workers);
+  key_stream_close (ctx->level);
+  ctx->level = NULL;
+
+  if (failed)
+    {
+      g_printerr ("morris-sim: error writing runs for level %u\n", level);
+      num_new = -1;
+    }
+  else
+    {
+      num_new = run_set_merge (ctx->runs, visited_path, next_path,
+			       new_visited_path, ctx->mem_budget);
+      if (num_new < 0)
+	g_printerr ("morris-sim: error merging level %u\n", level + 1);
+    }
+  run_set_free (ctx->runs);
+  ctx->runs = NULL;
+  if (ctx->stats != NULL)
+    sim_stats_end_level (ctx->stats, (num_new > 0) ? num_new : 0,
+			 (key_file_count (next_path) +
+			  key_file_count (new_visited_path)) *
+			 sizeof (StateKey));
+  g_free (counters);
+
+  if (num_new >= 0)
+    {
+      fprintf (ctx->report_fp, "level %u: %" G_GUINT64_FORMAT
+	       " states expanded, "
+	       "%" G_GUINT64_FORMAT " won by player 1, "
+	       "%" G_GUINT64_FORMAT " won by player 2, "
+	       "%" G_GINT64_FORMAT " new states\n",
+	       level, expanded, wins[0], wins[1], num_new);
+      fflush (ctx->report_fp);
+      if (write_progress (ctx, level + 1))
+	g_unlink (visited_path);
+      else
+	{
+	  g_printerr ("morris-sim: cannot write progress file\n");
+	  num_new = -1;
+	}
+    }
+
+ cleanup:
+  g_free (cur_path);
+  g_free (visited_path);
+  g_free (next_path);
+  g_free (new_visited_path);
+  g_free (run_prefix);
+  return num_new;
+}
+
+static void
+print_usage (void)
 {
-  return 0;
+  puts ("Usage: morris-sim [OPTION]...\n"
+	"Enumerate every reachable game state of " VARIANT_NAME ".\n"
+	"\n"
+	"  -d, --work-dir DIR    store level files in DIR (default: .)\n"
+	"  -m, --memory MB       memory budget in megabytes (default: 256)\n"
+	"  -j, --threads N       number of worker threads\n"
+	"                        (default: one per processor)\n"
+	"  -l, --max-level N     stop after simulating N levels\n"
+	"  -r, --resume          continue a previous simulation in DIR\n"
+	"      --stats N         report progress every N seconds, or never\n"
+	"                        if N is 0 (default: 10)\n"
+	"      --stats-json FILE append progress as JSON lines to FILE\n"
+	"                        (- for standard output, which moves the\n"
+	"                        level summaries to standard error)\n"
+	"  -h, --help            display this help and exit\n"
+	"\n"
+	"Distributed simulation:\n"
+	"  -s, --spawn N         run N local worker processes\n"
+	"      --listen ADDR     coordinate workers connecting to ADDR\n"
+	"      --workers N       number of workers to wait for\n"
+	"      --connect ADDR    run as a worker of the coordinator at ADDR\n"
+	"ADDR is either HOST:PORT or the path of a Unix socket.");
+}
+
+int
+main (int argc, char *argv[])
+{
+  SimContext ctx;
+  NetSimConfig net_config;
+  enum { MODE_LOCAL, MODE_SPAWN, MODE_COORDINATOR, MODE_WORKER } mode;
+  guint level = 0;
+  guint max_level = G_MAXUINT;
+  bool resume = false;
+  guint stats_interval = 10;
+  const gchar *stats_json = NULL;
+  FILE *json_fp = NULL;
+  gchar *visited_path;
+  int status = 0;
+  int i;
+
+  mode = MODE_LOCAL;
+  net_config.address = NULL;
+  net_config.num_workers = 0;
+
+  ctx.work_dir = ".";
+  ctx.num_threads = g_get_num_processors ();
+  ctx.mem_budget = 256;
+  ctx.level = NULL;
+  ctx.runs = NULL;
+  ctx.stats = NULL;
+  ctx.report_fp = stdout;
+  pthread_mutex_init (&ctx.level_lock, NULL);
+
+  for (i = 1; i < argc; i++)
+    {
+      const char *arg = argv[i];
+      const char *value = (i + 1 < argc) ? argv[i+1] : NULL;
+      if (!strcmp ("-h", arg) || !strcmp ("--help", arg))
+	{
+	  print_usage ();
+	  return 0;
+	}
+      else if (!strcmp ("-r", arg) || !strcmp ("--resume", arg))
+	resume = true;
+      else if (value == NULL)
+	{
+	  g_printerr ("morris-sim: missing argument for `%s'\n", arg);
+	  return 1;
+	}
+      else if (!strcmp ("-d", arg) || !strcmp ("--work-dir", arg))
+	ctx.work_dir = argv[++i];
+      else if (!strcmp ("-m", arg) || !strcmp ("--memory", arg))
+	ctx.mem_budget = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-j", arg) || !strcmp ("--threads", arg))
+	ctx.num_threads = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-l", arg) || !strcmp ("--max-level", arg))
+	max_level = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("--stats", arg))
+	stats_interval = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("--stats-json", arg))
+	stats_json = argv[++i];
+      else if (!strcmp ("-s", arg) || !strcmp ("--spawn", arg))
+	{
+	  mode = MODE_SPAWN;
+	  net_config.num_workers = strtoul (argv[++i], NULL, 10);
+	}
+      else if (!strcmp ("--listen", arg))
+	{
+	  if (mode != MODE_SPAWN)
+	    mode = MODE_COORDINATOR;
+	  net_config.address = argv[++i];
+	}
+      else if (!strcmp ("--workers", arg))
+	net_config.num_workers = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("--connect", arg))
+	{
+	  mode = MODE_WORKER;
+	  net_config.address = argv[++i];
+	}
+      else
+	{
+	  g_printerr ("morris-sim: unknown option `%s'\n", arg);
+	  print_usage ();
+	  return 1;
+	}
+    }
+  if (ctx.num_threads == 0)
+    ctx.num_threads = 1;
+  if (ctx.mem_budget == 0)
+    ctx.mem_budget = 1;
+  ctx.mem_budget *= 1024 * 1024;
+  kernels_init ();
+  if (stats_interval > 0)
+    g_printerr ("morris-sim: using the %s kernels\n", kernels->name);
+
+  if (mode != MODE_LOCAL)
+    {
+      net_config.work_dir = ctx.work_dir;
+      net_config.mem_budget = ctx.mem_budget;
+      net_config.max_level = max_level;
+      if (resume)
+	{
+	  g_printerr ("morris-sim: distributed simulations cannot be "
+		      "resumed\n");
+	  return 1;
+	}
+      if (mode != MODE_WORKER && net_config.num_workers == 0)
+	{
+	  g_printerr ("morris-sim: the number of workers must be given\n");
+	  return 1;
+	}
+      if (mode == MODE_SPAWN)
+	return netsim_spawn_main (&net_config);
+      else if (mode == MODE_COORDINATOR)
+	return netsim_coordinator_main (&net_config);
+      return netsim_worker_main (&net_config);
+    }
+
+  if (resume)
+    {
+      if (!read_progress (&ctx, &level))
+	{
+	  g_printerr ("morris-sim: no simulation to resume in %s\n",
+		      ctx.work_dir);
+	  return 1;
+	}
+    }
+  else if (!write_first_level (&ctx))
+    {
+      g_printerr ("morris-sim: cannot write to %s\n", ctx.work_dir);
+      return 1;
+    }
+
+  if (stats_json != NULL)
+    {
+      json_fp = strcmp (stats_json, "-") ? fopen (stats_json, "a") : stdout;
+      if (json_fp == NULL)
+	{
+	  g_printerr ("morris-sim: cannot open %s\n", stats_json);
+	  return 1;
+	}
+      if (json_fp == stdout)
+	ctx.report_fp = stderr;
+    }
+  visited_path = frontier_path (ctx.work_dir, "visited", level);
+  ctx.stats = sim_stats_new (stats_interval, json_fp,
+			     key_file_count (visited_path));
+  g_free (visited_path);
+
+  for (; level < max_level; level++)
+    {
+      gint64 num_new = simulate_level (&ctx, level);
+      if (num_new < 0)
+	{
+	  status = 1;
+	  break;
+	}
+      if (num_new == 0)
+	break;
+    }
+  sim_stats_free (ctx.stats);
+  if (json_fp != NULL && json_fp != stdout)
+    fclose (json_fp);
+  pthread_mutex_destroy (&ctx.level_lock);
+  return status;
 }
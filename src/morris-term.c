@@ -32,13 +32,25 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
 
 #include "core.h"
 #include <stdio.h>
+#include <string.h>
 #include <glib.h>
 
 #include "support.h"
 #include "morris.h"
+#include "record.h"
 
 char *player_symbols[NUM_PLAYERS+1] = { "  ", "P1", "P2" };
 
+/* The diagonal lines of the board, which 9 Mens Morris does not
+   have.  */
+#if HAVE_DIAGONALS
+#  define DIAG_BACK "\\"
+#  define DIAG_FWD "/"
+#else
+#  define DIAG_BACK " "
+#  define DIAG_FWD " "
+#endif
+
 /**
  * Print an ASCII-art formatted board to standard output.
  *
@@ -58,17 +70,17 @@ print_board (BoardQuad *board)
     }
   printf(
 	 " %s----------%s----------%s\n"
-	 " 0| \\        1|         /2|\n"
-	 "  |  %s------%s------%s/  |\n"
-	 "  |  3|\\     4|     /5|   |\n"
-	 "  |   | \\%s--%s--%s/  |   |\n"
+	 " 0| " DIAG_BACK "        1|         " DIAG_FWD "2|\n"
+	 "  |  %s------%s------%s" DIAG_FWD "  |\n"
+	 "  |  3|" DIAG_BACK "     4|     " DIAG_FWD "5|   |\n"
+	 "  |   | " DIAG_BACK "%s--%s--%s" DIAG_FWD "  |   |\n"
 	 "  |   |  6|   7  8|   |   |\n"
 	 " %s--%s--%s      %s--%s--%s\n"
 	 " 9| 10| 11|     12| 13| 14|\n"
-	 "  |   | /%s--%s--%s\\  |   |\n"
-	 "  |   |/15  16|  17 \\ |   |\n"
-	 "  | /%s------%s------%s\\  |\n"
-	 "  |/18      19|      20 \\ |\n"
+	 "  |   | " DIAG_FWD "%s--%s--%s" DIAG_BACK "  |   |\n"
+	 "  |   |" DIAG_FWD "15  16|  17 " DIAG_BACK " |   |\n"
+	 "  | " DIAG_FWD "%s------%s------%s" DIAG_BACK "  |\n"
+	 "  |" DIAG_FWD "18      19|      20 " DIAG_BACK " |\n"
 	 " %s----------%s----------%s\n"
 	 " 21          22          23\n",
 	 string_board[ 0], string_board[ 1], string_board[ 2],
@@ -212,6 +224,292 @@ game_loop (GameState *state)
   printf (_("Player %u won.\n"), (guint) get_winner (state));
 }
 
+/** Size of the standard output buffer in batch mode.  */
+#define BATCH_OUTPUT_BUFFER (64 * 1024)
+/** Size of the input buffer in batch mode.  */
+#define BATCH_INPUT_BUFFER (256 * 1024)
+
+/**
+ * The state of a batch run that validates game records.
+ */
+struct Batch_tag
+{
+  guint64 games; /**< Number of game records read */
+  guint64 invalid; /**< Records with a syntax error or an illegal move */
+  guint64 moves; /**< Number of legal moves played */
+  guint64 wins[NUM_PLAYERS]; /**< Games won by each player */
+  guint64 unfinished; /**< Valid records that end before a winner */
+  GArray *game_moves; /**< The legal moves of the current game */
+  RecordWriter *writer; /**< Where valid games are saved, or @a NULL */
+  bool write_error;
+};
+typedef struct Batch_tag Batch;
+
+/* Get the winner of a replayed game, or EMPTY if it is unfinished.  */
+static Player
+final_winner (GameState *state)
+{
+  return (state->setup_rounds_left == 0) ? get_winner (state) : EMPTY;
+}
+
+/* Print why the current game is invalid.  */
+static void
+reject_game (Batch *batch, const gchar *reason, const gchar *text,
+	     int length)
+{
+  batch->invalid++;
+  batch->moves += batch->game_moves->len;
+  printf (_("game %" G_GUINT64_FORMAT ": %s at move %u: %.*s\n"),
+	  batch->games, reason, batch->game_moves->len + 1, length, text);
+}
+
+/* Print the result of the current game and save it.  */
+static void
+accept_game (Batch *batch, Player winner)
+{
+  guint num_moves = batch->game_moves->len;
+  batch->moves += num_moves;
+  if (winner != EMPTY)
+    {
+      batch->wins[winner-1]++;
+      printf (_("game %" G_GUINT64_FORMAT ": player %u won "
+		"after %u moves\n"),
+	      batch->games, (guint) winner, num_moves);
+    }
+  else
+    {
+      batch->unfinished++;
+      printf (_("game %" G_GUINT64_FORMAT ": unfinished "
+		"after %u moves\n"),
+	      batch->games, num_moves);
+    }
+  if (batch->writer != NULL &&
+      !record_writer_add (batch->writer, winner,
+			  (Move *) batch->game_moves->data, num_moves))
+    batch->write_error = true;
+}
+
+/**
+ * Validate one textual game record and print its result.
+ *
+ * @param batch the batch run
+ * @param line the game record
+ */
+static void
+validate_text_record (Batch *batch, const gchar *line)
+{
+  GameState state;
+  Move move;
+  const gchar *p = line, *token, *end;
+  int status;
+
+  init_game_state (&state);
+  g_array_set_size (batch->game_moves, 0);
+  while (token = p, (status = record_parse_move (&p, &move)) > 0)
+    {
+      if (!record_play_move (&state, &move))
+	break;
+      g_array_append_val (batch->game_moves, move);
+    }
+  if (status == 0)
+    {
+      accept_game (batch, final_winner (&state));
+      return;
+    }
+
+  while (g_ascii_isspace (*token))
+    token++;
+  end = token;
+  while (*end != '\0' && !g_ascii_isspace (*end))
+    end++;
+  reject_game (batch, (status < 0) ? _("syntax error") : _("illegal move"),
+	       token, (int) (end - token));
+}
+
+/**
+ * Validate one binary game record and print its result.
+ *
+ * @param batch the batch run
+ * @param game the game record
+ */
+static void
+validate_binary_record (Batch *batch, RecordGame *game)
+{
+  GameState state;
+  Move move;
+  const guchar *p = game->data, *end = game->data + game->size;
+  gchar text[RECORD_MOVE_TEXT_SIZE];
+  Player winner;
+
+  init_game_state (&state);
+  g_array_set_size (batch->game_moves, 0);
+  while (p < end)
+    {
+      if (!record_decode_move (&p, end, &move))
+	{
+	  reject_game (batch, _("corrupt move"), "", 0);
+	  return;
+	}
+      if (!record_play_move (&state, &move))
+	{
+	  record_format_move (&move, text);
+	  reject_game (batch, _("illegal move"), text, strlen (text));
+	  return;
+	}
+      g_array_append_val (batch->game_moves, move);
+    }
+
+  winner = final_winner (&state);
+  if (winner != game->winner)
+    {
+      batch->invalid++;
+      batch->moves += batch->game_moves->len;
+      printf (_("game %" G_GUINT64_FORMAT ": the recorded winner "
+		"is wrong\n"), batch->games);
+      return;
+    }
+  accept_game (batch, winner);
+}
+
+/* Validate every textual game record in a stream.  */
+static bool
+validate_text (Batch *batch, FILE *fp)
+{
+  GString *line = g_string_sized_new (1024);
+  bool success;
+  while (record_read_line (fp, line))
+    {
+      const gchar *p = line->str;
+      while (g_ascii_isspace (*p))
+	p++;
+      if (*p == '\0' || *p == '#')
+	continue;
+      batch->games++;
+      validate_text_record (batch, p);
+    }
+  g_string_free (line, TRUE);
+  success = !ferror (fp);
+  if (!success)
+    g_printerr ("morris-ui: error reading game records\n");
+  return success;
+}
+
+/* Validate every game in a binary game record stream.  */
+static bool
+validate_binary (Batch *batch, FILE *fp)
+{
+  RecordReader *reader;
+  RecordGame game;
+  int status;
+  reader = record_reader_new (fp);
+  if (reader == NULL)
+    {
+      g_printerr ("morris-ui: not a game record file for %s\n",
+		  VARIANT_NAME);
+      return false;
+    }
+  while ((status = record_reader_next (reader, &game)) > 0)
+    {
+      batch->games++;
+      validate_binary_record (batch, &game);
+    }
+  if (!record_reader_close (reader) || status < 0)
+    {
+      g_printerr ("morris-ui: error reading game records\n");
+      return false;
+    }
+  return true;
+}
+
+/**
+ * Validate a stream of game records without user interaction.
+ *
+ * The records are either textual, one game per line, or in the
+ * binary format of record.c, which is recognized by its header.  One
+ * result line is printed per game, followed by totals.  Nothing else
+ * is printed, and standard output is fully buffered, so that large
+ * archives of games can be checked quickly.
+ *
+ * @param path the file to read game records from, or @a NULL or "-"
+ * for standard input
+ * @param output the binary game record file to save the valid games
+ * to, or @a NULL to not save them
+ * @return the exit status: 0 if every record was valid, 1 if some
+ * were not, or 2 if the records could not be read or saved
+ */
+int
+batch_main (const char *path, const char *output)
+{
+  static gchar in_buffer[BATCH_INPUT_BUFFER];
+  static gchar out_buffer[BATCH_OUTPUT_BUFFER];
+  FILE *fp;
+  Batch batch;
+  gint64 start;
+  gdouble seconds;
+  bool read_ok;
+  int c;
+
+  memset (&batch, 0, sizeof (batch));
+  if (path == NULL || !strcmp (path, "-"))
+    fp = stdin;
+  else
+    {
+      fp = fopen (path, "rb");
+      if (fp == NULL)
+	{
+	  g_printerr ("morris-ui: cannot open %s\n", path);
+	  return 2;
+	}
+    }
+  if (output != NULL)
+    {
+      batch.writer = record_writer_create (output);
+      if (batch.writer == NULL)
+	{
+	  g_printerr ("morris-ui: cannot create %s\n", output);
+	  if (fp != stdin)
+	    fclose (fp);
+	  return 2;
+	}
+    }
+  setvbuf (fp, in_buffer, _IOFBF, sizeof (in_buffer));
+  setvbuf (stdout, out_buffer, _IOFBF, sizeof (out_buffer));
+  batch.game_moves = g_array_new (FALSE, FALSE, sizeof (Move));
+
+  start = g_get_monotonic_time ();
+  c = getc (fp);
+  if (c != EOF)
+    ungetc (c, fp);
+  if (c == RECORD_MAGIC[0])
+    read_ok = validate_binary (&batch, fp);
+  else
+    read_ok = validate_text (&batch, fp);
+  seconds = (g_get_monotonic_time () - start) / 1e6;
+  if (fp != stdin)
+    fclose (fp);
+  g_array_free (batch.game_moves, TRUE);
+
+  printf (_("%" G_GUINT64_FORMAT " games, %" G_GUINT64_FORMAT
+	    " moves, %" G_GUINT64_FORMAT " invalid\n"),
+	  batch.games, batch.moves, batch.invalid);
+  printf (_("player 1 won %" G_GUINT64_FORMAT ", player 2 won %"
+	    G_GUINT64_FORMAT ", %" G_GUINT64_FORMAT " unfinished\n"),
+	  batch.wins[0], batch.wins[1], batch.unfinished);
+  printf (_("%.3f s, %.0f games/s\n"), seconds,
+	  (seconds > 0) ? batch.games / seconds : 0.0);
+  fflush (stdout);
+
+  if (batch.writer != NULL &&
+      (!record_writer_close (batch.writer) || batch.write_error))
+    {
+      g_printerr ("morris-ui: error writing %s\n", output);
+      return 2;
+    }
+  if (!read_ok)
+    return 2;
+  return (batch.invalid > 0) ? 1 : 0;
+}
+
 /**
  * main() function hand-off for the line-based terminal user
  * interface.
@@ -224,8 +522,30 @@ term_main (int argc, char *argv[])
 {
   GameState state;
   guint choice = 1;
+  if (argc >= 2 && !strcmp ("--batch", argv[1]))
+    {
+      const char *input = NULL, *output = NULL;
+      int i;
+      for (i = 2; i < argc; i++)
+	{
+	  if (!strcmp ("-o", argv[i]))
+	    {
+	      if (i + 1 >= argc)
+		{
+		  g_printerr ("morris-ui: missing argument for `-o'\n"
+			      "Usage: morris-ui --batch [-o RECORDS] "
+			      "[FILE]\n");
+		  return 2;
+		}
+	      output = argv[++i];
+	    }
+	  else
+	    input = argv[i];
+	}
+      return batch_main (input, output);
+    }
   init_game_state (&state);
-  puts (_("Welcome to the 11 Mens Morris simulator."));
+  printf (_("Welcome to the %s simulator.\n"), VARIANT_NAME);
   do
     {
       int fields_read;
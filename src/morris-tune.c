@@ -0,0 +1,682 @@
+/* Tune evaluation weights from labeled positions.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Tune evaluation weights from labeled positions.
+ *
+ * This is the method that is known among chess programmers as Texel
+ * tuning.  Every position is labeled with the result of the game for
+ * the player to move: 1 for a win, 1/2 for a draw and 0 for a loss.
+ * The evaluation is turned into an expected result with a logistic
+ * function,
+ *
+ * @code
+ * p = 1 / (1 + exp (-K * score))
+ * @endcode
+ *
+ * and the weights are tuned to minimize the mean squared difference
+ * between the labels and the expected results.  K is fitted to the
+ * initial weights on the first chunk of positions, unless it is given.
+ *
+ * The positions come from binary game records, where every position
+ * that a move was played from is labeled with the winner of the game,
+ * or from labeled position files.  A labeled position file has an
+ * eight byte header made of #POSITIONS_MAGIC, #POSITIONS_VERSION,
+ * #MORRIS_VARIANT and a zero byte for each of the flags and a reserved
+ * field.  Then there is one little-endian 64-bit word for each
+ * position, which holds a ::StateKey in its low bits and a
+ * ::GameValue_tag in its top byte, so that a solver can label
+ * positions with their proven values.  The @c --extract option writes
+ * such a file from game records, which saves replaying the games in
+ * every epoch.
+ *
+ * The positions are never all in memory.  They are read in chunks,
+ * and each chunk is split between the threads, which extract the
+ * features of their share with eval_extract() and sum up the gradient
+ * of the error.  The weights are then updated once per chunk with
+ * Adam, which scales the step of each weight to the size of its
+ * gradient, so that rare features such as EVAL_REMOVE are tuned as
+ * quickly as common ones.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#include "wpthread.h"
+#else
+#include <pthread.h>
+#endif
+
+#include "morris.h"
+#include "record.h"
+#include "eval.h"
+#include "valarray.h"
+
+/** The first bytes of a labeled position file.  */
+#define POSITIONS_MAGIC "MMLP"
+/** The current version of the labeled position format.  */
+#define POSITIONS_VERSION 1
+/** The size of the header at the start of a labeled position file.  */
+#define POSITIONS_HEADER_SIZE 8
+/** The bits of a labeled position that hold the ::StateKey.  */
+#define POSITIONS_KEY_MASK G_GUINT64_CONSTANT (0x00ffffffffffffff)
+
+/** Positions whose features are extracted at a time by a thread.  */
+#define TUNE_BATCH 1024
+/* Parameters of Adam.  */
+#define ADAM_BETA1 0.9
+#define ADAM_BETA2 0.999
+#define ADAM_EPSILON 1e-8
+
+/**
+ * A stream of labeled positions that are read from a list of files.
+ * A game that is only partly replayed when a chunk is full is resumed
+ * by the next read.
+ */
+struct PositionSource_tag
+{
+  char **paths;
+  guint num_paths;
+  guint next_path;
+  FILE *fp; /**< The file being read */
+  RecordReader *reader; /**< Its reader if it holds game records */
+  RecordGame game; /**< The game being replayed */
+  const guchar *cursor; /**< The next move of PositionSource::game */
+  GameState state;
+  bool in_game;
+  bool at_end; /**< Whether the whole file has been read */
+  bool error;
+};
+typedef struct PositionSource_tag PositionSource;
+
+/** The share of a chunk of positions that one thread works on.  */
+struct TuneWorker_tag
+{
+  const StateKey *keys;
+  const guchar *labels;
+  gsize count;
+  gdouble weights[EVAL_NUM_FEATURES];
+  gdouble scale; /**< K in the logistic function */
+  bool want_gradient;
+  /* Results.  */
+  gdouble error; /**< Sum of the squared errors */
+  gdouble gradient[EVAL_NUM_FEATURES];
+  pthread_t thread;
+};
+typedef struct TuneWorker_tag TuneWorker;
+
+/** Settings and state of the tuner.  */
+struct Tuner_tag
+{
+  guint num_threads;
+  TuneWorker *workers;
+  gdouble weights[EVAL_NUM_FEATURES];
+  gdouble scale;
+  gdouble rate; /**< The learning rate, in weight units per step */
+  /* The moment estimates of Adam.  */
+  gdouble m[EVAL_NUM_FEATURES], v[EVAL_NUM_FEATURES];
+  guint64 num_steps;
+};
+typedef struct Tuner_tag Tuner;
+
+/********************************************************************/
+/* Reading positions  */
+
+static void
+source_init (PositionSource *source, char **paths, guint num_paths)
+{
+  memset (source, 0, sizeof (PositionSource));
+  source->paths = paths;
+  source->num_paths = num_paths;
+}
+
+static void
+source_close_file (PositionSource *source)
+{
+  if (source->reader != NULL && !record_reader_close (source->reader))
+    source->error = true;
+  if (source->fp != NULL)
+    fclose (source->fp);
+  source->reader = NULL;
+  source->fp = NULL;
+  source->in_game = false;
+  source->at_end = false;
+}
+
+/* Open the next input file and tell its format from its header.
+   Returns false when there are no more files or on an error.  */
+static bool
+source_open_next (PositionSource *source)
+{
+  const char *path;
+  guchar header[POSITIONS_HEADER_SIZE];
+
+  if (source->error || source->next_path >= source->num_paths)
+    return false;
+  path = source->paths[source->next_path++];
+  source->fp = fopen (path, "rb");
+  if (source->fp == NULL)
+    {
+      g_printerr ("morris-tune: cannot open %s\n", path);
+      source->error = true;
+      return false;
+    }
+  if (fread (header, POSITIONS_HEADER_SIZE, 1, source->fp) == 1 &&
+      memcmp (header, POSITIONS_MAGIC, 4) == 0)
+    {
+      if (header[4] == POSITIONS_VERSION && header[5] == MORRIS_VARIANT)
+	return true;
+    }
+  else
+    {
+      rewind (source->fp);
+      source->reader = record_reader_new (source->fp);
+      if (source->reader != NULL)
+	return true;
+    }
+  g_printerr ("morris-tune: %s holds neither game records nor labeled "
+	      "positions for %s\n", path, VARIANT_NAME);
+  source_close_file (source);
+  source->error = true;
+  return false;
+}
+
+/* Replay game records until the chunk is full.  */
+static gsize
+read_record_positions (PositionSource *source, StateKey *keys,
+		       guchar *labels, gsize max_count)
+{
+  gsize count = 0;
+  while (count < max_count)
+    {
+      const guchar *end;
+      Move move;
+      if (!source->in_game)
+	{
+	  int status = record_reader_next (source->reader, &source->game);
+	  if (status <= 0)
+	    {
+	      source->error |= (status < 0);
+	      source->at_end = true;
+	      break;
+	    }
+	  source->cursor = source->game.data;
+	  init_game_state (&source->state);
+	  source->in_game = true;
+	}
+      end = source->game.data + source->game.size;
+      while (count < max_count && source->cursor < end)
+	{
+	  GameState *state = &source->state;
+	  if (!record_decode_move (&source->cursor, end, &move))
+	    {
+	      source->error = true;
+	      return count;
+	    }
+	  keys[count] = pack_state (state);
+	  if (source->game.winner == EMPTY)
+	    labels[count] = VALUE_DRAW;
+	  else
+	    labels[count] = (source->game.winner == state->cur_player) ?
+	      VALUE_WIN : VALUE_LOSS;
+	  count++;
+	  if (!record_play_move (state, &move))
+	    {
+	      source->error = true;
+	      return count;
+	    }
+	}
+      if (source->cursor == end)
+	source->in_game = false;
+    }
+  return count;
+}
+
+/* Read labeled positions until the chunk is full.  */
+static gsize
+read_labeled_positions (PositionSource *source, StateKey *keys,
+			guchar *labels, gsize max_count)
+{
+  gsize num_bytes, count, i, j = 0;
+  num_bytes = fread (keys, 1, max_count * sizeof (StateKey), source->fp);
+  count = num_bytes / sizeof (StateKey);
+  if (count < max_count)
+    {
+      /* A position that is cut off means that the file is, too.  */
+      source->error |= ferror (source->fp) ||
+	num_bytes % sizeof (StateKey) != 0;
+      source->at_end = true;
+    }
+  for (i = 0; i < count; i++)
+    {
+      guint64 word = GUINT64_FROM_LE (keys[i]);
+      guchar label = word >> 56;
+      /* Positions whose value is unknown teach nothing.  */
+      if (label == VALUE_UNKNOWN || label > VALUE_DRAW)
+	continue;
+      keys[j] = word & POSITIONS_KEY_MASK;
+      labels[j++] = label;
+    }
+  return j;
+}
+
+/**
+ * Read the next chunk of labeled positions.
+ *
+ * @param source the position stream
+ * @param keys receives the positions
+ * @param labels receives a ::GameValue_tag for each position
+ * @param max_count the size of the chunk
+ * @return the number of positions read, which is zero only at the end
+ * of the last file or after an error
+ */
+static gsize
+source_read (PositionSource *source, StateKey *keys, guchar *labels,
+	     gsize max_count)
+{
+  gsize count = 0;
+  while (count < max_count && !source->error)
+    {
+      gsize num_read;
+      if (source->fp == NULL && !source_open_next (source))
+	break;
+      if (source->reader != NULL)
+	num_read = read_record_positions (source, &keys[count],
+					  &labels[count], max_count - count);
+      else
+	num_read = read_labeled_positions (source, &keys[count],
+					   &labels[count], max_count - count);
+      count += num_read;
+      if (source->error)
+	g_printerr ("morris-tune: %s is corrupt\n",
+		    source->paths[source->next_path-1]);
+      else if (source->at_end)
+	source_close_file (source);
+    }
+  return source->error ? 0 : count;
+}
+
+/********************************************************************/
+/* Tuning  */
+
+static void *
+tune_worker_main (void *data)
+{
+  TuneWorker *worker = (TuneWorker *) data;
+  gint16 features[TUNE_BATCH*EVAL_NUM_FEATURES];
+  gsize i, j;
+  guint k;
+
+  worker->error = 0;
+  memset (worker->gradient, 0, sizeof (worker->gradient));
+  for (i = 0; i < worker->count; i += TUNE_BATCH)
+    {
+      gsize n = MIN (worker->count - i, TUNE_BATCH);
+      eval_extract (&worker->keys[i], n, features);
+      for (j = 0; j < n; j++)
+	{
+	  const gint16 *f = &features[j*EVAL_NUM_FEATURES];
+	  guchar label = worker->labels[i+j];
+	  gdouble target, score = 0, p, diff;
+	  target = (label == VALUE_WIN) ? 1 : (label == VALUE_DRAW) ? 0.5 : 0;
+	  for (k = 0; k < EVAL_NUM_FEATURES; k++)
+	    score += worker->weights[k] * f[k];
+	  p = 1 / (1 + exp (-worker->scale * score));
+	  diff = p - target;
+	  worker->error += diff * diff;
+	  if (worker->want_gradient)
+	    {
+	      /* The derivative of the squared error by the score.  */
+	      gdouble d = 2 * diff * p * (1 - p) * worker->scale;
+	      for (k = 0; k < EVAL_NUM_FEATURES; k++)
+		worker->gradient[k] += d * f[k];
+	    }
+	}
+    }
+  return NULL;
+}
+
+/**
+ * Compute the error of a chunk of positions, and its gradient by the
+ * weights if asked to, on all threads.
+ *
+ * @return the sum of the squared errors of the chunk
+ */
+static gdouble
+tune_chunk (Tuner *tuner, const StateKey *keys, const guchar *labels,
+	    gsize count, gdouble scale, gdouble *gradient)
+{
+  gsize share = (count + tuner->num_threads - 1) / tuner->num_threads;
+  gdouble error = 0;
+  guint i, k;
+
+  if (gradient != NULL)
+    memset (gradient, 0, EVAL_NUM_FEATURES * sizeof (gdouble));
+  for (i = 0; i < tuner->num_threads; i++)
+    {
+      TuneWorker *worker = &tuner->workers[i];
+      gsize start = MIN (i * share, count);
+      worker->keys = &keys[start];
+      worker->labels = &labels[start];
+      worker->count = MIN (share, count - start);
+      memcpy (worker->weights, tuner->weights, sizeof (tuner->weights));
+      worker->scale = scale;
+      worker->want_gradient = (gradient != NULL);
+      pthread_create (&worker->thread, NULL, tune_worker_main, worker);
+    }
+  for (i = 0; i < tuner->num_threads; i++)
+    {
+      TuneWorker *worker = &tuner->workers[i];
+      pthread_join (worker->thread, NULL);
+      error += worker->error;
+      for (k = 0; gradient != NULL && k < EVAL_NUM_FEATURES; k++)
+	gradient[k] += worker->gradient[k];
+    }
+  return error;
+}
+
+/* Take one Adam step along the mean gradient of a chunk.  */
+static void
+adam_step (Tuner *tuner, const gdouble *gradient, gsize count)
+{
+  gdouble correct1, correct2;
+  guint k;
+  tuner->num_steps++;
+  correct1 = 1 - pow (ADAM_BETA1, tuner->num_steps);
+  correct2 = 1 - pow (ADAM_BETA2, tuner->num_steps);
+  for (k = 0; k < EVAL_NUM_FEATURES; k++)
+    {
+      gdouble g = gradient[k] / count;
+      tuner->m[k] = ADAM_BETA1 * tuner->m[k] + (1 - ADAM_BETA1) * g;
+      tuner->v[k] = ADAM_BETA2 * tuner->v[k] + (1 - ADAM_BETA2) * g * g;
+      tuner->weights[k] -= tuner->rate * (tuner->m[k] / correct1) /
+	(sqrt (tuner->v[k] / correct2) + ADAM_EPSILON);
+    }
+}
+
+/* Find the K that fits the current weights best on a chunk, by a
+   golden section search on its logarithm.  */
+static gdouble
+fit_scale (Tuner *tuner, const StateKey *keys, const guchar *labels,
+	   gsize count)
+{
+  const gdouble ratio = (sqrt (5) - 1) / 2;
+  gdouble lo = log (1e-5), hi = log (1.0);
+  gdouble a = hi - ratio * (hi - lo), b = lo + ratio * (hi - lo);
+  gdouble error_a = tune_chunk (tuner, keys, labels, count, exp (a), NULL);
+  gdouble error_b = tune_chunk (tuner, keys, labels, count, exp (b), NULL);
+  while (hi - lo > 0.01)
+    {
+      if (error_a < error_b)
+	{
+	  hi = b;
+	  b = a;
+	  error_b = error_a;
+	  a = hi - ratio * (hi - lo);
+	  error_a = tune_chunk (tuner, keys, labels, count, exp (a), NULL);
+	}
+      else
+	{
+	  lo = a;
+	  a = b;
+	  error_a = error_b;
+	  b = lo + ratio * (hi - lo);
+	  error_b = tune_chunk (tuner, keys, labels, count, exp (b), NULL);
+	}
+    }
+  return exp ((lo + hi) / 2);
+}
+
+static void
+round_weights (Tuner *tuner, EvalWeights *weights)
+{
+  guint k;
+  for (k = 0; k < EVAL_NUM_FEATURES; k++)
+    weights->w[k] = (gint32) floor (tuner->weights[k] + 0.5);
+}
+
+/* Write labeled positions from the inputs to a file.  */
+static bool
+extract_positions (PositionSource *source, const char *output,
+		   StateKey *keys, guchar *labels, gsize chunk_size)
+{
+  guchar header[POSITIONS_HEADER_SIZE];
+  guint64 total = 0;
+  gsize count, i;
+  FILE *fp;
+  bool success;
+
+  fp = fopen (output, "wb");
+  if (fp == NULL)
+    {
+      g_printerr ("morris-tune: cannot create %s\n", output);
+      return false;
+    }
+  memcpy (header, POSITIONS_MAGIC, 4);
+  header[4] = POSITIONS_VERSION;
+  header[5] = MORRIS_VARIANT;
+  header[6] = 0;
+  header[7] = 0;
+  success = (fwrite (header, POSITIONS_HEADER_SIZE, 1, fp) == 1);
+  while (success && (count = source_read (source, keys, labels,
+					  chunk_size)) > 0)
+    {
+      for (i = 0; i < count; i++)
+	keys[i] = GUINT64_TO_LE (keys[i] | (guint64) labels[i] << 56);
+      success = (fwrite (keys, sizeof (StateKey), count, fp) == count);
+      total += count;
+    }
+  success &= (fclose (fp) == 0);
+  if (!success)
+    g_printerr ("morris-tune: error writing %s\n", output);
+  else if (!source->error)
+    printf ("%" G_GUINT64_FORMAT " positions\n", total);
+  return success && !source->error;
+}
+
+static void
+print_usage (void)
+{
+  puts ("Usage: morris-tune [OPTION]... FILE...\n"
+	"Tune the evaluation weights of " VARIANT_NAME " on the positions "
+	"in the\n"
+	"given game record or labeled position files.\n"
+	"\n"
+	"  -w, --weights FILE    initial weights (default: built in)\n"
+	"  -o, --output FILE     tuned weights file, written after every\n"
+	"                        epoch (default: weights.txt)\n"
+	"  -e, --epochs N        passes over the positions (default: 10)\n"
+	"  -r, --rate X          learning rate (default: 1)\n"
+	"  -k, --scale K         logistic scale of the scores\n"
+	"                        (default: fitted to the initial weights)\n"
+	"  -c, --chunk N         positions per chunk and update\n"
+	"                        (default: 1048576)\n"
+	"  -j, --threads N       number of threads\n"
+	"                        (default: one per processor)\n"
+	"  -x, --extract FILE    only write the positions to a labeled\n"
+	"                        position file\n"
+	"  -h, --help            display this help and exit");
+}
+
+int
+main (int argc, char *argv[])
+{
+  Tuner tuner;
+  PositionSource source;
+  EvalWeights weights = eval_default_weights;
+  const char *output = "weights.txt", *extract = NULL;
+  char **inputs;
+  guint num_inputs = 0, num_epochs = 10, epoch;
+  gsize chunk_size = 1 << 20;
+  StateKey *keys;
+  guchar *labels;
+  int status = 0;
+  int i;
+  guint k;
+
+  memset (&tuner, 0, sizeof (tuner));
+  tuner.num_threads = g_get_num_processors ();
+  tuner.rate = 1;
+  inputs = g_new (char *, argc);
+  for (i = 1; i < argc && status == 0; i++)
+    {
+      const char *arg = argv[i];
+      const char *value = (i + 1 < argc) ? argv[i+1] : NULL;
+      if (!strcmp ("-h", arg) || !strcmp ("--help", arg))
+	{
+	  print_usage ();
+	  g_free (inputs);
+	  return 0;
+	}
+      else if (arg[0] != '-')
+	inputs[num_inputs++] = argv[i];
+      else if (value == NULL)
+	{
+	  g_printerr ("morris-tune: missing argument for `%s'\n", arg);
+	  status = 1;
+	}
+      else if (!strcmp ("-w", arg) || !strcmp ("--weights", arg))
+	{
+	  if (!eval_load_weights (argv[++i], &weights))
+	    {
+	      g_printerr ("morris-tune: cannot read weights from %s\n",
+			  argv[i]);
+	      status = 1;
+	    }
+	}
+      else if (!strcmp ("-o", arg) || !strcmp ("--output", arg))
+	output = argv[++i];
+      else if (!strcmp ("-e", arg) || !strcmp ("--epochs", arg))
+	num_epochs = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-r", arg) || !strcmp ("--rate", arg))
+	tuner.rate = g_ascii_strtod (argv[++i], NULL);
+      else if (!strcmp ("-k", arg) || !strcmp ("--scale", arg))
+	tuner.scale = g_ascii_strtod (argv[++i], NULL);
+      else if (!strcmp ("-c", arg) || !strcmp ("--chunk", arg))
+	chunk_size = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-j", arg) || !strcmp ("--threads", arg))
+	tuner.num_threads = strtoul (argv[++i], NULL, 10);
+      else if (!strcmp ("-x", arg) || !strcmp ("--extract", arg))
+	extract = argv[++i];
+      else
+	{
+	  g_printerr ("morris-tune: unknown option `%s'\n", arg);
+	  print_usage ();
+	  status = 1;
+	}
+    }
+  if (status == 0 && num_inputs == 0)
+    {
+      g_printerr ("morris-tune: no positions given\n");
+      print_usage ();
+      status = 1;
+    }
+  if (status != 0)
+    {
+      g_free (inputs);
+      return status;
+    }
+  if (tuner.num_threads == 0)
+    tuner.num_threads = 1;
+  chunk_size = MAX (chunk_size, TUNE_BATCH);
+  keys = g_new (StateKey, chunk_size);
+  labels = g_new (guchar, chunk_size);
+
+  if (extract != NULL)
+    {
+      source_init (&source, inputs, num_inputs);
+      status = extract_positions (&source, extract, keys, labels,
+				  chunk_size) ? 0 : 1;
+      source_close_file (&source);
+      g_free (keys);
+      g_free (labels);
+      g_free (inputs);
+      return status;
+    }
+
+  tuner.workers = g_new (TuneWorker, tuner.num_threads);
+  for (k = 0; k < EVAL_NUM_FEATURES; k++)
+    tuner.weights[k] = weights.w[k];
+  for (epoch = 1; epoch <= num_epochs && status == 0; epoch++)
+    {
+      gint64 start = g_get_monotonic_time ();
+      gdouble error = 0, seconds;
+      guint64 total = 0;
+      gsize count;
+
+      source_init (&source, inputs, num_inputs);
+      while ((count = source_read (&source, keys, labels, chunk_size)) > 0)
+	{
+	  gdouble gradient[EVAL_NUM_FEATURES];
+	  if (tuner.scale <= 0)
+	    {
+	      tuner.scale = fit_scale (&tuner, keys, labels, count);
+	      printf ("scale %g\n", tuner.scale);
+	    }
+	  error += tune_chunk (&tuner, keys, labels, count, tuner.scale,
+			       gradient);
+	  adam_step (&tuner, gradient, count);
+	  total += count;
+	}
+      source_close_file (&source);
+      if (source.error)
+	{
+	  status = 1;
+	  break;
+	}
+      if (total == 0)
+	{
+	  g_printerr ("morris-tune: no positions given\n");
+	  status = 1;
+	  break;
+	}
+
+      seconds = (g_get_monotonic_time () - start) / 1e6;
+      printf ("epoch %u: %" G_GUINT64_FORMAT " positions, error %.6f, "
+	      "%.1f s\n", epoch, total, error / total, seconds);
+      round_weights (&tuner, &weights);
+      if (!eval_save_weights (output, &weights))
+	{
+	  g_printerr ("morris-tune: cannot write %s\n", output);
+	  status = 1;
+	}
+    }
+
+  g_free (tuner.workers);
+  g_free (keys);
+  g_free (labels);
+  g_free (inputs);
+  return status;
+}
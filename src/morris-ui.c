@@ -29,6 +29,25 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
  * graphical user interface code.  Note that there is also a
  * line-based terminal interface available too.  Its implementation is
  * contained in the file morris-term.c.
+ *
+ * When analysis is turned on, the current position is searched on a
+ * worker thread, so that the window stays responsive however long the
+ * search takes.  The worker sends the result of every iteration back
+ * to the main loop with g_idle_add(), and the suggested move is
+ * highlighted on the board.  Every change to the game state stops the
+ * running search and starts a new one.  Results that were already on
+ * their way are recognized as stale by their generation number and
+ * dropped.
+ *
+ * In spectator mode, started with @c --watch, the games of a game
+ * record file or of the search engine playing itself are shown move
+ * by move.  A timeout fires once per display frame and plays as many
+ * moves as the chosen speed allows since the previous frame, so that
+ * only the last position of a frame is drawn.  At the highest speed,
+ * moves are played for a fixed part of every frame.  The engine plays
+ * on its own thread and hands its moves over through a queue.  Clicks
+ * on the board are ignored while watching, and the game can be taken
+ * over from the last position once the games run out.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -44,10 +63,17 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
 #ifdef G_OS_WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#include "wpthread.h"
+#else
+#include <pthread.h>
 #endif
 
 #include "support.h"
 #include "morris.h"
+#include "corpus.h"
+#include "eval.h"
+#include "record.h"
+#include "search.h"
 
 gchar *package_prefix = PACKAGE_PREFIX;
 gchar *package_data_dir = PACKAGE_DATA_DIR;
@@ -59,10 +85,15 @@ GtkWidget *drawing_area;
 GtkWidget *scroll_window;
 GtkTextBuffer *text_buffer;
 GtkWidget *text_view;
+GtkWidget *analysis_toggle;
+GtkWidget *analysis_label;
+GtkWidget *speed_label;
 
-#define DELTA 32 /**< Board drawing unit size */
-#define MARK_SIZE 24 /**< Size of the selection mark */
-#define PIECE_SIZE 16 /**< Diameter of the board pieces */
+#define DELTA 32 /**< Smallest board drawing unit size */
+#define MARK_SIZE 24 /**< Size of the selection mark at #DELTA */
+#define PIECE_SIZE 16 /**< Diameter of the board pieces at #DELTA */
+/** Scale a size at #DELTA to the current board drawing unit size.  */
+#define UNIT_SCALE(size) ((size) * board_unit / DELTA)
 /** Mapping of graphical positions to board positions */
 guint board_points[24][2] = { {0, 0}, {3, 0}, {6, 0},
 			      {1, 1}, {3, 1}, {5, 1},
@@ -80,6 +111,90 @@ static guint setup_player = 0;
 static guint move_state = 0;
 static GameState state;
 
+/** The background search of the current position.  */
+struct Analysis_tag
+{
+  SearchContext search;
+  GameState state; /**< A copy of the position being searched */
+  pthread_t thread;
+  bool running; /**< Whether the thread has yet to be joined */
+  /** Incremented every time a search is stopped.  */
+  guint generation;
+};
+typedef struct Analysis_tag Analysis;
+
+/** Interval between the frames of spectator mode in milliseconds.  */
+#define SPECTATOR_FRAME_MSEC 16
+/** Time spent playing moves per frame at the highest speed.  */
+#define SPECTATOR_FRAME_BUDGET_USEC 8000
+/** Time that the engine thinks about every move when watched.  */
+#define SPECTATOR_MOVETIME_USEC 100000
+/** Random plies at the start of every engine game.  */
+#define SPECTATOR_OPENING_PLIES 4
+/** Plies after which an engine game is a draw.  */
+#define SPECTATOR_MAX_PLIES 500
+/** The most moves that the engine may play ahead of the display.  */
+#define SPECTATOR_QUEUE_LENGTH 64
+
+/** The speeds of spectator mode in moves per second.  Zero pauses the
+    games, and a negative speed has no limit.  */
+static const gdouble spectator_speeds[] = {
+  0, 0.5, 1, 2, 4, 8, 15, 30, 60, 120, 250, 500, 1000, -1
+};
+
+/** A step of a watched game.  */
+struct SpectatorEvent_tag
+{
+  bool new_game; /**< Start from the empty board, ignoring the move */
+  Move move;
+};
+typedef struct SpectatorEvent_tag SpectatorEvent;
+
+/** The state of spectator mode.  */
+struct Spectator_tag
+{
+  bool active;
+  /** The games being shown, or NULL to show the engine's games.  */
+  RecordReader *reader;
+  RecordGame game; /**< The recorded game being shown */
+  const guchar *cursor; /**< The next move of Spectator::game */
+  bool in_game;
+  /* The engine thread and the ::SpectatorEvent queue it fills.  */
+  pthread_t thread;
+  GAsyncQueue *queue;
+  SearchContext search;
+  volatile gint stop;
+  /* Playback.  */
+  gdouble speed; /**< One of #spectator_speeds */
+  gdouble credit; /**< Moves that are due to be played */
+  gint64 last_frame;
+  guint game_num;
+  guint move_num;
+  StateKey shown; /**< The position on the board and under analysis */
+};
+typedef struct Spectator_tag Spectator;
+
+/** The result of one search iteration on its way to the main loop.  */
+struct AnalysisUpdate_tag
+{
+  guint generation;
+  SearchInfo info;
+};
+typedef struct AnalysisUpdate_tag AnalysisUpdate;
+
+static Analysis analysis;
+static Spectator spectator;
+static bool have_hint = false; /**< Is there a suggested move?  */
+static SearchInfo hint; /**< The latest analysis of the position */
+
+static gint board_unit = DELTA; /**< Current board drawing unit size */
+/** The background and lines of the board.  */
+static GdkPixmap *board_pixmap = NULL;
+/** A bitmap of just the lines of the board.  */
+static GdkBitmap *lines_mask = NULL;
+/** How each board position looked when its redraw was queued.  */
+static guchar shown_looks[BOARD_SIZE];
+
 int term_main (int argc, char *argv[]);
 
 /**
@@ -140,113 +255,653 @@ update_text_view (guint update_style, const gchar *message)
   gtk_text_view_scroll_mark_onscreen (GTK_TEXT_VIEW (text_view), mark);
 }
 
+/** Bits that describe how a board position looks on the screen.  */
+enum PlaceLook_tag
+{
+  LOOK_PIECE = 0x03, /**< Mask of the ::Player whose piece is there */
+  LOOK_HINT = 0x04, /**< Destination of the suggested move */
+  LOOK_HINT_SOURCE = 0x08, /**< Source of the suggested move */
+  LOOK_SELECTED = 0x10, /**< Under the mouse */
+  LOOK_SOURCE = 0x20 /**< Source of the move being entered */
+};
+
+/**
+ * Find out how a board position should look.
+ *
+ * @param pos the board position
+ * @return a combination of ::PlaceLook_tag bits
+ */
+guchar
+place_look (guint pos)
+{
+  guchar look = board_ref (state.board, pos);
+  if (have_hint && hint.best.dest == pos)
+    look |= LOOK_HINT;
+  if (have_hint && hint.best.type == MOVE_MOVE && hint.best.src == pos)
+    look |= LOOK_HINT_SOURCE;
+  if (board_sel == pos)
+    look |= LOOK_SELECTED;
+  if (move_state == 2 && board_src_mark == pos)
+    look |= LOOK_SOURCE;
+  return look;
+}
+
+/**
+ * Get the square that a board position takes up on the screen.  Marks
+ * are drawn over the whole square, and nothing that belongs to a
+ * position is drawn outside of it.
+ *
+ * @param pos the board position
+ * @param rect receives the square
+ */
+void
+place_rect (guint pos, GdkRectangle *rect)
+{
+  gint mark_size = UNIT_SCALE (MARK_SIZE);
+  rect->x = board_unit * (board_points[pos][0] + 1) - mark_size / 2;
+  rect->y = board_unit * (board_points[pos][1] + 1) - mark_size / 2;
+  rect->width = mark_size;
+  rect->height = mark_size;
+}
+
+/**
+ * Queue a redraw of the board positions that look different from when
+ * they were last drawn.  Only their squares are redrawn, so this is
+ * cheap enough to call after every change.
+ */
+void
+refresh_board (void)
+{
+  guint i;
+  for (i = 0; i < BOARD_SIZE; i++)
+    {
+      guchar look = place_look (i);
+      if (look != shown_looks[i])
+	{
+	  GdkRectangle rect;
+	  place_rect (i, &rect);
+	  gtk_widget_queue_draw_area (drawing_area, rect.x, rect.y,
+				      rect.width, rect.height);
+	  shown_looks[i] = look;
+	}
+    }
+}
+
+/* Set the foreground color of a graphics context.  */
+static void
+set_color (GdkGC *gc, guint16 red, guint16 green, guint16 blue)
+{
+  GdkColor color;
+  color.red = red;
+  color.green = green;
+  color.blue = blue;
+  gdk_gc_set_rgb_fg_color (gc, &color);
+}
+
+/* Draw the lines of the board.  */
+static void
+draw_board_lines (GdkDrawable *drawable, GdkGC *gc)
+{
+  /* The straight lines between the squares come first, then the
+     diagonal lines in the corners.  */
+  gint lines[8][4] = { { 3, 0, 3, 2 }, { 6, 3, 4, 3 },
+		       { 3, 6, 3, 4 }, { 0, 3, 2, 3 },
+		       { 0, 0, 2, 2 }, { 6, 0, 4, 2 },
+		       { 6, 6, 4, 4 }, { 0, 6, 2, 4 } };
+  guint num_lines = HAVE_DIAGONALS ? 8 : 4;
+  gint unit = board_unit;
+  guint i;
+
+  gdk_gc_set_line_attributes (gc, MAX (UNIT_SCALE (1), 1), GDK_LINE_SOLID,
+			      GDK_CAP_BUTT, GDK_JOIN_MITER);
+  gdk_draw_rectangle (drawable, gc, FALSE, unit*1, unit*1, unit*6, unit*6);
+  gdk_draw_rectangle (drawable, gc, FALSE, unit*2, unit*2, unit*4, unit*4);
+  gdk_draw_rectangle (drawable, gc, FALSE, unit*3, unit*3, unit*2, unit*2);
+  for (i = 0; i < num_lines; i++)
+    gdk_draw_line (drawable, gc, unit * (lines[i][0] + 1),
+		   unit * (lines[i][1] + 1), unit * (lines[i][2] + 1),
+		   unit * (lines[i][3] + 1));
+}
+
+/**
+ * Render the parts of the board that never change into offscreen
+ * pixmaps: the background and the lines into #board_pixmap, and the
+ * lines alone into #lines_mask, which is used to draw the lines again
+ * over the marks.
+ */
+void
+render_board_pixmap (GtkWidget *widget)
+{
+  gint size = board_unit * 8;
+  GdkGC *gc;
+  GdkColor pixel;
+
+  board_pixmap = gdk_pixmap_new (widget->window, size, size, -1);
+  gc = gdk_gc_new (board_pixmap);
+  set_color (gc, 0xffff, 0xffff, 0xffff);
+  gdk_draw_rectangle (board_pixmap, gc, TRUE, 0, 0, size, size);
+  set_color (gc, 0x0000, 0x0000, 0x0000);
+  draw_board_lines (board_pixmap, gc);
+  g_object_unref (gc);
+
+  lines_mask = gdk_pixmap_new (widget->window, size, size, 1);
+  gc = gdk_gc_new (lines_mask);
+  pixel.pixel = 0;
+  gdk_gc_set_foreground (gc, &pixel);
+  gdk_draw_rectangle (lines_mask, gc, TRUE, 0, 0, size, size);
+  pixel.pixel = 1;
+  gdk_gc_set_foreground (gc, &pixel);
+  draw_board_lines (lines_mask, gc);
+  g_object_unref (gc);
+}
+
+/**
+ * Signal handler for the "configure_event" event sent to the drawing
+ * area.
+ *
+ * This signal handler scales the board to the size of the drawing
+ * area, so that it stays legible on high resolution screens.
+ */
+gboolean
+configure_event (GtkWidget *widget, GdkEventConfigure *event,
+		 gpointer user_data)
+{
+  gint unit = MAX (MIN (event->width, event->height) / 8, 1);
+  guint i;
+  if (unit == board_unit && board_pixmap != NULL)
+    return TRUE;
+  board_unit = unit;
+  if (board_pixmap != NULL)
+    {
+      g_object_unref (board_pixmap);
+      g_object_unref (lines_mask);
+      board_pixmap = NULL;
+      lines_mask = NULL;
+    }
+  /* The whole area is exposed after a resize anyway.  */
+  for (i = 0; i < BOARD_SIZE; i++)
+    shown_looks[i] = place_look (i);
+  return TRUE;
+}
+
 /**
  * Signal handler for the "expose_event" event sent to the drawing
  * area.
  *
  * This signal handler renders the board within the N Mens Morris
- * window.
+ * window.  Only the exposed area is drawn: the static parts of the
+ * board are copied from #board_pixmap, and only the positions whose
+ * squares meet the exposed area are drawn on top.  GTK+ double
+ * buffers the drawing area, so none of the steps are ever seen.
  */
 gboolean
 expose_event (GtkWidget * widget, GdkEventExpose * event,
 	      gpointer user_data)
 {
   static GdkGC *gc = NULL;
-  GdkColor ltgreen, tan, black, red, blue, dkgreen;
-  gint lines[8][4] = { { 0, 0, 2, 2 }, { 3, 0, 3, 2 },
-		       { 6, 0, 4, 2 }, { 6, 3, 4, 3 },
-		       { 6, 6, 4, 4 }, { 3, 6, 3, 4 },
-		       { 0, 6, 2, 4 }, { 0, 3, 2, 3 } };
+  GdkRectangle board_rect, area;
+  gint piece_size = UNIT_SCALE (PIECE_SIZE);
+  gint dot_size = MAX (UNIT_SCALE (4), 2);
   guint i;
 
-  ltgreen.red = 0x8000;
-  ltgreen.green = 0xffff;
-  ltgreen.blue = 0x8000;
-  black.red = 0x0000;
-  black.green = 0x0000;
-  black.blue = 0x0000;
-  tan.red = 0xffff;
-  tan.green = 0xf000;
-  tan.blue = 0xc000;
-  red.red = 0xffff;
-  red.green = 0x0000;
-  red.blue = 0x0000;
-  blue.red = 0x0000;
-  blue.green = 0x0000;
-  blue.blue = 0xffff;
-  dkgreen.red = 0x0000;
-  dkgreen.green = 0xa000;
-  dkgreen.blue = 0x0000;
-
   /* At the start of an expose handler, a clip region of event->area
      is set on the window, and event->area has been cleared to the
      widget's background color.  */
 
   if (gc == NULL)
     gc = gdk_gc_new (widget->window);
+  if (board_pixmap == NULL)
+    render_board_pixmap (widget);
+
+  /* Copy the background and lines.  */
+  board_rect.x = 0;
+  board_rect.y = 0;
+  board_rect.width = board_unit * 8;
+  board_rect.height = board_unit * 8;
+  if (gdk_rectangle_intersect (&event->area, &board_rect, &area))
+    gdk_draw_drawable (widget->window, gc, board_pixmap, area.x, area.y,
+		       area.x, area.y, area.width, area.height);
 
-  /* Draw the board background.  */
-  /* gdk_gc_set_rgb_fg_color (gc, &tan);
-  gdk_draw_rectangle
-    (widget->window, gc, TRUE, DELTA*1, DELTA*1, DELTA*6, DELTA*6); */
+  for (i = 0; i < BOARD_SIZE; i++)
+    {
+      GdkRectangle rect;
+      guchar look = place_look (i);
+      Player player = look & LOOK_PIECE;
+      gint x = board_unit * (board_points[i][0] + 1);
+      gint y = board_unit * (board_points[i][1] + 1);
+
+      place_rect (i, &rect);
+      if (!gdk_rectangle_intersect (&event->area, &rect, &area))
+	continue;
+
+      /* Draw the marks, the current selection above the suggested
+	 move, and the source position of a move above both.  */
+      if (look & (LOOK_HINT | LOOK_SELECTED | LOOK_SOURCE))
+	{
+	  if (look & LOOK_SOURCE)
+	    set_color (gc, 0x0000, 0xa000, 0x0000);
+	  else if (look & LOOK_SELECTED)
+	    set_color (gc, 0x8000, 0xffff, 0x8000);
+	  else
+	    set_color (gc, 0xffff, 0xc000, 0x4000);
+	  gdk_draw_rectangle (widget->window, gc, TRUE,
+			      rect.x, rect.y, rect.width, rect.height);
+	}
+      else if (look & LOOK_HINT_SOURCE)
+	{
+	  set_color (gc, 0xffff, 0xc000, 0x4000);
+	  gdk_draw_rectangle (widget->window, gc, FALSE, rect.x, rect.y,
+			      rect.width - 1, rect.height - 1);
+	}
 
-  /* Draw the curent selection.  */
-  gdk_gc_set_rgb_fg_color (gc, &ltgreen);
-  gdk_draw_rectangle (widget->window, gc, TRUE,
-	      DELTA * (board_points[board_sel][0] + 1) - MARK_SIZE / 2,
-	      DELTA * (board_points[board_sel][1] + 1) - MARK_SIZE / 2,
-	      MARK_SIZE, MARK_SIZE);
+      /* Draw the lines again over the marks.  */
+      if (look & ~LOOK_PIECE)
+	{
+	  set_color (gc, 0x0000, 0x0000, 0x0000);
+	  gdk_gc_set_clip_mask (gc, lines_mask);
+	  gdk_draw_rectangle (widget->window, gc, TRUE,
+			      rect.x, rect.y, rect.width, rect.height);
+	  gdk_gc_set_clip_mask (gc, NULL);
+	}
 
-  /* Draw the marker for the source position of a move.  */
-  if (move_state == 2)
+      /* Draw the board piece.  */
+      if (player == PLAYER1)
+	set_color (gc, 0xffff, 0x0000, 0x0000);
+      else if (player == PLAYER2)
+	set_color (gc, 0x0000, 0x0000, 0xffff);
+      else
+	set_color (gc, 0x0000, 0x0000, 0x0000);
+      if (player != EMPTY)
+	gdk_draw_arc (widget->window, gc, TRUE,
+		      x - piece_size / 2, y - piece_size / 2,
+		      piece_size, piece_size, 0, 360 * 64);
+      else
+	gdk_draw_arc (widget->window, gc, TRUE,
+		      x - dot_size / 2, y - dot_size / 2,
+		      dot_size, dot_size, 0, 360 * 64);
+    }
+
+  return TRUE;
+}
+
+/**
+ * Show the latest analysis result in the analysis label.
+ */
+void
+update_analysis_label (void)
+{
+  gchar *text;
+  if (!have_hint)
     {
-      gdk_gc_set_rgb_fg_color (gc, &dkgreen);
-      gdk_draw_rectangle (widget->window, gc, TRUE,
-	  DELTA * (board_points[board_src_mark][0] + 1) - MARK_SIZE / 2,
-	  DELTA * (board_points[board_src_mark][1] + 1) - MARK_SIZE / 2,
-	  MARK_SIZE, MARK_SIZE);
+      gtk_label_set_text (GTK_LABEL (analysis_label), "");
+      return;
     }
+  if (hint.score >= SEARCH_WIN_SCORE)
+    text = g_strdup_printf (_("Depth %u: wins in %d plies"), hint.depth,
+			    EVAL_WIN - hint.score);
+  else if (hint.score <= -SEARCH_WIN_SCORE)
+    text = g_strdup_printf (_("Depth %u: loses in %d plies"), hint.depth,
+			    EVAL_WIN + hint.score);
+  else
+    text = g_strdup_printf (_("Depth %u: score %+.2f"), hint.depth,
+			    hint.score / 100.0);
+  gtk_label_set_text (GTK_LABEL (analysis_label), text);
+  g_free (text);
+}
 
-  /* Draw the 11 Mens Morris board.  */
-  gdk_gc_set_rgb_fg_color (gc, &black);
-  gdk_draw_rectangle
-    (widget->window, gc, FALSE, DELTA*1, DELTA*1, DELTA*6, DELTA*6);
-  gdk_draw_rectangle
-    (widget->window, gc, FALSE, DELTA*2, DELTA*2, DELTA*4, DELTA*4);
-  gdk_draw_rectangle
-    (widget->window, gc, FALSE, DELTA*3, DELTA*3, DELTA*2, DELTA*2);
-  for (i = 0; i < 8; i++)
-    gdk_draw_line (widget->window, gc, DELTA * (lines[i][0] + 1),
-		   DELTA * (lines[i][1] + 1), DELTA * (lines[i][2] + 1),
-		   DELTA * (lines[i][3] + 1));
-
-  /* Draw the board pieces.  */
-  for (i = 0; i < BOARD_SIZE; i++)
+/**
+ * Idle handler that receives an analysis result in the main loop.
+ */
+gboolean
+analysis_update_idle (gpointer data)
+{
+  AnalysisUpdate *update = (AnalysisUpdate *) data;
+  if (update->generation == analysis.generation)
     {
-      Player player;
-      player = board_ref (state.board, i);
-      if (player == PLAYER1)
-	  gdk_gc_set_rgb_fg_color (gc, &red);
-      if (player == PLAYER2)
-	  gdk_gc_set_rgb_fg_color (gc, &blue);
-      if (player != EMPTY)
-	  gdk_draw_arc (widget->window, gc, TRUE,
-			DELTA * (board_points[i][0] + 1) - PIECE_SIZE / 2,
-			DELTA * (board_points[i][1] + 1) - PIECE_SIZE / 2,
-			PIECE_SIZE, PIECE_SIZE, 0, 360 * 64);
+      hint = update->info;
+      have_hint = true;
+      update_analysis_label ();
+      refresh_board ();
+    }
+  g_free (update);
+  return FALSE;
+}
+
+/* Called by the search on the analysis thread after every
+   iteration.  */
+static void
+analysis_report (const SearchInfo *info, gpointer data)
+{
+  AnalysisUpdate *update = g_new (AnalysisUpdate, 1);
+  update->generation = GPOINTER_TO_UINT (data);
+  update->info = *info;
+  g_idle_add (analysis_update_idle, update);
+}
+
+static void *
+analysis_thread_main (void *data)
+{
+  SearchInfo result;
+  search_run (&analysis.search, &analysis.state, &result);
+  return NULL;
+}
+
+/**
+ * Stop the analysis of the current position, if any, and forget its
+ * results.  The display is left alone, as the window may already be
+ * gone.
+ */
+void
+stop_analysis (void)
+{
+  analysis.generation++;
+  have_hint = false;
+  if (analysis.running)
+    {
+      /* The search notices the flag within a few thousand positions,
+	 so this does not keep the main loop waiting.  */
+      search_stop (&analysis.search);
+      pthread_join (analysis.thread, NULL);
+      analysis.running = false;
+    }
+}
+
+/**
+ * Start analyzing the current position if analysis is turned on,
+ * after stopping the analysis of the previous position.
+ */
+void
+restart_analysis (void)
+{
+  Move moves[MAX_MOVES];
+  stop_analysis ();
+  update_analysis_label ();
+  refresh_board ();
+  if (!gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (analysis_toggle)) ||
+      gen_moves (&state, moves) == 0)
+    return;
+  analysis.state = state;
+  search_init (&analysis.search);
+  analysis.search.report = analysis_report;
+  analysis.search.report_data = GUINT_TO_POINTER (analysis.generation);
+  if (pthread_create (&analysis.thread, NULL, analysis_thread_main,
+		      NULL) == 0)
+    analysis.running = true;
+}
+
+/**
+ * Signal handler for the "toggled" signal sent to the analysis check
+ * button.
+ */
+void
+analysis_toggled (GtkToggleButton *button, gpointer data)
+{
+  restart_analysis ();
+}
+
+/********************************************************************/
+/* Spectator mode  */
+
+/* Hand a step of an engine game over to the main loop, waiting while
+   the display is far behind.  */
+static void
+push_spectator_event (bool new_game, const Move *move)
+{
+  SpectatorEvent *event = g_new0 (SpectatorEvent, 1);
+  event->new_game = new_game;
+  if (move != NULL)
+    event->move = *move;
+  while (g_async_queue_length (spectator.queue) >= SPECTATOR_QUEUE_LENGTH &&
+	 !g_atomic_int_get (&spectator.stop))
+    g_usleep (10000);
+  g_async_queue_push (spectator.queue, event);
+}
+
+/* Play engine games until spectator mode ends.  */
+static void *
+spectator_engine_main (void *data)
+{
+  guint64 rng_state = CORPUS_DEFAULT_SEED;
+  while (!g_atomic_int_get (&spectator.stop))
+    {
+      GameState game;
+      Move moves[MAX_MOVES];
+      guint num_moves, plies = 0;
+
+      init_game_state (&game);
+      push_spectator_event (true, NULL);
+      while (!g_atomic_int_get (&spectator.stop) &&
+	     plies < SPECTATOR_MAX_PLIES &&
+	     (num_moves = gen_moves (&game, moves)) > 0)
+	{
+	  Move move;
+	  if (plies < SPECTATOR_OPENING_PLIES)
+	    move = moves[corpus_random (&rng_state) % num_moves];
+	  else
+	    {
+	      SearchInfo result;
+	      spectator.search.deadline = g_get_monotonic_time () +
+		SPECTATOR_MOVETIME_USEC;
+	      search_run (&spectator.search, &game, &result);
+	      move = result.best;
+	    }
+	  /* The main loop replays the move and fails in the same way,
+	     which ends spectator mode.  */
+	  push_spectator_event (false, &move);
+	  if (!record_play_move (&game, &move))
+	    return NULL;
+	  plies++;
+	}
+    }
+  return NULL;
+}
+
+/*
+ * Get the next step of the watched games.  Returns 1 if there is one,
+ * 0 if the engine has not played it yet, and -1 at the end of the
+ * game records or if they are corrupt.
+ */
+static int
+next_spectator_event (SpectatorEvent *event)
+{
+  const guchar *end;
+  if (spectator.reader == NULL)
+    {
+      SpectatorEvent *queued = g_async_queue_try_pop (spectator.queue);
+      if (queued == NULL)
+	return 0;
+      *event = *queued;
+      g_free (queued);
+      return 1;
+    }
+
+  end = spectator.game.data + spectator.game.size;
+  if (spectator.in_game && spectator.cursor == end)
+    spectator.in_game = false;
+  if (!spectator.in_game)
+    {
+      if (record_reader_next (spectator.reader, &spectator.game) <= 0)
+	return -1;
+      spectator.cursor = spectator.game.data;
+      spectator.in_game = true;
+      event->new_game = true;
+      return 1;
+    }
+  event->new_game = false;
+  return record_decode_move (&spectator.cursor, end, &event->move) ? 1 : -1;
+}
+
+/* Hand the board back to the human players.  */
+static void
+end_spectator_mode (const gchar *message)
+{
+  spectator.active = false;
+  /* Pick up the turn where the games left off.  */
+  setup_player = (state.cur_player == PLAYER2) ? 1 : 0;
+  move_state = (state.setup_rounds_left == 0) ? 1 : 0;
+  update_text_view (0, message);
+  gtk_label_set_text (GTK_LABEL (speed_label), "");
+}
+
+/**
+ * Timeout handler that shows the next frame of spectator mode.
+ */
+gboolean
+spectator_frame (gpointer data)
+{
+  gint64 now = g_get_monotonic_time ();
+  bool changed = false;
+  const gchar *end_message = NULL;
+
+  if (spectator.speed >= 0)
+    spectator.credit += spectator.speed * (now - spectator.last_frame) / 1e6;
+  spectator.last_frame = now;
+  /* Play the moves that are due.  Only the last position is drawn, so
+     the frames in between are skipped.  */
+  while ((spectator.speed < 0) ?
+	 g_get_monotonic_time () - now < SPECTATOR_FRAME_BUDGET_USEC :
+	 spectator.credit >= 1)
+    {
+      SpectatorEvent event;
+      int status = next_spectator_event (&event);
+      if (status == 0)
+	{
+	  /* Do not make up for the wait with a burst of moves.  */
+	  spectator.credit = MIN (spectator.credit, 1);
+	  break;
+	}
+      if (status < 0)
+	{
+	  end_message = _("There are no more games.");
+	  break;
+	}
+      if (event.new_game)
+	{
+	  init_game_state (&state);
+	  spectator.game_num++;
+	  spectator.move_num = 0;
+	}
+      else if (record_play_move (&state, &event.move))
+	spectator.move_num++;
+      else
+	{
+	  end_message = (spectator.reader != NULL) ?
+	    _("The game records are corrupt.") :
+	    _("The engine played an invalid move.");
+	  break;
+	}
+      spectator.credit -= 1;
+      changed = true;
+    }
+
+  if (changed)
+    {
+      gchar *text;
+      if (state.setup_rounds_left == 0 && get_winner (&state) != EMPTY)
+	update_text_view (2, "");
       else
 	{
-	  gdk_gc_set_rgb_fg_color (gc, &black);
-	  gdk_draw_arc (widget->window, gc, TRUE,
-			DELTA * (board_points[i][0] + 1) - 2,
-			DELTA * (board_points[i][1] + 1) - 2,
-			4, 4, 0, 360 * 64);
+	  text = g_strdup_printf (_("Game %u, move %u."),
+				  spectator.game_num, spectator.move_num);
+	  update_text_view (1, text);
+	  g_free (text);
+	}
+      /* A new game after an unfinished one may show the same board.  */
+      if (pack_state (&state) != spectator.shown)
+	{
+	  spectator.shown = pack_state (&state);
+	  restart_analysis ();
 	}
     }
+  if (end_message != NULL)
+    end_spectator_mode (end_message);
+  return spectator.active;
+}
+
+/**
+ * Signal handler for the "value_changed" signal sent to the speed
+ * scale of spectator mode.
+ */
+void
+speed_changed (GtkRange *range, gpointer data)
+{
+  guint index = (guint) (gtk_range_get_value (range) + 0.5);
+  gchar *text;
+  index = MIN (index, G_N_ELEMENTS (spectator_speeds) - 1);
+  spectator.speed = spectator_speeds[index];
+  if (!spectator.active)
+    return;
+  if (spectator.speed == 0)
+    text = g_strdup (_("Paused"));
+  else if (spectator.speed < 0)
+    text = g_strdup (_("Fastest"));
+  else
+    text = g_strdup_printf (_("%g moves/s"), spectator.speed);
+  gtk_label_set_text (GTK_LABEL (speed_label), text);
+  g_free (text);
+}
 
+/**
+ * Start spectator mode.
+ *
+ * @param path a game record file whose games are shown, or NULL to
+ * show games of the search engine against itself
+ * @return TRUE on success, FALSE if the file could not be read
+ */
+gboolean
+start_spectator_mode (const gchar *path)
+{
+  memset (&spectator, 0, sizeof (spectator));
+  if (path != NULL)
+    {
+      spectator.reader = record_reader_open (path);
+      if (spectator.reader == NULL)
+	return FALSE;
+    }
+  else
+    {
+      spectator.queue = g_async_queue_new ();
+      search_init (&spectator.search);
+      if (pthread_create (&spectator.thread, NULL, spectator_engine_main,
+			  NULL) != 0)
+	{
+	  g_async_queue_unref (spectator.queue);
+	  spectator.queue = NULL;
+	  return FALSE;
+	}
+    }
+  spectator.active = true;
+  spectator.shown = pack_state (&state);
+  spectator.last_frame = g_get_monotonic_time ();
+  g_timeout_add (SPECTATOR_FRAME_MSEC, spectator_frame, NULL);
   return TRUE;
 }
 
+/**
+ * Free what spectator mode used, after the main loop has quit.
+ */
+void
+shutdown_spectator_mode (void)
+{
+  spectator.active = false;
+  if (spectator.queue != NULL)
+    {
+      SpectatorEvent *event;
+      g_atomic_int_set (&spectator.stop, 1);
+      search_stop (&spectator.search);
+      pthread_join (spectator.thread, NULL);
+      while ((event = g_async_queue_try_pop (spectator.queue)) != NULL)
+	g_free (event);
+      g_async_queue_unref (spectator.queue);
+      spectator.queue = NULL;
+    }
+  if (spectator.reader != NULL)
+    {
+      record_reader_close (spectator.reader);
+      spectator.reader = NULL;
+    }
+}
+
 /**
  * Set the selected board position based off of a mouse position.
  *
@@ -260,16 +915,13 @@ mouse_set_board_sel (gdouble x, gdouble y)
   guint i;
   for (i = 0; i < 24; i++)
     {
-      gdouble minx, miny, maxx, maxy;
-      minx = DELTA * (board_points[i][0] + 1) - MARK_SIZE / 2;
-      miny = DELTA * (board_points[i][1] + 1) - MARK_SIZE / 2;
-      maxx = DELTA * (board_points[i][0] + 1) + MARK_SIZE / 2;
-      maxy = DELTA * (board_points[i][1] + 1) + MARK_SIZE / 2;
-      if (minx <= x && x < maxx &&
-	  miny <= y && y < maxy)
+      GdkRectangle rect;
+      place_rect (i, &rect);
+      if (rect.x <= x && x < rect.x + rect.width &&
+	  rect.y <= y && y < rect.y + rect.height)
 	{
 	  board_sel = i;
-	  gtk_widget_queue_draw (drawing_area);
+	  refresh_board ();
 	  return TRUE;
 	}
     }
@@ -323,6 +975,10 @@ button_release_event (GtkWidget *widget, GdkEventButton *event, gpointer data)
 {
   gboolean next_move = TRUE; /* Was the current move, place, or remove
 				completed successfully?  */
+  StateKey old_key = pack_state (&state);
+  /* The board belongs to the watched games.  */
+  if (spectator.active)
+    return FALSE;
   if (event->button == 3 && move_state == 2)
   if (event->button != 1)
     return FALSE;
@@ -364,7 +1020,7 @@ button_release_event (GtkWidget *widget, GdkEventButton *event, gpointer data)
 		}
 	    }
 	}
-      gtk_widget_queue_draw (drawing_area);
+      refresh_board ();
       if (next_move)
 	{
 	  if (state.remove_state)
@@ -414,7 +1070,7 @@ button_release_event (GtkWidget *widget, GdkEventButton *event, gpointer data)
 		move_state = 1;
 	    }
 	}
-      gtk_widget_queue_draw (drawing_area);
+      refresh_board ();
       if (next_move)
 	{
 	  Player player;
@@ -432,6 +1088,8 @@ button_release_event (GtkWidget *widget, GdkEventButton *event, gpointer data)
 	    update_text_view (2, "");
 	}
     }
+  if (pack_state (&state) != old_key)
+    restart_analysis ();
   return FALSE;
 }
 
@@ -468,6 +1126,8 @@ int
 main (int argc, char *argv[])
 {
   gboolean gui_init;
+  gboolean watch = FALSE;
+  const gchar *watch_path = NULL;
 #ifdef G_OS_WIN32
   package_prefix = g_win32_get_package_installation_directory (NULL, NULL);
   package_data_dir = g_build_filename (package_prefix, "share", NULL);
@@ -481,19 +1141,36 @@ main (int argc, char *argv[])
   textdomain (GETTEXT_PACKAGE);
 #endif
 
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+  /* The analysis thread calls g_idle_add ().  */
+  if (!g_thread_supported ())
+    g_thread_init (NULL);
+#endif
   gtk_set_locale ();
   gui_init = gtk_init_check (&argc, &argv);
   if (argc >= 2 && (!strcmp ("-h", argv[1]) ||
 		    !strcmp ("--help", argv[1])))
     {
       puts (_( \
-"Ussage: morris-ui <--nogui>\n" \
+"Ussage: morris-ui <--nogui | --batch [-o RECORDS] [FILE] |\n" \
+"                  --watch [RECORDS]>\n" \
 "If `--nogui' is specified, then a terminal interface will be run\n"
-"instead of a GTK+ graphical interface."));
+"instead of a GTK+ graphical interface.\n"
+"If `--batch' is specified, then the game records in FILE, or on\n"
+"standard input, are validated without any user interaction.  The\n"
+"valid games are saved in the binary file RECORDS if it is given.\n"
+"If `--watch' is specified, then the games in the binary file\n"
+"RECORDS, or games of the computer against itself, are shown."));
       return 0;
     }
-  if (!gui_init || argc >= 2 && !strcmp ("--nogui", argv[1]))
+  if (!gui_init || argc >= 2 && (!strcmp ("--nogui", argv[1]) ||
+				 !strcmp ("--batch", argv[1])))
     return term_main (argc, argv);
+  if (argc >= 2 && !strcmp ("--watch", argv[1]))
+    {
+      watch = TRUE;
+      watch_path = (argc >= 3) ? argv[2] : NULL;
+    }
 
 #ifdef G_OS_WIN32
   FreeConsole();
@@ -528,7 +1205,7 @@ main (int argc, char *argv[])
 
     main_window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
     gtk_container_set_border_width (GTK_CONTAINER (main_window), 4);
-    gtk_window_set_title (GTK_WINDOW (main_window), _("11 Mens Morris"));
+    gtk_window_set_title (GTK_WINDOW (main_window), VARIANT_NAME);
     gtk_window_set_default_size (GTK_WINDOW (main_window), 256, 400);
 
     vbox = gtk_vbox_new (FALSE, 4);
@@ -538,7 +1215,7 @@ main (int argc, char *argv[])
     drawing_area = gtk_drawing_area_new ();
     gtk_widget_set_size_request (drawing_area, DELTA * 8, DELTA * 8);
     gtk_widget_show (drawing_area);
-    gtk_box_pack_start (GTK_BOX (vbox), drawing_area, FALSE, FALSE, 0);
+    gtk_box_pack_start (GTK_BOX (vbox), drawing_area, TRUE, TRUE, 0);
     color.red = 0xffff;
     color.green = 0xffff;
     color.blue = 0xffff;
@@ -547,6 +1224,8 @@ main (int argc, char *argv[])
 			   GDK_POINTER_MOTION_MASK |
 			   GDK_BUTTON_PRESS_MASK |
 			   GDK_BUTTON_RELEASE_MASK);
+    g_signal_connect ((gpointer) drawing_area, "configure_event",
+		      G_CALLBACK (configure_event), NULL);
     g_signal_connect ((gpointer) drawing_area, "expose_event",
 		      G_CALLBACK (expose_event), NULL);
     g_signal_connect ((gpointer) drawing_area, "motion_notify_event",
@@ -556,6 +1235,47 @@ main (int argc, char *argv[])
     g_signal_connect ((gpointer) drawing_area, "key_press_event",
 		      G_CALLBACK (key_press_event), NULL);
 
+    {
+      GtkWidget *hbox = gtk_hbox_new (FALSE, 8);
+      gtk_widget_show (hbox);
+      gtk_box_pack_start (GTK_BOX (vbox), hbox, FALSE, FALSE, 0);
+      analysis_toggle = gtk_check_button_new_with_mnemonic (_("_Analyze"));
+      gtk_widget_show (analysis_toggle);
+      gtk_box_pack_start (GTK_BOX (hbox), analysis_toggle, FALSE, FALSE, 0);
+      g_signal_connect ((gpointer) analysis_toggle, "toggled",
+			G_CALLBACK (analysis_toggled), NULL);
+      analysis_label = gtk_label_new ("");
+      gtk_widget_show (analysis_label);
+      gtk_box_pack_start (GTK_BOX (hbox), analysis_label, FALSE, FALSE, 0);
+    }
+
+    if (watch)
+      {
+	GtkWidget *hbox = gtk_hbox_new (FALSE, 8);
+	GtkWidget *speed_scale;
+	gtk_widget_show (hbox);
+	gtk_box_pack_start (GTK_BOX (vbox), hbox, FALSE, FALSE, 0);
+	speed_scale = gtk_hscale_new_with_range
+	  (0, G_N_ELEMENTS (spectator_speeds) - 1, 1);
+	gtk_scale_set_draw_value (GTK_SCALE (speed_scale), FALSE);
+	gtk_widget_set_size_request (speed_scale, DELTA * 4, -1);
+	gtk_widget_show (speed_scale);
+	gtk_box_pack_start (GTK_BOX (hbox), speed_scale, FALSE, FALSE, 0);
+	speed_label = gtk_label_new ("");
+	gtk_widget_show (speed_label);
+	gtk_box_pack_start (GTK_BOX (hbox), speed_label, FALSE, FALSE, 0);
+	if (!start_spectator_mode (watch_path))
+	  {
+	    g_printerr (_("morris-ui: cannot watch %s\n"),
+			watch_path ? watch_path : _("the engine"));
+	    return 1;
+	  }
+	g_signal_connect ((gpointer) speed_scale, "value_changed",
+			  G_CALLBACK (speed_changed), NULL);
+	/* Two moves per second.  */
+	gtk_range_set_value (GTK_RANGE (speed_scale), 3);
+      }
+
     scroll_window = gtk_scrolled_window_new (NULL, NULL);
     gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scroll_window),
 			    GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
@@ -584,6 +1304,8 @@ main (int argc, char *argv[])
 		      G_CALLBACK (gtk_main_quit), NULL);
 
     gtk_main ();
+    stop_analysis ();
+    shutdown_spectator_mode ();
   }
 
 #ifdef G_OS_WIN32
@@ -35,6 +35,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
 #include <glib.h>
 
 #include "morris.h"
+#include "simd.h"
 #include "tables.h"
 
 /**
@@ -43,9 +44,8 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
  * Morris Sim was primarily intended to be a high performance, brute
  * force simulator for the game 11 Mens Morris, a variation of 9 Mens
  * Morris.  As such, it uses various techniques to speed up
- * computations.  However, the actual simulator engine has not been
- * written yet.  You can see the basic plan for the simulator engine
- * in morris-sim.c, though.
+ * computations.  The plan for the simulator engine and the description
+ * of how it enumerates game states on disk are in morris-sim.c.
  *
  * All the core functions for manipulating the game state and
  * performing moves are located in morris.c.  The public functions
@@ -61,72 +61,6 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
  * placed in the generated documentation.
  */
 
-/********************************************************************/
-/* SIMD wrapper functions.  */
-/* NOTE: I had to add a few quirks to the calling convention of these
-   functions so that I could define non-SIMD alternatives.  Note that
-   the non-SIMD compatibility code has not be tested as much as the
-   SIMD code.  */
-
-#ifdef USE_PACKED
-
-typedef guchar v8uc __attribute__ ((vector_size (8)));
-typedef int v2si __attribute__ ((vector_size (8)));
-#define SIMD_ARRAY(board) *(v8uc *) board
-#define BOARD_QUAD(array) (BoardQuad *) &array
-
-#define simd_and(unused, board1, board2) simd_and_real (board1, board2)
-#define simd_or(unused, board1, board2)  simd_or_real (board1, board2)
-#define simd_not(unsused, board)         simd_not_real (board)
-
-static inline v8uc simd_and_real (v8uc board1, v8uc board2)
-{ return board1 & board2; }
-/* { return (v8uc) __builtin_ia32_pand ((v2si) board1, (v2si) board2); } */
-
-static inline v8uc simd_or_real (v8uc board1, v8uc board2)
-{ return board1 | board2; }
-/* { return (v8uc) __builtin_ia32_por ((v2si) board1, (v2si) board2); } */
-
-static inline v8uc simd_not_real (v8uc board)
-{ return ~board; }
-
-#else /* not USE_PACKED */
-
-#include <stdlib.h> /* for alloca () */
-
-typedef BoardQuad * v8uc;
-#define SIMD_ARRAY(board) board
-#define BOARD_QUAD(array) array
-
-static inline v8uc
-simd_and (v8uc dest_board, v8uc board1, v8uc board2)
-{
-    guchar i;
-    for (i = 0; i < BOARD_SIZE; i++)
-	dest_board[i] = board1[i] & board2[i];
-    return dest_board;
-}
-
-static inline v8uc
-simd_or (v8uc dest_board, v8uc board1, v8uc board2)
-{
-  guchar i;
-  for (i = 0; i < BOARD_SIZE; i++)
-    dest_board[i] = board1[i] | board2[i];
-  return dest_board;
-}
-
-static inline v8uc
-simd_not (v8uc dest_board, v8uc board)
-{
-  guchar i;
-  for (i = 0; i < BOARD_SIZE; i++)
-    dest_board[i] = ~board[i];
-  return dest_board;
-}
-
-#endif
-
 /********************************************************************/
 /* Board referencing and setting code  */
 
@@ -176,9 +110,9 @@ set_board_pos (BoardQuad *board, guchar index, guchar value)
 #else
   switch (bitpos) {
     case 0: mask = 0b11111100; break;
-    case 1: mask = 0b11110011; break;
-    case 2: mask = 0b11001111; break;
-    case 3: mask = 0b00111111; break; }
+    case 2: mask = 0b11110011; break;
+    case 4: mask = 0b11001111; break;
+    case 6: mask = 0b00111111; break; }
 #endif
   ((guchar *) board)[index/4] &= mask;
   ((guchar *) board)[index/4] |= pack_value;
@@ -224,13 +158,7 @@ get_opponent (GameState *state)
 bool
 are_adjacent (guchar pos1, guchar pos2)
 {
-  guchar i;
-  for (i = pos1 * 4; i < pos1 * 4 + 4; i++)
-    {
-      if (pos2 == adjacent_places[i])
-	return true;
-    }
-  return false;
+  return pos2 < BOARD_SIZE && (neighbor_mask[pos1] & 1 << pos2);
 }
 
 /**
@@ -264,13 +192,119 @@ is_valid_place (GameState *state, guchar pos)
 bool
 is_valid_move (GameState *state, guchar src, guchar dest)
 {
-  if (are_adjacent (src, dest) &&
+  if ((are_adjacent (src, dest) ||
+       (dest < BOARD_SIZE && can_fly (state, state->cur_player))) &&
       board_ref (state->board, src) == state->cur_player &&
       board_ref (state->board, dest) == EMPTY)
     return true;
   return false;
 }
 
+/**
+ * Tests whether a player may move pieces to any empty position.
+ *
+ * This is only ever true when the game was built with the flying
+ * rule.
+ * @param state the game state to use
+ * @param player the player to test
+ * @return @a true if @a player is in the movement phase with exactly
+ * #FLYING_PIECES pieces left, @a false otherwise
+ */
+bool
+can_fly (GameState *state, Player player)
+{
+  return FLYING_RULE && state->setup_rounds_left == 0 &&
+    state->player_pieces[player-1] == FLYING_PIECES;
+}
+
+/**
+ * Find the positions of all of a player's pieces.
+ *
+ * @param state the game state to use
+ * @param player the player whose pieces to find, or #EMPTY for the
+ * empty positions
+ * @return a bit set with bit @a n set if position @a n holds @a
+ * player
+ */
+guint32
+player_positions (GameState *state, Player player)
+{
+#ifdef USE_PACKED
+  guint64 board, lo, hi, bits;
+  memcpy (&board, state->board, sizeof (board));
+  board = GUINT64_FROM_LE (board);
+  lo = board & G_GUINT64_CONSTANT (0x555555555555);
+  hi = (board >> 1) & G_GUINT64_CONSTANT (0x555555555555);
+  switch (player)
+    {
+    case PLAYER1: bits = lo & ~hi; break;
+    case PLAYER2: bits = hi & ~lo; break;
+    default: bits = ~(lo | hi) & G_GUINT64_CONSTANT (0x555555555555); break;
+    }
+  /* Gather every second bit into the low 24 bits.  */
+  bits = (bits | bits >> 1) & G_GUINT64_CONSTANT (0x333333333333);
+  bits = (bits | bits >> 2) & G_GUINT64_CONSTANT (0x0f0f0f0f0f0f);
+  bits = (bits | bits >> 4) & G_GUINT64_CONSTANT (0x00ff00ff00ff);
+  bits = (bits | bits >> 8) & G_GUINT64_CONSTANT (0x0000ffff0000ffff);
+  bits = (bits | bits >> 16) & G_GUINT64_CONSTANT (0xffffff);
+  return (guint32) bits;
+#else
+  return simd_match_bytes (simd_load (state->board), player)
+    & ((1 << BOARD_SIZE) - 1);
+#endif
+}
+
+/**
+ * Find the empty positions that the current player can move a piece
+ * to, assuming that pieces may only move to adjacent positions unless
+ * the player can fly.
+ *
+ * @param state the game state to use
+ * @return a bit set with bit @a n set if position @a n is empty and
+ * adjacent to one of the current player's pieces, or every empty
+ * position if the current player can fly
+ */
+guint32
+empty_neighbors (GameState *state)
+{
+  guint32 pieces = player_positions (state, state->cur_player);
+  guint32 neighbors = 0;
+  if (can_fly (state, state->cur_player))
+    return player_positions (state, EMPTY);
+  while (pieces != 0)
+    {
+      neighbors |= neighbor_mask[__builtin_ctz (pieces)];
+      pieces &= pieces - 1;
+    }
+  return neighbors & player_positions (state, EMPTY);
+}
+
+/**
+ * Count the moves that a player has in the movement phase.
+ *
+ * @param state the game state to use
+ * @param player the player whose moves to count
+ * @return the number of ways @a player can move a piece to an
+ * adjacent empty position, or to any empty position if @a player can
+ * fly
+ */
+guint
+count_mobility (GameState *state, Player player)
+{
+  guint32 pieces = player_positions (state, player);
+  guint32 empty = player_positions (state, EMPTY);
+  guint count = 0;
+  if (can_fly (state, player))
+    return __builtin_popcount (pieces) * __builtin_popcount (empty);
+  while (pieces != 0)
+    {
+      count += __builtin_popcount (neighbor_mask[__builtin_ctz (pieces)]
+				   & empty);
+      pieces &= pieces - 1;
+    }
+  return count;
+}
+
 /**
  * Checks if a piece can be removed by testing it against mill masks.
  *
@@ -283,11 +317,11 @@ is_valid_move (GameState *state, guchar src, guchar dest)
 bool
 is_valid_remove (GameState *state, guchar pos)
 {
-  v8uc test_board; /* For intermediate calculations */
+  SimdBoard board, test_board;
   /* Accumulation (logical OR) of all applicable mill masks.  */
-  v8uc cur_mills_mask;
-  guchar (*plyr_mill_masks)[MASK_SIZE];
-  guchar *plyr_mask;
+  SimdBoard cur_mills_mask;
+  const guchar (*plyr_mill_masks)[MASK_SIZE];
+  const guchar *plyr_mask;
   guchar i;
 
   {
@@ -297,43 +331,36 @@ is_valid_remove (GameState *state, guchar pos)
       return false;
   }
 
-#ifndef USE_PACKED
-  test_board = (v8uc) alloca (MASK_SIZE);
-  cur_mills_mask = (v8uc) alloca (MASK_SIZE);
-  memset (BOARD_QUAD (test_board), 0, MASK_SIZE);
-#endif
-
   /* Get the masks for the opposite player.  */
   plyr_mill_masks = opp_plyr_mill_choices[state->cur_player];
   plyr_mask =       opp_plyr_mask_choices[state->cur_player];
 
   /* Tag off all opponent pieces that are in mills, accumulating all
      formed mills to a mill mask.  */
-  memset (BOARD_QUAD (cur_mills_mask), 0, MASK_SIZE);
+  board = simd_load (state->board);
+  cur_mills_mask = simd_zero ();
   for (i = 0; i < TOTAL_MILLS; i++)
     {
-      test_board = simd_and (test_board, SIMD_ARRAY (state->board),
-			     SIMD_ARRAY (plyr_mill_masks[i]));
-      if (!memcmp (BOARD_QUAD (test_board), plyr_mill_masks[i], MASK_SIZE))
-	{
-	  cur_mills_mask = simd_or (cur_mills_mask, cur_mills_mask,
-				    SIMD_ARRAY (plyr_mill_masks[i]));
-	}
+      SimdBoard mill_mask = simd_load (plyr_mill_masks[i]);
+      if (simd_covers (board, mill_mask))
+	cur_mills_mask = simd_or (cur_mills_mask, mill_mask);
     }
 
   /* Mask off all opponent pieces in mills.  */
-  test_board = simd_and (test_board,
-			 simd_not (test_board, cur_mills_mask),
-			 SIMD_ARRAY (state->board));
+  test_board = simd_andnot (cur_mills_mask, board);
   /* Mask off the current player's pieces too.  */
-  test_board = simd_and (test_board, test_board, SIMD_ARRAY (plyr_mask));
-  /* print_board (BOARD_QUAD (test_board)); */
+  test_board = simd_and (test_board, simd_load (plyr_mask));
   /* If all opponent pieces are in mills, then always return true.  */
-  if (!memcmp (BOARD_QUAD (test_board), null_mask, MASK_SIZE))
+  if (simd_is_zero (test_board))
     return true;
   /* Otherwise, return false if the position is in a mill.  */
-  else if (board_ref (BOARD_QUAD (cur_mills_mask), pos) != 0)
-    return false;
+  else
+    {
+      BoardQuad mills[MASK_SIZE];
+      simd_store (mills, cur_mills_mask);
+      if (board_ref (mills, pos) != 0)
+	return false;
+    }
   return true;
 }
 
@@ -348,44 +375,25 @@ is_valid_remove (GameState *state, guchar pos)
 bool
 is_mill_formed (GameState *state, guchar pos)
 {
-  v8uc test_board; /* For intermediate calculations */
-  /* Accumulation (logical OR) of all applicable mill masks.  */
-  v8uc cur_mills_mask;
-  guchar (*plyr_mill_masks)[MASK_SIZE];
-  guchar *plyr_mask;
+  SimdBoard board;
+  const guchar (*plyr_mill_masks)[MASK_SIZE];
   guchar i;
 
   if (board_ref (state->board, pos) != state->cur_player)
     return false;
 
-#ifndef USE_PACKED
-  test_board = (v8uc) alloca (MASK_SIZE);
-  cur_mills_mask = (v8uc) alloca (MASK_SIZE);
-  memset (BOARD_QUAD (test_board), 0, MASK_SIZE);
-#endif
-
   /* Get the masks for the current player.  */
   plyr_mill_masks = plyr_mill_choices[state->cur_player];
-  plyr_mask =       plyr_mask_choices[state->cur_player];
 
-  /* Tag off the mills that the piece is in.  */
-  memset (BOARD_QUAD (cur_mills_mask), 0, MASK_SIZE);
+  /* Test if any of the mills that the piece is in are formed.  */
+  board = simd_load (state->board);
   for (i = 0; i < 3; i++)
     {
-      guchar *plyr_mill_mask;
+      const guchar *plyr_mill_mask;
       plyr_mill_mask = plyr_mill_masks[mill_from_pos[pos*3+i]];
-      test_board = simd_and (test_board, SIMD_ARRAY (state->board),
-			     SIMD_ARRAY (plyr_mill_mask));
-      if (!memcmp (BOARD_QUAD (test_board), plyr_mill_mask, MASK_SIZE))
-	{
-	  cur_mills_mask = simd_or (cur_mills_mask, cur_mills_mask,
-				    SIMD_ARRAY (plyr_mill_mask));
-	}
+      if (simd_covers (board, simd_load (plyr_mill_mask)))
+	return true;
     }
-
-  /* Test if the placed piece is in a mill.  */
-  if (board_ref (BOARD_QUAD (cur_mills_mask), pos) != 0)
-    return true;
   return false;
 }
 
@@ -523,8 +531,235 @@ void
 init_game_state (GameState *state)
 {
   state->cur_player = PLAYER1;
-  state->setup_rounds_left = 11;
+  state->setup_rounds_left = NUM_MEN;
   state->remove_state = false;
   memset (state->player_pieces, 0, NUM_PLAYERS);
   memset (state->board, 0, MASK_SIZE);
 }
+
+/********************************************************************/
+/* Move generation and state packing for the simulator  */
+
+/**
+ * Generate all legal moves for the current player.
+ *
+ * No moves are generated once the game has been won.
+ *
+ * @param state the game state to use
+ * @param moves an array of at least #MAX_MOVES elements that receives
+ * the generated moves
+ * @return the number of moves generated
+ */
+guint
+gen_moves (GameState *state, Move *moves)
+{
+  guint num_moves = 0;
+  guchar pos;
+
+  if (state->setup_rounds_left == 0 && get_winner (state) != EMPTY)
+    return 0;
+
+  if (state->remove_state)
+    {
+      for (pos = 0; pos < BOARD_SIZE; pos++)
+	{
+	  if (is_valid_remove (state, pos))
+	    {
+	      moves[num_moves].type = MOVE_REMOVE;
+	      moves[num_moves].dest = pos;
+	      num_moves++;
+	    }
+	}
+    }
+  else if (state->setup_rounds_left > 0)
+    {
+      for (pos = 0; pos < BOARD_SIZE; pos++)
+	{
+	  if (is_valid_place (state, pos))
+	    {
+	      moves[num_moves].type = MOVE_PLACE;
+	      moves[num_moves].dest = pos;
+	      num_moves++;
+	    }
+	}
+    }
+  else
+    {
+      guint32 pieces = player_positions (state, state->cur_player);
+      guint32 empty = player_positions (state, EMPTY);
+      /* A flying player may move every piece to every empty
+	 position, so there is no need to consult the neighbors.  */
+      bool flying = can_fly (state, state->cur_player);
+      while (pieces != 0)
+	{
+	  guint32 dests;
+	  pos = __builtin_ctz (pieces);
+	  pieces &= pieces - 1;
+	  dests = flying ? empty : neighbor_mask[pos] & empty;
+	  while (dests != 0)
+	    {
+	      moves[num_moves].type = MOVE_MOVE;
+	      moves[num_moves].src = pos;
+	      moves[num_moves].dest = __builtin_ctz (dests);
+	      num_moves++;
+	      dests &= dests - 1;
+	    }
+	}
+    }
+  return num_moves;
+}
+
+/**
+ * Play a move, including the bookkeeping between turns.
+ *
+ * Unlike place_piece(), this function also counts down
+ * GameState::setup_rounds_left once both players have finished their
+ * turn, just like the user interfaces do.
+ *
+ * @param state the game state to use
+ * @param move the move to play
+ * @return @a true if the move was legal and was played, @a false
+ * otherwise
+ */
+bool
+play_move (GameState *state, Move *move)
+{
+  bool played;
+  switch (move->type)
+    {
+    case MOVE_PLACE:
+      played = place_piece (state, move->dest);
+      break;
+    case MOVE_MOVE:
+      played = move_piece (state, move->src, move->dest);
+      break;
+    case MOVE_REMOVE:
+      played = remove_piece (state, move->dest);
+      break;
+    default:
+      return false;
+    }
+  if (played && state->setup_rounds_left > 0 && !state->remove_state &&
+      state->cur_player == PLAYER1)
+    state->setup_rounds_left--;
+  return played;
+}
+
+/**
+ * Pack a game state into a ::StateKey.
+ *
+ * @param state the game state to pack
+ * @return the packed game state
+ */
+StateKey
+pack_state (GameState *state)
+{
+  StateKey key = 0;
+  guchar i;
+#ifdef USE_PACKED
+  /* The packed board already is in key order.  */
+  for (i = 0; i < BOARD_SIZE / 4; i++)
+    key |= (StateKey) ((guchar *) state->board)[i] << (i * 8);
+#else
+  for (i = 0; i < BOARD_SIZE; i++)
+    key |= (StateKey) board_ref (state->board, i) << (i * 2);
+#endif
+  key |= (StateKey) state->setup_rounds_left << 48;
+  key |= (StateKey) (state->remove_state ? 1 : 0) << 52;
+  key |= (StateKey) (state->cur_player == PLAYER2 ? 1 : 0) << 53;
+  return key;
+}
+
+/**
+ * Check whether a ::StateKey from outside the program can be unpacked.
+ *
+ * The key must only use the bits that pack_state() writes, every
+ * place must be empty or hold a piece of either player, and neither
+ * player may have more pieces than they could have placed so far.
+ * Whether the position can actually be reached is not checked.
+ *
+ * @param key the packed game state
+ * @return @a true if @a key describes a possible game state
+ */
+bool
+is_valid_state_key (StateKey key)
+{
+  guint setup_rounds_left = (key >> 48) & 0x0f;
+  bool remove_state = (key >> 52) & 0x01;
+  bool player2_turn = (key >> 53) & 0x01;
+  guint pieces[NUM_PLAYERS] = { 0, 0 };
+  guint placed1, placed2;
+  guchar i;
+
+  if ((key >> 54) != 0 || setup_rounds_left > NUM_MEN)
+    return false;
+  for (i = 0; i < BOARD_SIZE; i++)
+    {
+      Player player = (key >> (i * 2)) & 0x03;
+      if (player == 0x03)
+	return false;
+      if (player != EMPTY)
+	pieces[player-1]++;
+    }
+  /* Player 1 has placed a piece in the current round once it is
+     player 2's turn, or while player 1 removes a piece.  Player 2 has
+     only done so while removing a piece.  */
+  placed1 = NUM_MEN - setup_rounds_left;
+  placed2 = placed1;
+  if (setup_rounds_left > 0)
+    {
+      placed1 += (player2_turn || remove_state) ? 1 : 0;
+      placed2 += (player2_turn && remove_state) ? 1 : 0;
+    }
+  return pieces[0] <= placed1 && pieces[1] <= placed2;
+}
+
+/**
+ * Unpack a ::StateKey into a game state.
+ *
+ * Places with the unused code 0x03 are left empty.  Keys from outside
+ * the program should be checked with is_valid_state_key() first.
+ *
+ * @param key the packed game state
+ * @param state the game state to fill in
+ */
+void
+unpack_state (StateKey key, GameState *state)
+{
+  guchar i;
+  memset (state->player_pieces, 0, NUM_PLAYERS);
+  memset (state->board, 0, MASK_SIZE);
+  for (i = 0; i < BOARD_SIZE; i++)
+    {
+      Player player = (key >> (i * 2)) & 0x03;
+      if (player == PLAYER1 || player == PLAYER2)
+	{
+	  set_board_pos (state->board, i, player);
+	  state->player_pieces[player-1]++;
+	}
+    }
+  state->setup_rounds_left = (key >> 48) & 0x0f;
+  state->remove_state = (key >> 52) & 0x01;
+  state->cur_player = ((key >> 53) & 0x01) ? PLAYER2 : PLAYER1;
+}
+
+/**
+ * Hash a ::StateKey.
+ *
+ * Keys of nearby game states differ in only a few bits, so they must
+ * be mixed before they can be used to spread states evenly across
+ * hash tables or simulator workers.
+ *
+ * @param key the packed game state
+ * @return a well-mixed 64-bit hash of @a key
+ */
+guint64
+hash_state_key (StateKey key)
+{
+  key ^= key >> 33;
+  key *= G_GUINT64_CONSTANT (0xff51afd7ed558ccd);
+  key ^= key >> 33;
+  key *= G_GUINT64_CONSTANT (0xc4ceb9fe1a85ec53);
+  key ^= key >> 33;
+  return key;
+}
@@ -34,7 +34,48 @@ enum Player_tag { EMPTY, PLAYER1, PLAYER2 };
 typedef guchar Player;
 
 #define BOARD_SIZE 24
-#define TOTAL_MILLS 20
+
+/*
+ * The game variant is chosen when the program is configured, with
+ * --with-variant, which defines MORRIS_VARIANT to the number of men.
+ * Every variant is played on the same 24 places, but only 11 and 12
+ * Mens Morris have the diagonal lines in the corners.  The rules code
+ * and the tables in tables-gen.h are compiled for a single variant,
+ * so that all of these are constants.
+ */
+#ifndef MORRIS_VARIANT
+#  define MORRIS_VARIANT 11
+#endif
+
+#if MORRIS_VARIANT == 9
+#  define VARIANT_NAME "9 Mens Morris"
+#  define HAVE_DIAGONALS 0
+#  define TOTAL_MILLS 16
+#elif MORRIS_VARIANT == 11
+#  define VARIANT_NAME "11 Mens Morris"
+#  define HAVE_DIAGONALS 1
+#  define TOTAL_MILLS 20
+#elif MORRIS_VARIANT == 12
+#  define VARIANT_NAME "12 Mens Morris"
+#  define HAVE_DIAGONALS 1
+#  define TOTAL_MILLS 20
+#else
+#  error "MORRIS_VARIANT must be 9, 11 or 12"
+#endif
+/** The number of pieces that each player places during setup.  */
+#define NUM_MEN MORRIS_VARIANT
+
+/**
+ * Whether the flying rule is in effect, as chosen with configure's
+ * --enable-flying.  Under this rule, a player who is down to
+ * #FLYING_PIECES pieces in the movement phase may move a piece to any
+ * empty position rather than only to an adjacent one.
+ */
+#ifndef FLYING_RULE
+#  define FLYING_RULE 0
+#endif
+/** The number of pieces at which a player starts flying.  */
+#define FLYING_PIECES 3
 
 #ifdef USE_PACKED
 
@@ -80,12 +121,44 @@ struct GameState_tag
 };
 typedef struct GameState_tag GameState;
 
+/**
+ * A game state packed into a single integer.
+ *
+ * Bits 0 through 47 hold the board, two bits per position in the same
+ * order as the packed ::BoardQuad layout.  Bits 48 through 51 hold
+ * GameState::setup_rounds_left, bit 52 holds GameState::remove_state,
+ * and bit 53 is set when it is player 2's turn.  The piece counts are
+ * not stored, as they can be recomputed from the board.  Because the
+ * packing is canonical, two game states are equivalent exactly when
+ * their keys are equal, and sorting keys gives the ordering of the
+ * sorted heap described in morris-sim.c.
+ */
+typedef guint64 StateKey;
+
+enum MoveType_tag { MOVE_PLACE, MOVE_MOVE, MOVE_REMOVE };
+
+/** A single player action: placing, moving, or removing a piece.  */
+struct Move_tag
+{
+  guchar type; /**< One of ::MoveType_tag */
+  guchar src;  /**< Position moved from, only used by ::MOVE_MOVE */
+  guchar dest; /**< Position placed at, moved to, or removed from */
+};
+typedef struct Move_tag Move;
+
+/** An upper bound on the number of legal moves in any game state.  */
+#define MAX_MOVES (BOARD_SIZE * 4)
+
 inline Player board_ref (BoardQuad *board, guchar index);
 inline void set_board_pos (BoardQuad *board, guchar index, guchar value);
 inline Player get_opponent (GameState *state);
 inline bool are_adjacent (guchar pos1, guchar pos2);
 inline bool is_valid_place (GameState *state, guchar pos);
 inline bool is_valid_move (GameState *state, guchar src, guchar dest);
+bool can_fly (GameState *state, Player player);
+guint32 player_positions (GameState *state, Player player);
+guint32 empty_neighbors (GameState *state);
+guint count_mobility (GameState *state, Player player);
 inline bool is_valid_remove (GameState *state, guchar pos);
 bool is_mill_formed (GameState *state, guchar pos);
 void next_player (GameState *state);
@@ -94,5 +167,11 @@ bool move_piece (GameState *state, guchar src, guchar dest);
 bool remove_piece (GameState *state, guchar pos);
 guchar get_winner (GameState *state);
 void init_game_state (GameState *state);
+guint gen_moves (GameState *state, Move *moves);
+bool play_move (GameState *state, Move *move);
+StateKey pack_state (GameState *state);
+bool is_valid_state_key (StateKey key);
+void unpack_state (StateKey key, GameState *state);
+guint64 hash_state_key (StateKey key);
 
 #endif /* not MORRIS_H */
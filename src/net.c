@@ -0,0 +1,149 @@
+/* Socket helpers shared by the network programs.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Socket helpers shared by the network programs.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#ifndef G_OS_WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
+#include "net.h"
+
+#ifndef G_OS_WIN32
+
+/**
+ * Open a listening or a connected socket.
+ *
+ * Addresses that contain a colon but no slash are TCP "host:port"
+ * addresses, where an empty host listens on every interface, and
+ * everything else is a Unix socket path.  A listening Unix socket
+ * replaces any file at its path.
+ *
+ * @param address the address to listen on or connect to
+ * @param listening whether to listen rather than connect
+ * @return the socket, or -1 on error
+ */
+int
+net_socket (const gchar *address, bool listening)
+{
+  const char *colon = strrchr (address, ':');
+  int fd = -1;
+
+  if (colon != NULL && strchr (address, '/') == NULL)
+    {
+      struct addrinfo hints, *res, *ai;
+      gchar *host;
+      host = g_strndup (address, colon - address);
+      memset (&hints, 0, sizeof (hints));
+      hints.ai_family = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      if (listening)
+	hints.ai_flags = AI_PASSIVE;
+      if (getaddrinfo (*host ? host : NULL, colon + 1, &hints, &res) != 0)
+	{
+	  g_free (host);
+	  return -1;
+	}
+      g_free (host);
+      for (ai = res; ai != NULL; ai = ai->ai_next)
+	{
+	  int one = 1;
+	  fd = socket (ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+	  if (fd < 0)
+	    continue;
+	  if (listening)
+	    {
+	      setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof (one));
+	      if (bind (fd, ai->ai_addr, ai->ai_addrlen) == 0 &&
+		  listen (fd, 128) == 0)
+		break;
+	    }
+	  else if (connect (fd, ai->ai_addr, ai->ai_addrlen) == 0)
+	    break;
+	  close (fd);
+	  fd = -1;
+	}
+      freeaddrinfo (res);
+    }
+  else
+    {
+      struct sockaddr_un sa;
+      if (strlen (address) >= sizeof (sa.sun_path))
+	return -1;
+      memset (&sa, 0, sizeof (sa));
+      sa.sun_family = AF_UNIX;
+      strcpy (sa.sun_path, address);
+      fd = socket (AF_UNIX, SOCK_STREAM, 0);
+      if (fd < 0)
+	return -1;
+      if (listening)
+	{
+	  g_unlink (address);
+	  if (bind (fd, (struct sockaddr *) &sa, sizeof (sa)) == 0 &&
+	      listen (fd, 128) == 0)
+	    return fd;
+	}
+      else if (connect (fd, (struct sockaddr *) &sa, sizeof (sa)) == 0)
+	return fd;
+      close (fd);
+      fd = -1;
+    }
+  return fd;
+}
+
+/**
+ * Make a socket non-blocking and turn off Nagle's algorithm, so that
+ * short messages are sent at once.
+ *
+ * @param fd the socket
+ */
+void
+net_set_nonblocking (int fd)
+{
+  int flag = 1;
+  fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_NONBLOCK);
+  /* This fails harmlessly on Unix sockets.  */
+  setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof (flag));
+}
+
+#endif /* not G_OS_WIN32 */
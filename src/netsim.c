@@ -0,0 +1,1204 @@
+/* Distributed simulation over sockets.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Distributed simulation over sockets.
+ *
+ * This is the multi-process design sketched at the end of the
+ * comment in morris-sim.c, except that no single server owns the
+ * sorted heap of game states.  Every game state is instead owned by
+ * exactly one worker, chosen by the high bits of the hash of its
+ * ::StateKey, and each worker keeps the level files and the visited
+ * file of its own partition on its own disk, using the same external
+ * memory machinery as the single process simulator (see frontier.c).
+ * No process ever holds the full set of game states, and nothing is
+ * shared between the workers.
+ *
+ * The workers are connected to each other in a full mesh.  When a
+ * worker expands its part of a level, children that it owns go
+ * straight into its run buffer, while the others are collected into
+ * one batch per owner and sent directly to that worker once the batch
+ * is full.  After a worker has expanded its whole level, it sends its
+ * remaining batches followed by an end of level marker to every peer.
+ * Since every connection delivers messages in order, a worker has
+ * received all of its new states once it has seen a marker from
+ * every peer, and it can merge its new level right away.
+ *
+ * The coordinator only keeps the workers in step.  It hands out the
+ * partitions and the peer addresses, starts each level, and waits for
+ * every worker to report its merged level.  No game states pass
+ * through it, so adding workers adds throughput.
+ *
+ * Messages consist of a 16-byte header followed by an array of 64-bit
+ * words.  A batch holds thousands of keys, so the header overhead per
+ * game state is negligible.  Words are sent in host byte order; the
+ * handshakes check that all processes agree on it.
+ *
+ * All sockets are non-blocking and every process keeps reading while
+ * it writes, so that two processes can never wait on each other with
+ * full socket buffers.  A worker stops generating new states while
+ * any of its output queues is long.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#ifndef G_OS_WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#endif
+
+#include "morris.h"
+#include "frontier.h"
+#include "kernels.h"
+#include "net.h"
+#include "netsim.h"
+
+#ifndef G_OS_WIN32
+
+/** Handshake value that also detects a byte order mismatch.  */
+#define NETSIM_MAGIC G_GUINT64_CONSTANT (0x4d4f525249534d31)
+/** Number of keys in a full batch of states.  */
+#define BATCH_KEYS 8192
+/** Output queue length at which a process stops producing.  */
+#define MAX_PENDING (4 * 1024 * 1024)
+/** Number of keys that a worker expands between socket checks.  */
+#define EXPAND_BLOCK_SIZE 1024
+/** Number of keys that are handed to the expansion kernel at once.  */
+#define EXPAND_CHUNK 16
+
+enum NetMsgType_tag
+{
+  MSG_HELLO = 1, /**< Worker greeting; payload: magic, peer address */
+  MSG_ASSIGN,    /**< arg: partition number; payload: partition count */
+  MSG_PEER,      /**< arg: partition number; payload: peer address */
+  MSG_PEER_HELLO, /**< arg: partition number; payload: magic */
+  MSG_READY,     /**< The worker is connected to all of its peers */
+  MSG_EXPAND,    /**< Expand the level */
+  MSG_STATES,    /**< payload: keys for the level after the given one */
+  MSG_END_LEVEL, /**< arg: partition that finished expanding */
+  MSG_MERGED,    /**< payload: states expanded, wins of each player,
+		    and new states, or G_MAXUINT64 on error */
+  MSG_QUIT
+};
+
+struct NetMsgHeader_tag
+{
+  guint32 type;
+  guint32 arg;
+  guint32 count; /**< Number of 64-bit payload words */
+  guint32 level; /**< Breadth-first search level */
+};
+typedef struct NetMsgHeader_tag NetMsgHeader;
+
+/** A non-blocking message connection.  */
+struct NetConn_tag
+{
+  int fd;
+  guchar *in_buf;
+  gsize in_pos, in_len, in_cap;
+  guchar *out_buf;
+  gsize out_pos, out_len, out_cap;
+};
+typedef struct NetConn_tag NetConn;
+
+/********************************************************************/
+/* Connections  */
+
+static NetConn *
+conn_new (int fd)
+{
+  NetConn *conn;
+  net_set_nonblocking (fd);
+  conn = g_new0 (NetConn, 1);
+  conn->fd = fd;
+  conn->in_cap = 256 * 1024;
+  conn->in_buf = g_malloc (conn->in_cap);
+  conn->out_cap = 256 * 1024;
+  conn->out_buf = g_malloc (conn->out_cap);
+  return conn;
+}
+
+static void
+conn_free (NetConn *conn)
+{
+  close (conn->fd);
+  g_free (conn->in_buf);
+  g_free (conn->out_buf);
+  g_free (conn);
+}
+
+static gsize
+conn_pending (NetConn *conn)
+{
+  return conn->out_len - conn->out_pos;
+}
+
+/* Append a message to the output queue.  */
+static void
+conn_queue (NetConn *conn, guint32 type, guint32 arg, guint32 level,
+	    const guint64 *payload, guint32 count)
+{
+  NetMsgHeader header;
+  gsize size = sizeof (header) + count * sizeof (guint64);
+
+  if (conn->out_pos > 0)
+    {
+      memmove (conn->out_buf, conn->out_buf + conn->out_pos,
+	       conn->out_len - conn->out_pos);
+      conn->out_len -= conn->out_pos;
+      conn->out_pos = 0;
+    }
+  if (conn->out_len + size > conn->out_cap)
+    {
+      while (conn->out_len + size > conn->out_cap)
+	conn->out_cap *= 2;
+      conn->out_buf = g_realloc (conn->out_buf, conn->out_cap);
+    }
+
+  header.type = type;
+  header.arg = arg;
+  header.count = count;
+  header.level = level;
+  memcpy (conn->out_buf + conn->out_len, &header, sizeof (header));
+  if (count > 0)
+    memcpy (conn->out_buf + conn->out_len + sizeof (header), payload,
+	    count * sizeof (guint64));
+  conn->out_len += size;
+}
+
+/* Write as much of the output queue as the socket accepts.  */
+static bool
+conn_flush (NetConn *conn)
+{
+  while (conn->out_pos < conn->out_len)
+    {
+      ssize_t written;
+      written = write (conn->fd, conn->out_buf + conn->out_pos,
+		       conn->out_len - conn->out_pos);
+      if (written < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return (errno == EAGAIN || errno == EWOULDBLOCK);
+	}
+      conn->out_pos += written;
+    }
+  conn->out_pos = conn->out_len = 0;
+  return true;
+}
+
+/* Read everything that has arrived on the socket.  Returns false once
+   the peer has closed the connection.  */
+static bool
+conn_fill (NetConn *conn)
+{
+  if (conn->in_pos > 0)
+    {
+      memmove (conn->in_buf, conn->in_buf + conn->in_pos,
+	       conn->in_len - conn->in_pos);
+      conn->in_len -= conn->in_pos;
+      conn->in_pos = 0;
+    }
+  while (1)
+    {
+      ssize_t num_read;
+      if (conn->in_cap - conn->in_len < 64 * 1024)
+	{
+	  conn->in_cap *= 2;
+	  conn->in_buf = g_realloc (conn->in_buf, conn->in_cap);
+	}
+      num_read = read (conn->fd, conn->in_buf + conn->in_len,
+		       conn->in_cap - conn->in_len);
+      if (num_read < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return (errno == EAGAIN || errno == EWOULDBLOCK);
+	}
+      if (num_read == 0)
+	return false;
+      conn->in_len += num_read;
+    }
+}
+
+/* Get the next complete message without copying it.  The payload
+   stays valid until the next call to conn_fill().  */
+static bool
+conn_next (NetConn *conn, NetMsgHeader *header, guint64 **payload)
+{
+  gsize size;
+  if (conn->in_len - conn->in_pos < sizeof (NetMsgHeader))
+    return false;
+  memcpy (header, conn->in_buf + conn->in_pos, sizeof (NetMsgHeader));
+  size = sizeof (NetMsgHeader) + (gsize) header->count * sizeof (guint64);
+  if (conn->in_len - conn->in_pos < size)
+    return false;
+  /* Every message is a multiple of eight bytes long, so the payload
+     is always suitably aligned.  */
+  *payload = (guint64 *) (conn->in_buf + conn->in_pos +
+			  sizeof (NetMsgHeader));
+  conn->in_pos += size;
+  return true;
+}
+
+/* Block until a message arrives, flushing output in the meantime.  */
+static bool
+conn_wait (NetConn *conn, NetMsgHeader *header, guint64 **payload)
+{
+  while (!conn_next (conn, header, payload))
+    {
+      struct pollfd pfd;
+      pfd.fd = conn->fd;
+      pfd.events = POLLIN | (conn_pending (conn) ? POLLOUT : 0);
+      if (poll (&pfd, 1, -1) < 0 && errno != EINTR)
+	return false;
+      if (!conn_flush (conn) || !conn_fill (conn))
+	return false;
+    }
+  return true;
+}
+
+/* Queue a message whose payload is a string, padded with zeros to a
+   whole number of words.  */
+static void
+conn_queue_string (NetConn *conn, guint32 type, guint32 arg,
+		   guint64 first_word, const gchar *string)
+{
+  gsize len = strlen (string);
+  guint32 count = 1 + (len + sizeof (guint64)) / sizeof (guint64);
+  guint64 *payload = g_new0 (guint64, count);
+  payload[0] = first_word;
+  memcpy (payload + 1, string, len);
+  conn_queue (conn, type, arg, 0, payload, count);
+  g_free (payload);
+}
+
+/* Get the string that follows the first word of a payload.  */
+static gchar *
+payload_string (NetMsgHeader *header, guint64 *payload)
+{
+  if (header->count < 2)
+    return g_strdup ("");
+  return g_strndup ((gchar *) (payload + 1),
+		    (header->count - 1) * sizeof (guint64));
+}
+
+/********************************************************************/
+/* Workers  */
+
+struct NetWorker_tag
+{
+  NetSimConfig *config;
+  NetConn *coord;
+  guint part;
+  guint num_parts;
+  NetConn **peers; /**< Connections by partition, NULL for this one */
+  int peer_fd; /**< Socket that the peers connect to */
+  gchar *peer_address;
+  gchar *unix_path; /**< Unix socket to delete on exit, if any */
+  gchar *dir;
+  /* Children owned by this partition, waiting to be written as a
+     run.  */
+  StateKey *children;
+  StateKey *scratch;
+  gsize capacity;
+  gsize num_children;
+  /* Children owned by other partitions, waiting to be sent.  */
+  StateKey *batches;
+  guint *batch_len;
+  RunSet *runs;
+  KeyStream *level;
+  /** The level that is expanded, or whose children are collected in
+      NetWorker::runs.  */
+  guint level_num;
+  bool expanding;
+  /** Whether this worker has expanded all of NetWorker::level_num.  */
+  bool level_expanded;
+  guint ends_received;
+  guint64 expanded;
+  guint64 wins[NUM_PLAYERS];
+  bool failed;
+};
+typedef struct NetWorker_tag NetWorker;
+
+/* Map the high 32 bits of the hash of a key onto a partition number.
+   Unlike a modulo, this keeps the low bits of the hash free for hash
+   tables within a partition.  */
+static guint
+partition_of_hash (guint64 hash, guint num_parts)
+{
+  return ((hash >> 32) * num_parts) >> 32;
+}
+
+static guint
+partition_of (StateKey key, guint num_parts)
+{
+  return partition_of_hash (hash_state_key (key), num_parts);
+}
+
+/* Make sure that there is a run set for the level whose children are
+   arriving.  Peers may send states before the coordinator's request
+   to expand the level has reached this worker.  No peer can get to
+   the next level before this worker has merged, so a message for any
+   other level than the one being collected is an error.  */
+static bool
+worker_ensure_runs (NetWorker *worker, guint level)
+{
+  gchar *name, *prefix;
+  if (worker->runs != NULL)
+    {
+      if (level == worker->level_num)
+	return true;
+      g_printerr ("morris-sim: got a message for level %u while "
+		  "collecting level %u\n", level, worker->level_num);
+      return false;
+    }
+  name = g_strdup_printf ("run-%04u", level);
+  prefix = g_build_filename (worker->dir, name, NULL);
+  worker->runs = run_set_new (prefix);
+  worker->level_num = level;
+  g_free (name);
+  g_free (prefix);
+  return true;
+}
+
+static void
+worker_add_child (NetWorker *worker, StateKey key)
+{
+  if (worker->num_children >= worker->capacity)
+    {
+      if (!run_set_add (worker->runs, worker->children, worker->scratch,
+			worker->num_children))
+	worker->failed = true;
+      worker->num_children = 0;
+    }
+  worker->children[worker->num_children++] = key;
+}
+
+static void
+worker_send_batch (NetWorker *worker, guint dest)
+{
+  if (worker->batch_len[dest] == 0)
+    return;
+  conn_queue (worker->peers[dest], MSG_STATES, dest, worker->level_num,
+	      worker->batches + (gsize) dest * BATCH_KEYS,
+	      worker->batch_len[dest]);
+  worker->batch_len[dest] = 0;
+}
+
+static void
+worker_route (NetWorker *worker, StateKey key, guint64 hash)
+{
+  guint dest = partition_of_hash (hash, worker->num_parts);
+  if (dest == worker->part)
+    {
+      worker_add_child (worker, key);
+      return;
+    }
+  worker->batches[(gsize) dest * BATCH_KEYS + worker->batch_len[dest]++] =
+    key;
+  if (worker->batch_len[dest] >= BATCH_KEYS)
+    worker_send_batch (worker, dest);
+}
+
+/* Expand the next block of the current level.  */
+static void
+worker_expand_block (NetWorker *worker)
+{
+  StateKey block[EXPAND_BLOCK_SIZE];
+  StateKey children[EXPAND_CHUNK * MAX_MOVES];
+  guint64 hashes[EXPAND_CHUNK * MAX_MOVES];
+  guint num_children[EXPAND_CHUNK];
+  gsize num_keys, i;
+
+  num_keys = key_stream_read (worker->level, block, EXPAND_BLOCK_SIZE);
+  for (i = 0; i < num_keys; i += EXPAND_CHUNK)
+    {
+      gsize count = MIN (EXPAND_CHUNK, num_keys - i);
+      gsize total, j;
+
+      total = kernels->expand_keys (block + i, count, children,
+				    num_children);
+      kernels->hash_keys (children, hashes, total);
+      for (j = 0; j < total; j++)
+	worker_route (worker, children[j], hashes[j]);
+
+      worker->expanded += count;
+      for (j = 0; j < count; j++)
+	{
+	  if (num_children[j] == 0)
+	    {
+	      GameState state;
+	      Player winner;
+	      unpack_state (block[i+j], &state);
+	      winner = get_winner (&state);
+	      if (state.setup_rounds_left == 0 && winner != EMPTY)
+		worker->wins[winner-1]++;
+	    }
+	}
+    }
+
+  if (num_keys == 0)
+    {
+      guint dest;
+      key_stream_close (worker->level);
+      worker->level = NULL;
+      worker->expanding = false;
+      worker->level_expanded = true;
+      for (dest = 0; dest < worker->num_parts; dest++)
+	{
+	  if (dest == worker->part)
+	    continue;
+	  worker_send_batch (worker, dest);
+	  conn_queue (worker->peers[dest], MSG_END_LEVEL, worker->part,
+		      worker->level_num, NULL, 0);
+	}
+    }
+}
+
+/* Open the socket that the peers connect to.  Its address is derived
+   from the coordinator connection, so that it is reachable the same
+   way.  */
+static bool
+worker_listen_peers (NetWorker *worker)
+{
+  const gchar *address = worker->config->address;
+  const char *colon = strrchr (address, ':');
+
+  if (colon == NULL || strchr (address, '/') != NULL)
+    {
+      worker->unix_path = g_strdup_printf ("%s.%d", address, (int) getpid ());
+      worker->peer_address = g_strdup (worker->unix_path);
+      worker->peer_fd = net_socket (worker->unix_path, true);
+    }
+  else
+    {
+      struct sockaddr_storage sa;
+      socklen_t sa_len = sizeof (sa);
+      char host[NI_MAXHOST], port[NI_MAXSERV];
+
+      if (getsockname (worker->coord->fd, (struct sockaddr *) &sa,
+		       &sa_len) < 0)
+	return false;
+      if (sa.ss_family == AF_INET)
+	((struct sockaddr_in *) &sa)->sin_port = 0;
+      else if (sa.ss_family == AF_INET6)
+	((struct sockaddr_in6 *) &sa)->sin6_port = 0;
+      worker->peer_fd = socket (sa.ss_family, SOCK_STREAM, 0);
+      if (worker->peer_fd < 0)
+	return false;
+      if (bind (worker->peer_fd, (struct sockaddr *) &sa, sa_len) < 0 ||
+	  listen (worker->peer_fd, 128) < 0 ||
+	  getsockname (worker->peer_fd, (struct sockaddr *) &sa,
+		       &sa_len) < 0 ||
+	  getnameinfo ((struct sockaddr *) &sa, sa_len, host, sizeof (host),
+		       port, sizeof (port),
+		       NI_NUMERICHOST | NI_NUMERICSERV) != 0)
+	{
+	  close (worker->peer_fd);
+	  worker->peer_fd = -1;
+	}
+      else
+	worker->peer_address = g_strdup_printf ("%s:%s", host, port);
+    }
+  return worker->peer_fd >= 0;
+}
+
+/* Set up this worker's partition once the coordinator has assigned
+   it.  */
+static bool
+worker_start (NetWorker *worker, guint part, guint num_parts)
+{
+  gchar *name, *path;
+  GameState state;
+  StateKey key;
+  gsize count;
+  bool success;
+
+  worker->part = part;
+  worker->num_parts = num_parts;
+  worker->peers = g_new0 (NetConn *, num_parts);
+  name = g_strdup_printf ("part-%03u", part);
+  worker->dir = g_build_filename (worker->config->work_dir, name, NULL);
+  g_free (name);
+  g_mkdir_with_parents (worker->dir, 0755);
+
+  worker->capacity = worker->config->mem_budget / 4 / sizeof (StateKey);
+  if (worker->capacity < MAX_MOVES)
+    worker->capacity = MAX_MOVES;
+  worker->children = g_new (StateKey, worker->capacity);
+  worker->scratch = g_new (StateKey, worker->capacity);
+  worker->batches = g_new (StateKey, (gsize) num_parts * BATCH_KEYS);
+  worker->batch_len = g_new0 (guint, num_parts);
+
+  /* The empty board starts out in the partition that owns it.  */
+  init_game_state (&state);
+  key = pack_state (&state);
+  count = (partition_of (key, num_parts) == part) ? 1 : 0;
+  path = frontier_path (worker->dir, "level", 0);
+  success = write_key_file (path, &key, count);
+  g_free (path);
+  path = frontier_path (worker->dir, "visited", 0);
+  success &= write_key_file (path, &key, count);
+  g_free (path);
+  return success;
+}
+
+/* Connect to the peer with a lower partition number.  */
+static bool
+worker_connect_peer (NetWorker *worker, guint part, const gchar *address)
+{
+  guint64 magic = NETSIM_MAGIC;
+  int fd = net_socket (address, false);
+  if (fd < 0)
+    {
+      g_printerr ("morris-sim: cannot connect to peer %s\n", address);
+      return false;
+    }
+  worker->peers[part] = conn_new (fd);
+  conn_queue (worker->peers[part], MSG_PEER_HELLO, worker->part, 0,
+	      &magic, 1);
+  return true;
+}
+
+/* Accept connections from all peers with higher partition numbers.
+   They have connected already, or will shortly, since every worker
+   connects to its lower numbered peers before accepting.  */
+static bool
+worker_accept_peers (NetWorker *worker)
+{
+  guint num_left = worker->num_parts - worker->part - 1;
+  while (num_left > 0)
+    {
+      NetMsgHeader header;
+      guint64 *payload;
+      NetConn *conn;
+      int fd = accept (worker->peer_fd, NULL, NULL);
+      if (fd < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return false;
+	}
+      conn = conn_new (fd);
+      if (!conn_wait (conn, &header, &payload) ||
+	  header.type != MSG_PEER_HELLO || header.count < 1 ||
+	  payload[0] != NETSIM_MAGIC || header.arg <= worker->part ||
+	  header.arg >= worker->num_parts ||
+	  worker->peers[header.arg] != NULL)
+	{
+	  conn_free (conn);
+	  return false;
+	}
+      worker->peers[header.arg] = conn;
+      num_left--;
+    }
+  return true;
+}
+
+static bool
+worker_begin_level (NetWorker *worker, guint level)
+{
+  gchar *path;
+  if (!worker_ensure_runs (worker, level))
+    return false;
+  path = frontier_path (worker->dir, "level", level);
+  worker->level = key_stream_open (path, worker->config->mem_budget / 16);
+  g_free (path);
+  if (worker->level == NULL)
+    return false;
+  worker->expanding = true;
+  worker->level_expanded = false;
+  worker->expanded = 0;
+  memset (worker->wins, 0, sizeof (worker->wins));
+  return true;
+}
+
+static void
+worker_merge_level (NetWorker *worker)
+{
+  guint level = worker->level_num;
+  gchar *visited_path, *next_path, *new_visited_path;
+  gint64 num_new = -1;
+  guint64 result[2 + NUM_PLAYERS];
+
+  if (worker->num_children > 0 &&
+      !run_set_add (worker->runs, worker->children, worker->scratch,
+		    worker->num_children))
+    worker->failed = true;
+  worker->num_children = 0;
+
+  visited_path = frontier_path (worker->dir, "visited", level);
+  next_path = frontier_path (worker->dir, "level", level + 1);
+  new_visited_path = frontier_path (worker->dir, "visited", level + 1);
+  if (!worker->failed)
+    num_new = run_set_merge (worker->runs, visited_path, next_path,
+			     new_visited_path, worker->config->mem_budget);
+  if (num_new >= 0)
+    g_unlink (visited_path);
+  run_set_free (worker->runs);
+  worker->runs = NULL;
+  worker->level_expanded = false;
+  worker->ends_received = 0;
+  g_free (visited_path);
+  g_free (next_path);
+  g_free (new_visited_path);
+
+  result[0] = worker->expanded;
+  result[1] = worker->wins[0];
+  result[2] = worker->wins[1];
+  result[3] = (num_new >= 0) ? (guint64) num_new : G_MAXUINT64;
+  conn_queue (worker->coord, MSG_MERGED, 0, level, result, 2 + NUM_PLAYERS);
+}
+
+/* Handle one message from the coordinator or a peer.  Returns false
+   when the worker should stop.  */
+static bool
+worker_dispatch (NetWorker *worker, NetMsgHeader *header, guint64 *payload)
+{
+  guint32 i;
+  switch (header->type)
+    {
+    case MSG_EXPAND:
+      if (!worker_begin_level (worker, header->level))
+	worker->failed = true;
+      break;
+    case MSG_STATES:
+      if (!worker_ensure_runs (worker, header->level))
+	worker->failed = true;
+      for (i = 0; i < header->count && !worker->failed; i++)
+	worker_add_child (worker, payload[i]);
+      break;
+    case MSG_END_LEVEL:
+      if (!worker_ensure_runs (worker, header->level))
+	worker->failed = true;
+      worker->ends_received++;
+      break;
+    case MSG_QUIT:
+      return false;
+    }
+  return !worker->failed;
+}
+
+/* Get the partition assignment and the peer addresses from the
+   coordinator, and connect to every peer.  */
+static bool
+worker_join (NetWorker *worker)
+{
+  NetMsgHeader header;
+  guint64 *payload;
+  guint num_peers = 0;
+
+  if (!conn_wait (worker->coord, &header, &payload) ||
+      header.type != MSG_ASSIGN || header.count < 1 ||
+      header.arg >= payload[0] ||
+      !worker_start (worker, header.arg, payload[0]))
+    return false;
+
+  while (num_peers < worker->num_parts)
+    {
+      gchar *address;
+      bool success = true;
+      if (!conn_wait (worker->coord, &header, &payload) ||
+	  header.type != MSG_PEER || header.arg >= worker->num_parts)
+	return false;
+      address = payload_string (&header, payload);
+      if (header.arg < worker->part)
+	success = worker_connect_peer (worker, header.arg, address);
+      g_free (address);
+      if (!success)
+	return false;
+      num_peers++;
+    }
+  if (!worker_accept_peers (worker))
+    return false;
+  close (worker->peer_fd);
+  worker->peer_fd = -1;
+  if (worker->unix_path != NULL)
+    g_unlink (worker->unix_path);
+
+  conn_queue (worker->coord, MSG_READY, worker->part, 0, NULL, 0);
+  return true;
+}
+
+static void
+worker_free (NetWorker *worker)
+{
+  guint i;
+  if (worker->peer_fd >= 0)
+    close (worker->peer_fd);
+  if (worker->unix_path != NULL)
+    g_unlink (worker->unix_path);
+  for (i = 0; i < worker->num_parts; i++)
+    {
+      if (worker->peers[i] != NULL)
+	conn_free (worker->peers[i]);
+    }
+  if (worker->coord != NULL)
+    conn_free (worker->coord);
+  if (worker->level != NULL)
+    key_stream_close (worker->level);
+  if (worker->runs != NULL)
+    run_set_free (worker->runs);
+  g_free (worker->peers);
+  g_free (worker->peer_address);
+  g_free (worker->unix_path);
+  g_free (worker->dir);
+  g_free (worker->children);
+  g_free (worker->scratch);
+  g_free (worker->batches);
+  g_free (worker->batch_len);
+}
+
+/**
+ * Run a simulator worker process.
+ *
+ * The worker connects to the coordinator at the configured address
+ * and serves requests until it is told to quit.
+ *
+ * @param config the worker settings
+ * @return the process exit status
+ */
+int
+netsim_worker_main (NetSimConfig *config)
+{
+  NetWorker worker;
+  struct pollfd *pfds;
+  bool done = false;
+  int fd;
+
+  memset (&worker, 0, sizeof (worker));
+  worker.config = config;
+  worker.peer_fd = -1;
+  fd = net_socket (config->address, false);
+  if (fd < 0)
+    {
+      g_printerr ("morris-sim: cannot connect to %s\n", config->address);
+      return 1;
+    }
+  worker.coord = conn_new (fd);
+  if (!worker_listen_peers (&worker))
+    {
+      g_printerr ("morris-sim: cannot listen for peers\n");
+      worker_free (&worker);
+      return 1;
+    }
+  conn_queue_string (worker.coord, MSG_HELLO, 0, NETSIM_MAGIC,
+		     worker.peer_address);
+  if (!worker_join (&worker))
+    {
+      g_printerr ("morris-sim: cannot join the simulation\n");
+      worker_free (&worker);
+      return 1;
+    }
+
+  /* Entry 0 is the coordinator, and entry i + 1 is peer i.  */
+  pfds = g_new (struct pollfd, worker.num_parts + 1);
+  while (!done && !worker.failed)
+    {
+      bool can_expand = worker.expanding;
+      guint i;
+
+      for (i = 0; i <= worker.num_parts; i++)
+	{
+	  NetConn *conn = (i == 0) ? worker.coord : worker.peers[i-1];
+	  pfds[i].fd = -1;
+	  pfds[i].revents = 0;
+	  if (conn == NULL)
+	    continue;
+	  pfds[i].fd = conn->fd;
+	  pfds[i].events = POLLIN | (conn_pending (conn) ? POLLOUT : 0);
+	  if (conn_pending (conn) >= MAX_PENDING)
+	    can_expand = false;
+	}
+      if (poll (pfds, worker.num_parts + 1, can_expand ? 0 : -1) < 0 &&
+	  errno != EINTR)
+	break;
+
+      for (i = 0; i <= worker.num_parts && !done; i++)
+	{
+	  NetConn *conn = (i == 0) ? worker.coord : worker.peers[i-1];
+	  NetMsgHeader header;
+	  guint64 *payload;
+	  if (conn == NULL)
+	    continue;
+	  if ((pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) &&
+	      !conn_fill (conn))
+	    {
+	      /* Peers hang up when they quit, so only losing the
+		 coordinator is fatal.  */
+	      if (i == 0)
+		worker.failed = true;
+	      else
+		{
+		  conn_free (conn);
+		  worker.peers[i-1] = NULL;
+		  continue;
+		}
+	    }
+	  while (!done && conn_next (conn, &header, &payload))
+	    done = !worker_dispatch (&worker, &header, payload);
+	  if (!conn_flush (conn) && i == 0)
+	    worker.failed = true;
+	}
+
+      if (can_expand)
+	worker_expand_block (&worker);
+      /* Only merge once this worker has expanded the level itself, as
+	 the peers may all be done before it has even started.  */
+      if (worker.level_expanded &&
+	  worker.ends_received == worker.num_parts - 1)
+	worker_merge_level (&worker);
+    }
+  g_free (pfds);
+
+  /* Deliver anything still queued to the coordinator before hanging
+     up.  */
+  while (conn_pending (worker.coord) > 0)
+    {
+      struct pollfd pfd;
+      pfd.fd = worker.coord->fd;
+      pfd.events = POLLOUT;
+      if (poll (&pfd, 1, -1) < 0 || !conn_flush (worker.coord))
+	break;
+    }
+  worker_free (&worker);
+  if (!done)
+    {
+      g_printerr ("morris-sim: worker %u failed\n", worker.part);
+      return 1;
+    }
+  return 0;
+}
+
+/********************************************************************/
+/* Coordinator  */
+
+struct Coordinator_tag
+{
+  NetSimConfig *config;
+  NetConn **conns;
+  guint num_conns;
+  /* Replies collected during the current level.  */
+  guint num_replies;
+  guint64 expanded;
+  guint64 wins[NUM_PLAYERS];
+  guint64 num_new;
+  bool merge_failed;
+};
+typedef struct Coordinator_tag Coordinator;
+
+/* Collect replies until every worker has sent a reply of the given
+   type.  */
+static bool
+coordinator_wait (Coordinator *coord, guint32 reply_type)
+{
+  struct pollfd *pfds;
+  guint i;
+  bool success = true;
+
+  pfds = g_new (struct pollfd, coord->num_conns);
+  coord->num_replies = 0;
+  while (success && coord->num_replies < coord->num_conns)
+    {
+      for (i = 0; i < coord->num_conns; i++)
+	{
+	  pfds[i].fd = coord->conns[i]->fd;
+	  pfds[i].events = POLLIN |
+	    (conn_pending (coord->conns[i]) ? POLLOUT : 0);
+	  pfds[i].revents = 0;
+	}
+      if (poll (pfds, coord->num_conns, -1) < 0 && errno != EINTR)
+	break;
+
+      for (i = 0; i < coord->num_conns && success; i++)
+	{
+	  NetConn *conn = coord->conns[i];
+	  NetMsgHeader header;
+	  guint64 *payload;
+	  if ((pfds[i].revents & POLLOUT) && !conn_flush (conn))
+	    success = false;
+	  if (!(pfds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+	    continue;
+	  if (!conn_fill (conn))
+	    {
+	      g_printerr ("morris-sim: lost connection to worker %u\n", i);
+	      success = false;
+	    }
+	  while (conn_next (conn, &header, &payload))
+	    {
+	      if (header.type == MSG_MERGED && header.count >= 4)
+		{
+		  coord->expanded += payload[0];
+		  coord->wins[0] += payload[1];
+		  coord->wins[1] += payload[2];
+		  if (payload[3] == G_MAXUINT64)
+		    coord->merge_failed = true;
+		  else
+		    coord->num_new += payload[3];
+		}
+	      if (header.type == reply_type)
+		coord->num_replies++;
+	    }
+	}
+    }
+  g_free (pfds);
+  return success && coord->num_replies == coord->num_conns;
+}
+
+static void
+coordinator_broadcast (Coordinator *coord, guint32 type, guint32 level)
+{
+  guint i;
+  for (i = 0; i < coord->num_conns; i++)
+    {
+      conn_queue (coord->conns[i], type, i, level, NULL, 0);
+      conn_flush (coord->conns[i]);
+    }
+}
+
+static int
+coordinator_run (NetSimConfig *config, int listen_fd)
+{
+  Coordinator coord;
+  gchar **peer_addresses;
+  guint level, i, j;
+  int status = 0;
+
+  memset (&coord, 0, sizeof (coord));
+  coord.config = config;
+  coord.conns = g_new0 (NetConn *, config->num_workers);
+  peer_addresses = g_new0 (gchar *, config->num_workers);
+
+  /* Wait for every worker to say hello.  */
+  while (coord.num_conns < config->num_workers)
+    {
+      NetMsgHeader header;
+      guint64 *payload;
+      NetConn *conn;
+      int fd = accept (listen_fd, NULL, NULL);
+      if (fd < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  g_printerr ("morris-sim: accept failed: %s\n", strerror (errno));
+	  return 1;
+	}
+      conn = conn_new (fd);
+      if (!conn_wait (conn, &header, &payload) || header.type != MSG_HELLO ||
+	  header.count < 2 || payload[0] != NETSIM_MAGIC)
+	{
+	  g_printerr ("morris-sim: rejected an incompatible worker\n");
+	  conn_free (conn);
+	  continue;
+	}
+      peer_addresses[coord.num_conns] = payload_string (&header, payload);
+      coord.conns[coord.num_conns++] = conn;
+    }
+  close (listen_fd);
+
+  /* Hand out the partitions and introduce the workers to each other,
+     then wait until they are all connected.  */
+  for (i = 0; i < coord.num_conns; i++)
+    {
+      guint64 num_parts = coord.num_conns;
+      conn_queue (coord.conns[i], MSG_ASSIGN, i, 0, &num_parts, 1);
+      for (j = 0; j < coord.num_conns; j++)
+	conn_queue_string (coord.conns[i], MSG_PEER, j, 0,
+			   peer_addresses[j]);
+      conn_flush (coord.conns[i]);
+    }
+  for (i = 0; i < coord.num_conns; i++)
+    g_free (peer_addresses[i]);
+  g_free (peer_addresses);
+  if (!coordinator_wait (&coord, MSG_READY))
+    status = 1;
+
+  for (level = 0; status == 0 && level < config->max_level; level++)
+    {
+      coord.expanded = 0;
+      memset (coord.wins, 0, sizeof (coord.wins));
+      coord.num_new = 0;
+      coord.merge_failed = false;
+
+      coordinator_broadcast (&coord, MSG_EXPAND, level);
+      if (!coordinator_wait (&coord, MSG_MERGED) || coord.merge_failed)
+	{
+	  g_printerr ("morris-sim: error simulating level %u\n", level);
+	  status = 1;
+	  break;
+	}
+
+      printf ("level %u: %" G_GUINT64_FORMAT " states expanded, "
+	      "%" G_GUINT64_FORMAT " won by player 1, "
+	      "%" G_GUINT64_FORMAT " won by player 2, "
+	      "%" G_GUINT64_FORMAT " new states\n",
+	      level, coord.expanded, coord.wins[0], coord.wins[1],
+	      coord.num_new);
+      fflush (stdout);
+      if (coord.num_new == 0)
+	break;
+    }
+
+  coordinator_broadcast (&coord, MSG_QUIT, 0);
+  for (i = 0; i < coord.num_conns; i++)
+    {
+      /* Wait for the worker to hang up, so that it is done before the
+	 coordinator exits.  */
+      NetConn *conn = coord.conns[i];
+      struct pollfd pfd;
+      pfd.fd = conn->fd;
+      pfd.events = POLLIN | (conn_pending (conn) ? POLLOUT : 0);
+      while (poll (&pfd, 1, -1) >= 0)
+	{
+	  if (!conn_flush (conn) || !conn_fill (conn))
+	    break;
+	  pfd.events = POLLIN | (conn_pending (conn) ? POLLOUT : 0);
+	}
+      conn_free (conn);
+    }
+  g_free (coord.conns);
+  return status;
+}
+
+/**
+ * Run the simulator coordinator.
+ *
+ * The coordinator listens at the configured address, waits until the
+ * configured number of workers have connected, and then drives the
+ * simulation level by level.
+ *
+ * @param config the coordinator settings
+ * @return the process exit status
+ */
+int
+netsim_coordinator_main (NetSimConfig *config)
+{
+  int fd = net_socket (config->address, true);
+  if (fd < 0)
+    {
+      g_printerr ("morris-sim: cannot listen on %s\n", config->address);
+      return 1;
+    }
+  return coordinator_run (config, fd);
+}
+
+/**
+ * Run a coordinator together with local worker processes.
+ *
+ * This is the easiest way to run a distributed simulation on one
+ * computer, for example to test it.  The workers are forked off and
+ * connect to the coordinator through a Unix socket in the work
+ * directory, exactly as remote workers would.
+ *
+ * @param config the coordinator settings.  If no address is set, a
+ * Unix socket in the work directory is used.
+ * @return the process exit status
+ */
+int
+netsim_spawn_main (NetSimConfig *config)
+{
+  gchar *socket_path = NULL;
+  pid_t *pids;
+  int fd, status;
+  guint i;
+
+  if (config->address == NULL)
+    {
+      socket_path = g_build_filename (config->work_dir, "morris-sim.sock",
+				      NULL);
+      config->address = socket_path;
+    }
+  fd = net_socket (config->address, true);
+  if (fd < 0)
+    {
+      g_printerr ("morris-sim: cannot listen on %s\n", config->address);
+      g_free (socket_path);
+      return 1;
+    }
+
+  fflush (stdout);
+  pids = g_new (pid_t, config->num_workers);
+  for (i = 0; i < config->num_workers; i++)
+    {
+      pids[i] = fork ();
+      if (pids[i] == 0)
+	{
+	  close (fd);
+	  _exit (netsim_worker_main (config));
+	}
+    }
+
+  status = coordinator_run (config, fd);
+  for (i = 0; i < config->num_workers; i++)
+    {
+      int worker_status;
+      if (pids[i] > 0 && waitpid (pids[i], &worker_status, 0) == pids[i] &&
+	  (!WIFEXITED (worker_status) || WEXITSTATUS (worker_status) != 0))
+	status = 1;
+    }
+  if (socket_path != NULL)
+    g_unlink (socket_path);
+  g_free (pids);
+  g_free (socket_path);
+  return status;
+}
+
+#else /* G_OS_WIN32 */
+
+static int
+netsim_unsupported (void)
+{
+  g_printerr ("morris-sim: distributed simulation is not supported "
+	      "on Windows\n");
+  return 1;
+}
+
+int
+netsim_coordinator_main (NetSimConfig *config)
+{ return netsim_unsupported (); }
+
+int
+netsim_worker_main (NetSimConfig *config)
+{ return netsim_unsupported (); }
+
+int
+netsim_spawn_main (NetSimConfig *config)
+{ return netsim_unsupported (); }
+
+#endif /* G_OS_WIN32 */
@@ -0,0 +1,49 @@
+/* Distributed simulation over sockets.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Distributed simulation over sockets.
+ */
+
+#ifndef NETSIM_H
+#define NETSIM_H
+
+/** Settings shared by the coordinator and the workers.  */
+struct NetSimConfig_tag
+{
+  /** Either a Unix socket path or a "host:port" TCP address.  */
+  const gchar *address;
+  /** Work directory.  Workers store their shard below it.  */
+  const gchar *work_dir;
+  guint num_workers; /**< Number of workers the coordinator waits for */
+  gsize mem_budget; /**< Memory budget of each worker in bytes */
+  guint max_level;
+};
+typedef struct NetSimConfig_tag NetSimConfig;
+
+int netsim_coordinator_main (NetSimConfig *config);
+int netsim_worker_main (NetSimConfig *config);
+int netsim_spawn_main (NetSimConfig *config);
+
+#endif /* not NETSIM_H */
@@ -0,0 +1,631 @@
+/* Compact binary game records.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Compact binary game records.
+ *
+ * Game records are meant to hold very large numbers of games, so
+ * every move is encoded in a single byte.  The type of the move is
+ * part of that byte, so the moves can be decoded without replaying
+ * the game:
+ *
+ * @code
+ * 0 to 23     place a piece at the given position
+ * 24 to 47    remove the piece at (byte - 24)
+ * 48 to 143   move the piece at (byte - 48) / 4 to the adjacent
+ *             position in slot (byte - 48) % 4 of adjacent_places
+ * 144 to 167  move the piece at (byte - 144) to the position in the
+ *             next byte, which is only needed under the flying rule
+ * @endcode
+ *
+ * A game record file starts with an 8-byte header, which is followed
+ * by the games one after the other:
+ *
+ * @code
+ * offset 0   "MMGR"  magic
+ * offset 4   guint8  format version, currently 1
+ * offset 5   guint8  the number of men of the game variant
+ * offset 6   guint8  flags, bit 0 set if the flying rule is used
+ * offset 7   guint8  reserved, always 0
+ * @endcode
+ *
+ * Each game is a byte holding the ::Player who won, or #EMPTY if the
+ * game was not finished, then the size of the encoded moves as an
+ * unsigned LEB128 number of at most three bytes, then the moves.  A
+ * typical game thus takes up only two bytes more than its moves.
+ *
+ * The adjacent positions depend on the variant, so a file can only
+ * be read by a build for the same variant and rules.
+ *
+ * Games can also be written as text, one game per line, in the
+ * notation that record_parse_move() reads.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+
+#include "morris.h"
+#include "record.h"
+
+/* The generated adjacent_places table.  */
+#include "tables-gen.h"
+
+/** The first byte of each kind of encoded move.  */
+enum RecordCode_tag
+{
+  RECORD_PLACE = 0,
+  RECORD_REMOVE = RECORD_PLACE + BOARD_SIZE,
+  RECORD_MOVE = RECORD_REMOVE + BOARD_SIZE,
+  RECORD_FLY = RECORD_MOVE + BOARD_SIZE * 4,
+  RECORD_END = RECORD_FLY + BOARD_SIZE
+};
+
+/** The smallest I/O buffer used for a game record file.  */
+#define RECORD_IO_BUFFER (256 * 1024)
+
+/** The flags byte of the header of files written by this build.  */
+#define RECORD_FLAGS (FLYING_RULE ? 0x01 : 0x00)
+
+struct RecordWriter_tag
+{
+  FILE *fp;
+  gchar *io_buffer;
+  guchar *buf; /**< Scratch space for encoding a game */
+  gsize buf_size;
+};
+
+struct RecordReader_tag
+{
+  FILE *fp;
+  bool own_fp; /**< Whether to close the file with the reader */
+  guchar *buf;
+  gsize buf_size;
+  gsize start; /**< Offset of the first byte not yet handed out */
+  gsize end; /**< Offset past the last byte read from the file */
+  bool eof;
+};
+
+/********************************************************************/
+/* Moves  */
+
+/**
+ * Encode a move.
+ *
+ * @param move the move to encode
+ * @param buf where to store the encoded move, which must have room
+ * for #RECORD_MAX_MOVE_SIZE bytes
+ * @return the number of bytes stored
+ */
+guint
+record_encode_move (const Move *move, guchar *buf)
+{
+  guint i;
+  switch (move->type)
+    {
+    case MOVE_PLACE:
+      buf[0] = RECORD_PLACE + move->dest;
+      return 1;
+    case MOVE_REMOVE:
+      buf[0] = RECORD_REMOVE + move->dest;
+      return 1;
+    default:
+      for (i = 0; i < 4; i++)
+	{
+	  if (adjacent_places[move->src*4+i] == move->dest)
+	    {
+	      buf[0] = RECORD_MOVE + move->src * 4 + i;
+	      return 1;
+	    }
+	}
+      buf[0] = RECORD_FLY + move->src;
+      buf[1] = move->dest;
+      return 2;
+    }
+}
+
+/**
+ * Decode the next move.
+ *
+ * @param cursor the position of the encoded move, which is advanced
+ * past it
+ * @param end the end of the encoded moves
+ * @param move where to store the move
+ * @return @a true if a move was decoded, @a false if the encoded
+ * move is corrupt or runs past @a end
+ */
+bool
+record_decode_move (const guchar **cursor, const guchar *end, Move *move)
+{
+  const guchar *p = *cursor;
+  guchar code;
+  if (p >= end)
+    return false;
+  code = *p++;
+  move->src = 0;
+  if (code < RECORD_REMOVE)
+    {
+      move->type = MOVE_PLACE;
+      move->dest = code - RECORD_PLACE;
+    }
+  else if (code < RECORD_MOVE)
+    {
+      move->type = MOVE_REMOVE;
+      move->dest = code - RECORD_REMOVE;
+    }
+  else if (code < RECORD_FLY)
+    {
+      code -= RECORD_MOVE;
+      move->type = MOVE_MOVE;
+      move->src = code / 4;
+      move->dest = adjacent_places[code];
+      if (move->dest >= BOARD_SIZE)
+	return false;
+    }
+  else if (code < RECORD_END && p < end && *p < BOARD_SIZE)
+    {
+      move->type = MOVE_MOVE;
+      move->src = code - RECORD_FLY;
+      move->dest = *p++;
+    }
+  else
+    return false;
+  *cursor = p;
+  return true;
+}
+
+/********************************************************************/
+/* Text notation  */
+
+/**
+ * Parse a zero-based game board index from a textual game record.
+ *
+ * @param cursor the parse position, which is advanced past the index
+ * @param pos where to store the index
+ * @return @a true if a valid index was parsed, @a false otherwise
+ */
+static bool
+parse_pos (const gchar **cursor, guchar *pos)
+{
+  const gchar *p = *cursor;
+  guint value = 0;
+  if (!g_ascii_isdigit (*p))
+    return false;
+  while (g_ascii_isdigit (*p) && value < BOARD_SIZE)
+    value = value * 10 + (*p++ - '0');
+  if (value >= BOARD_SIZE || g_ascii_isdigit (*p))
+    return false;
+  *pos = (guchar) value;
+  *cursor = p;
+  return true;
+}
+
+/**
+ * Parse the next move from a textual game record.
+ *
+ * A game record is a single line of moves separated by white space.
+ * A place is written as the index of the position, a move as the
+ * source and destination indexes joined by a dash, such as `5-13',
+ * and a remove as the index with an `x' in front of it.  A `#' starts
+ * a comment that runs to the end of the line.
+ *
+ * @param cursor the parse position, which is advanced past the move
+ * @param move where to store the move
+ * @return 1 if a move was parsed, 0 at the end of the record, or -1
+ * on a syntax error
+ */
+int
+record_parse_move (const gchar **cursor, Move *move)
+{
+  const gchar *p = *cursor;
+  while (g_ascii_isspace (*p))
+    p++;
+  *cursor = p;
+  if (*p == '\0' || *p == '#')
+    return 0;
+  move->src = 0;
+  move->type = MOVE_PLACE;
+  if (*p == 'x')
+    {
+      move->type = MOVE_REMOVE;
+      p++;
+    }
+  if (!parse_pos (&p, &move->dest))
+    return -1;
+  if (move->type == MOVE_PLACE && *p == '-')
+    {
+      p++;
+      move->type = MOVE_MOVE;
+      move->src = move->dest;
+      if (!parse_pos (&p, &move->dest))
+	return -1;
+    }
+  if (*p != '\0' && *p != '#' && !g_ascii_isspace (*p))
+    return -1;
+  *cursor = p;
+  return 1;
+}
+
+/**
+ * Write a move in the notation of textual game records.
+ *
+ * @param move the move to write
+ * @param buf the buffer that receives the move, which must have room
+ * for #RECORD_MOVE_TEXT_SIZE characters
+ */
+void
+record_format_move (const Move *move, gchar *buf)
+{
+  switch (move->type)
+    {
+    case MOVE_PLACE: sprintf (buf, "%u", move->dest); break;
+    case MOVE_MOVE: sprintf (buf, "%u-%u", move->src, move->dest); break;
+    default: sprintf (buf, "x%u", move->dest); break;
+    }
+}
+
+/**
+ * Play a move from a game record.
+ *
+ * The move is checked against the phase of the game as well as
+ * against the rules engine, so a record may neither place a piece
+ * after the setup phase nor continue after the game was won.
+ *
+ * @param state the game state to use
+ * @param move the move to play
+ * @return @a true if the move was legal and was played, @a false
+ * otherwise
+ */
+bool
+record_play_move (GameState *state, Move *move)
+{
+  guchar expected;
+  if (state->setup_rounds_left == 0 && get_winner (state) != EMPTY)
+    return false;
+  if (state->remove_state)
+    expected = MOVE_REMOVE;
+  else if (state->setup_rounds_left > 0)
+    expected = MOVE_PLACE;
+  else
+    expected = MOVE_MOVE;
+  return move->type == expected && play_move (state, move);
+}
+
+/**
+ * Read one line of any length from a stream.
+ *
+ * @param fp the stream to read from
+ * @param line the buffer that receives the line, without its newline
+ * @return @a true if a line was read, @a false at the end of the
+ * stream
+ */
+bool
+record_read_line (FILE *fp, GString *line)
+{
+  gchar chunk[4096];
+  g_string_truncate (line, 0);
+  while (fgets (chunk, sizeof (chunk), fp) != NULL)
+    {
+      gsize len = strlen (chunk);
+      if (len > 0 && chunk[len-1] == '\n')
+	{
+	  g_string_append_len (line, chunk, len - 1);
+	  return true;
+	}
+      g_string_append_len (line, chunk, len);
+    }
+  return line->len > 0;
+}
+
+/**
+ * Split off the next word of a command in a line protocol, such as
+ * that of morris-engine or morris-server.
+ *
+ * @param cursor the rest of the line, which is advanced past the word
+ * and the space after it; the space is overwritten with a null
+ * character
+ * @return the word, or NULL at the end of the line
+ */
+gchar *
+record_next_word (gchar **cursor)
+{
+  gchar *p = *cursor, *word;
+  while (g_ascii_isspace (*p))
+    p++;
+  if (*p == '\0')
+    {
+      *cursor = p;
+      return NULL;
+    }
+  word = p;
+  while (*p != '\0' && !g_ascii_isspace (*p))
+    p++;
+  if (*p != '\0')
+    *p++ = '\0';
+  *cursor = p;
+  return word;
+}
+
+/********************************************************************/
+/* Writing  */
+
+/**
+ * Create or truncate a game record file for writing.
+ *
+ * @param path the file to write
+ * @return a new writer, or @a NULL if the file could not be created
+ */
+RecordWriter *
+record_writer_create (const gchar *path)
+{
+  RecordWriter *writer;
+  guchar header[RECORD_HEADER_SIZE];
+  FILE *fp;
+
+  fp = fopen (path, "wb");
+  if (fp == NULL)
+    return NULL;
+  writer = g_new (RecordWriter, 1);
+  writer->fp = fp;
+  writer->io_buffer = g_malloc (RECORD_IO_BUFFER);
+  setvbuf (fp, writer->io_buffer, _IOFBF, RECORD_IO_BUFFER);
+  writer->buf_size = 1024;
+  writer->buf = g_malloc (writer->buf_size);
+
+  memcpy (header, RECORD_MAGIC, 4);
+  header[4] = RECORD_VERSION;
+  header[5] = MORRIS_VARIANT;
+  header[6] = RECORD_FLAGS;
+  header[7] = 0;
+  fwrite (header, RECORD_HEADER_SIZE, 1, fp);
+  return writer;
+}
+
+/**
+ * Append a game to a game record file.
+ *
+ * @param writer the writer to use
+ * @param winner the player who won the game, or #EMPTY if it was not
+ * finished
+ * @param moves the moves of the game
+ * @param num_moves the number of moves
+ * @return @a true on success, @a false on an I/O error or if the game
+ * is longer than #RECORD_MAX_GAME_SIZE
+ */
+bool
+record_writer_add (RecordWriter *writer, Player winner,
+		   const Move *moves, guint num_moves)
+{
+  gsize needed = 4 + (gsize) num_moves * RECORD_MAX_MOVE_SIZE;
+  gsize size = 0, header_size = 1, rest;
+  guchar header[4];
+  guchar *data;
+  guint i;
+
+  if (needed > writer->buf_size)
+    {
+      writer->buf_size = needed;
+      writer->buf = g_realloc (writer->buf, needed);
+    }
+  /* Leave room for the game header in front of the moves.  */
+  data = writer->buf + 4;
+  for (i = 0; i < num_moves; i++)
+    size += record_encode_move (&moves[i], data + size);
+  if (size > RECORD_MAX_GAME_SIZE)
+    return false;
+
+  header[0] = winner;
+  rest = size;
+  do
+    {
+      header[header_size] = rest & 0x7f;
+      rest >>= 7;
+      if (rest != 0)
+	header[header_size] |= 0x80;
+      header_size++;
+    }
+  while (rest != 0);
+  memcpy (data - header_size, header, header_size);
+  return fwrite (data - header_size, header_size + size, 1,
+		 writer->fp) == 1;
+}
+
+/**
+ * Finish writing a game record file and free the writer.
+ *
+ * @param writer the writer to close
+ * @return @a true if all games were written successfully, @a false
+ * on an I/O error
+ */
+bool
+record_writer_close (RecordWriter *writer)
+{
+  bool success;
+  success = !ferror (writer->fp);
+  success &= (fclose (writer->fp) == 0);
+  g_free (writer->io_buffer);
+  g_free (writer->buf);
+  g_free (writer);
+  return success;
+}
+
+/********************************************************************/
+/* Reading  */
+
+/**
+ * Start reading a game record file from an open stream.
+ *
+ * The header is read and checked right away.  Games are then read in
+ * large blocks, so @a fp should not be read by anything else until
+ * the reader is closed.
+ *
+ * @param fp the stream to read from, which is not closed with the
+ * reader
+ * @return a new reader, or @a NULL if the stream does not start with
+ * a game record header for this variant and these rules
+ */
+RecordReader *
+record_reader_new (FILE *fp)
+{
+  RecordReader *reader;
+  guchar header[RECORD_HEADER_SIZE];
+  if (fread (header, RECORD_HEADER_SIZE, 1, fp) != 1 ||
+      memcmp (header, RECORD_MAGIC, 4) != 0 ||
+      header[4] != RECORD_VERSION || header[5] != MORRIS_VARIANT ||
+      header[6] != RECORD_FLAGS)
+    return NULL;
+  reader = g_new (RecordReader, 1);
+  reader->fp = fp;
+  reader->own_fp = false;
+  reader->buf_size = RECORD_IO_BUFFER;
+  reader->buf = g_malloc (reader->buf_size);
+  reader->start = 0;
+  reader->end = 0;
+  reader->eof = false;
+  return reader;
+}
+
+/**
+ * Open a game record file for reading.
+ *
+ * @param path the file to read
+ * @return a new reader, or @a NULL if the file could not be opened or
+ * is not a game record file for this variant and these rules
+ */
+RecordReader *
+record_reader_open (const gchar *path)
+{
+  RecordReader *reader;
+  FILE *fp;
+  fp = fopen (path, "rb");
+  if (fp == NULL)
+    return NULL;
+  setvbuf (fp, NULL, _IONBF, 0);
+  reader = record_reader_new (fp);
+  if (reader == NULL)
+    {
+      fclose (fp);
+      return NULL;
+    }
+  reader->own_fp = true;
+  return reader;
+}
+
+/* Read more of the file into the buffer, keeping the bytes that were
+   not handed out yet.  Returns false at the end of the file.  */
+static bool
+fill_buffer (RecordReader *reader)
+{
+  gsize num_read;
+  if (reader->eof)
+    return false;
+  if (reader->start > 0)
+    {
+      memmove (reader->buf, reader->buf + reader->start,
+	       reader->end - reader->start);
+      reader->end -= reader->start;
+      reader->start = 0;
+    }
+  if (reader->end == reader->buf_size)
+    {
+      reader->buf_size *= 2;
+      reader->buf = g_realloc (reader->buf, reader->buf_size);
+    }
+  num_read = fread (reader->buf + reader->end, 1,
+		    reader->buf_size - reader->end, reader->fp);
+  reader->end += num_read;
+  if (num_read == 0)
+    reader->eof = true;
+  return num_read > 0;
+}
+
+/**
+ * Read the next game from a game record file.
+ *
+ * @param reader the reader to use
+ * @param game where to store the game, whose moves are only valid
+ * until the next call
+ * @return 1 if a game was read, 0 at the end of the file, or -1 if
+ * the file is corrupt or could not be read
+ */
+int
+record_reader_next (RecordReader *reader, RecordGame *game)
+{
+  while (1)
+    {
+      const guchar *p = reader->buf + reader->start;
+      gsize avail = reader->end - reader->start;
+      gsize size = 0, i;
+      bool complete = false;
+
+      /* Decode the size of the moves, which follows the winner.  */
+      for (i = 1; i < avail && i <= 3; i++)
+	{
+	  size |= (gsize) (p[i] & 0x7f) << (7 * (i - 1));
+	  if (!(p[i] & 0x80))
+	    {
+	      complete = true;
+	      i++;
+	      break;
+	    }
+	}
+      if (avail > 0 && (p[0] > PLAYER2 || (!complete && i > 3)))
+	return -1;
+      if (complete && avail >= i + size)
+	{
+	  game->winner = p[0];
+	  game->data = p + i;
+	  game->size = size;
+	  reader->start += i + size;
+	  return 1;
+	}
+      /* A game that is cut off at the end of the file is corrupt.  */
+      if (!fill_buffer (reader))
+	return (avail == 0 && !ferror (reader->fp)) ? 0 : -1;
+    }
+}
+
+/**
+ * Close a game record file and free the reader.
+ *
+ * @param reader the reader to close
+ * @return @a true if the whole file was read without an I/O error,
+ * @a false otherwise
+ */
+bool
+record_reader_close (RecordReader *reader)
+{
+  bool success = !ferror (reader->fp);
+  if (reader->own_fp)
+    success &= (fclose (reader->fp) == 0);
+  g_free (reader->buf);
+  g_free (reader);
+  return success;
+}
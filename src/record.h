@@ -0,0 +1,89 @@
+/* Compact binary game records.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Compact binary game records.
+ */
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdio.h>
+
+/** The first bytes of a game record file.  */
+#define RECORD_MAGIC "MMGR"
+/** The current version of the game record format.  */
+#define RECORD_VERSION 1
+/** The size of the header at the start of a game record file.  */
+#define RECORD_HEADER_SIZE 8
+/** The largest number of bytes that one encoded move takes up.  */
+#define RECORD_MAX_MOVE_SIZE 2
+/** The size of a buffer for a move in the notation of textual game
+    records, including the terminating null character.  */
+#define RECORD_MOVE_TEXT_SIZE 8
+/** The largest encoded size of the moves of one game.  */
+#define RECORD_MAX_GAME_SIZE ((1 << 21) - 1)
+
+/**
+ * One game as read from a game record file.
+ *
+ * The moves are not decoded, but point into the buffer of the
+ * ::RecordReader that read them, so they are only valid until the
+ * next game is read.  Use record_decode_move() to go through them.
+ */
+struct RecordGame_tag
+{
+  Player winner; /**< The recorded winner, or #EMPTY if unfinished */
+  const guchar *data; /**< The encoded moves */
+  gsize size; /**< Size of the encoded moves in bytes */
+};
+typedef struct RecordGame_tag RecordGame;
+
+/** A game record file that is being written.  */
+typedef struct RecordWriter_tag RecordWriter;
+/** A game record file that is being read.  */
+typedef struct RecordReader_tag RecordReader;
+
+guint record_encode_move (const Move *move, guchar *buf);
+bool record_decode_move (const guchar **cursor, const guchar *end,
+			 Move *move);
+
+int record_parse_move (const gchar **cursor, Move *move);
+void record_format_move (const Move *move, gchar *buf);
+bool record_play_move (GameState *state, Move *move);
+bool record_read_line (FILE *fp, GString *line);
+gchar *record_next_word (gchar **cursor);
+
+RecordWriter *record_writer_create (const gchar *path);
+bool record_writer_add (RecordWriter *writer, Player winner,
+			const Move *moves, guint num_moves);
+bool record_writer_close (RecordWriter *writer);
+
+RecordReader *record_reader_new (FILE *fp);
+RecordReader *record_reader_open (const gchar *path);
+int record_reader_next (RecordReader *reader, RecordGame *game);
+bool record_reader_close (RecordReader *reader);
+
+#endif /* not RECORD_H */
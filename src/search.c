@@ -0,0 +1,248 @@
+/* Game tree search.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Game tree search.
+ *
+ * This is a plain alpha-beta search in negamax form, which deepens
+ * one ply at a time until it runs out of depth or time or is stopped.
+ * The best move of each iteration is searched first in the next one,
+ * and moves that form a mill are searched before the others, which is
+ * enough ordering for the small branching factor of the game.
+ *
+ * A player who forms a mill moves again to remove a piece, so the
+ * score is only negated when the turn passes to the other player.
+ * Like morris-match, the search scores a position where the player to
+ * move has no legal move as a draw.
+ *
+ * The search can be stopped from another thread with search_stop().
+ * The stop flag and the clock are only checked every few thousand
+ * positions, so that the check costs nothing.  A search that is
+ * stopped returns the result of its last complete iteration.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <string.h>
+#include <glib.h>
+
+#include "morris.h"
+#include "eval.h"
+#include "search.h"
+
+/** Positions visited between checks of the stop flag and clock.  */
+#define SEARCH_CHECK_INTERVAL 4096
+
+/**
+ * Set up a search context with the default settings: the global
+ * evaluation weights, the largest depth and no time limit.
+ *
+ * @param ctx the context to initialize
+ */
+void
+search_init (SearchContext *ctx)
+{
+  memset (ctx, 0, sizeof (SearchContext));
+  ctx->weights = &eval_weights;
+  ctx->max_depth = SEARCH_MAX_DEPTH;
+}
+
+/**
+ * Ask a running search to stop as soon as possible.  This function
+ * may be called from any thread.
+ *
+ * @param ctx the context of the search
+ */
+void
+search_stop (SearchContext *ctx)
+{
+  g_atomic_int_set (&ctx->stop, 1);
+}
+
+/* Check whether the search should stop.  */
+static bool
+should_abort (SearchContext *ctx)
+{
+  if (ctx->aborted)
+    return true;
+  if (ctx->nodes % SEARCH_CHECK_INTERVAL == 0 &&
+      (g_atomic_int_get (&ctx->stop) ||
+       (ctx->deadline != 0 && g_get_monotonic_time () >= ctx->deadline)))
+    ctx->aborted = true;
+  return ctx->aborted;
+}
+
+/* Play every move in a position, and put the moves that form a mill
+   in front.  Returns the number of children.  */
+static guint
+gen_children (GameState *state, Move *moves, GameState *children)
+{
+  guint num_moves = gen_moves (state, moves);
+  guint num_mills = 0, i;
+  for (i = 0; i < num_moves; i++)
+    {
+      children[i] = *state;
+      play_move (&children[i], &moves[i]);
+      if (children[i].remove_state && !state->remove_state)
+	{
+	  GameState child = children[i];
+	  Move move = moves[i];
+	  children[i] = children[num_mills];
+	  moves[i] = moves[num_mills];
+	  children[num_mills] = child;
+	  moves[num_mills] = move;
+	  num_mills++;
+	}
+    }
+  return num_moves;
+}
+
+/* Search the child of a node, from the point of view of the player to
+   move at the node.  */
+static gint search_child (SearchContext *ctx, GameState *parent,
+			  GameState *child, guint depth, guint ply,
+			  gint alpha, gint beta);
+
+static gint
+negamax (SearchContext *ctx, GameState *state, guint depth, guint ply,
+	 gint alpha, gint beta)
+{
+  Move moves[MAX_MOVES];
+  GameState children[MAX_MOVES];
+  guint num_moves, i;
+
+  ctx->nodes++;
+  if (should_abort (ctx))
+    return 0;
+  if (state->setup_rounds_left == 0)
+    {
+      Player winner = get_winner (state);
+      if (winner != EMPTY)
+	return (winner == state->cur_player) ?
+	  EVAL_WIN - (gint) ply : -EVAL_WIN + (gint) ply;
+    }
+  if (depth == 0)
+    return eval_position (ctx->weights, state);
+
+  num_moves = gen_children (state, moves, children);
+  if (num_moves == 0)
+    return 0;
+  for (i = 0; i < num_moves; i++)
+    {
+      gint score = search_child (ctx, state, &children[i], depth - 1,
+				 ply + 1, alpha, beta);
+      if (score > alpha)
+	{
+	  alpha = score;
+	  if (alpha >= beta)
+	    break;
+	}
+    }
+  return alpha;
+}
+
+static gint
+search_child (SearchContext *ctx, GameState *parent, GameState *child,
+	      guint depth, guint ply, gint alpha, gint beta)
+{
+  if (child->cur_player == parent->cur_player)
+    return negamax (ctx, child, depth, ply, alpha, beta);
+  return -negamax (ctx, child, depth, ply, -beta, -alpha);
+}
+
+/**
+ * Search for the best move in a position.
+ *
+ * @param ctx the settings of the search
+ * @param state the position to search
+ * @param result receives the result of the last complete iteration.
+ * If the search was stopped before the first iteration was complete,
+ * the best move is the first legal move, at depth 0.
+ * @return @a true on success, @a false if there is no legal move
+ */
+bool
+search_run (SearchContext *ctx, GameState *state, SearchInfo *result)
+{
+  Move moves[MAX_MOVES];
+  GameState children[MAX_MOVES];
+  gint64 start = g_get_monotonic_time ();
+  guint num_moves, depth;
+
+  ctx->nodes = 0;
+  ctx->aborted = false;
+  num_moves = gen_children (state, moves, children);
+  if (num_moves == 0)
+    return false;
+  memset (result, 0, sizeof (SearchInfo));
+  result->best = moves[0];
+  result->score = eval_position (ctx->weights, state);
+
+  for (depth = 1; depth <= ctx->max_depth; depth++)
+    {
+      gint alpha = -EVAL_WIN - 1, beta = EVAL_WIN + 1;
+      guint best = 0, i;
+      for (i = 0; i < num_moves; i++)
+	{
+	  gint score = search_child (ctx, state, &children[i], depth - 1, 1,
+				     alpha, beta);
+	  if (ctx->aborted)
+	    break;
+	  if (score > alpha)
+	    {
+	      alpha = score;
+	      best = i;
+	    }
+	}
+      if (ctx->aborted)
+	break;
+
+      result->depth = depth;
+      result->score = alpha;
+      result->best = moves[best];
+      result->nodes = ctx->nodes;
+      result->usec = g_get_monotonic_time () - start;
+      if (ctx->report != NULL)
+	ctx->report (result, ctx->report_data);
+      /* Search the best move first in the next iteration.  */
+      if (best != 0)
+	{
+	  GameState child = children[best];
+	  Move move = moves[best];
+	  memmove (&children[1], &children[0], best * sizeof (GameState));
+	  memmove (&moves[1], &moves[0], best * sizeof (Move));
+	  children[0] = child;
+	  moves[0] = move;
+	}
+      /* A forced result will not change with more depth.  */
+      if (alpha >= SEARCH_WIN_SCORE || alpha <= -SEARCH_WIN_SCORE)
+	break;
+    }
+  result->nodes = ctx->nodes;
+  result->usec = g_get_monotonic_time () - start;
+  return true;
+}
@@ -0,0 +1,84 @@
+/* Game tree search.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+
+/**
+ * @file
+ * Game tree search.
+ */
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+/** The deepest search in plies.  */
+#define SEARCH_MAX_DEPTH 64
+
+/**
+ * Scores whose magnitude is at least this large are forced wins or
+ * losses.  #EVAL_WIN minus the score is the number of plies to the end
+ * of the game.
+ */
+#define SEARCH_WIN_SCORE (EVAL_WIN - SEARCH_MAX_DEPTH)
+
+/** The outcome of one iteration of a search.  */
+struct SearchInfo_tag
+{
+  guint depth; /**< Depth of the iteration in plies */
+  gint score; /**< Score for the player to move at the root */
+  Move best; /**< The best move found */
+  guint64 nodes; /**< Positions visited since the search started */
+  gint64 usec; /**< Time since the search started in microseconds */
+};
+typedef struct SearchInfo_tag SearchInfo;
+
+/**
+ * Receives the result of every iteration of a search, on the thread
+ * that runs the search.
+ */
+typedef void (*SearchReportFunc) (const SearchInfo *info, gpointer data);
+
+/**
+ * The settings and state of a search.  Initialize it with
+ * search_init(), then change the settings before each search.
+ */
+struct SearchContext_tag
+{
+  const EvalWeights *weights;
+  guint max_depth; /**< Deepest iteration in plies */
+  /** g_get_monotonic_time() after which the search stops, or 0.  */
+  gint64 deadline;
+  SearchReportFunc report; /**< Called after each iteration, or NULL */
+  gpointer report_data;
+  /** Set by search_stop(), possibly from another thread.  */
+  volatile gint stop;
+  /* Private state while searching.  */
+  guint64 nodes;
+  bool aborted;
+};
+typedef struct SearchContext_tag SearchContext;
+
+void search_init (SearchContext *ctx);
+bool search_run (SearchContext *ctx, GameState *state, SearchInfo *result);
+void search_stop (SearchContext *ctx);
+
+#endif /* not SEARCH_H */
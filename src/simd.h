@@ -0,0 +1,284 @@
+/* Portable SIMD operations on game boards.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Portable SIMD operations on game boards and mill masks.
+ *
+ * A ::SimdBoard holds one board or mask of #MASK_SIZE bytes in as
+ * few vector registers as the target allows: one 256-bit AVX2
+ * register, 128-bit SSE2 or NEON registers, or 64-bit integers as a
+ * fallback.  The fallback loops have a constant trip count, so the
+ * compiler can still vectorize them on other targets.  The choice is
+ * made from the compiler's predefined macros, so it follows the
+ * target flags in CFLAGS rather than any configure option.
+ *
+ * morris.h must be included before this file.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <string.h>
+
+#if MASK_SIZE % 32 == 0 && defined (__AVX2__)
+#  include <immintrin.h>
+#  define SIMD_AVX2 1
+#  define SIMD_LANE_SIZE 32
+typedef __m256i SimdLane;
+#elif MASK_SIZE % 16 == 0 && defined (__SSE2__)
+#  include <emmintrin.h>
+#  define SIMD_SSE2 1
+#  define SIMD_LANE_SIZE 16
+typedef __m128i SimdLane;
+#elif MASK_SIZE % 16 == 0 && defined (__ARM_NEON)
+#  include <arm_neon.h>
+#  define SIMD_NEON 1
+#  define SIMD_LANE_SIZE 16
+typedef uint8x16_t SimdLane;
+#else
+#  define SIMD_SCALAR 1
+#  define SIMD_LANE_SIZE 8
+typedef guint64 SimdLane;
+#endif
+
+/** Number of ::SimdLane registers in a ::SimdBoard.  */
+#define SIMD_LANES (MASK_SIZE / SIMD_LANE_SIZE)
+
+/** A game board or mill mask loaded into registers.  */
+struct SimdBoard_tag
+{
+  SimdLane lane[SIMD_LANES];
+};
+typedef struct SimdBoard_tag SimdBoard;
+
+/**
+ * Load a board or mask.  The memory does not need to be aligned.
+ *
+ * @param mem #MASK_SIZE bytes to load
+ */
+static inline SimdBoard
+simd_load (const void *mem)
+{
+  SimdBoard result;
+  const guchar *bytes = (const guchar *) mem;
+  guint i;
+  for (i = 0; i < SIMD_LANES; i++)
+    {
+#if defined (SIMD_AVX2)
+      result.lane[i] = _mm256_loadu_si256 ((const __m256i *)
+					   (bytes + i * SIMD_LANE_SIZE));
+#elif defined (SIMD_SSE2)
+      result.lane[i] = _mm_loadu_si128 ((const __m128i *)
+					(bytes + i * SIMD_LANE_SIZE));
+#elif defined (SIMD_NEON)
+      result.lane[i] = vld1q_u8 (bytes + i * SIMD_LANE_SIZE);
+#else
+      memcpy (&result.lane[i], bytes + i * SIMD_LANE_SIZE, SIMD_LANE_SIZE);
+#endif
+    }
+  return result;
+}
+
+/**
+ * Store a board or mask.  The memory does not need to be aligned.
+ *
+ * @param mem where to store #MASK_SIZE bytes
+ * @param board the board to store
+ */
+static inline void
+simd_store (void *mem, SimdBoard board)
+{
+  guchar *bytes = (guchar *) mem;
+  guint i;
+  for (i = 0; i < SIMD_LANES; i++)
+    {
+#if defined (SIMD_AVX2)
+      _mm256_storeu_si256 ((__m256i *) (bytes + i * SIMD_LANE_SIZE),
+			   board.lane[i]);
+#elif defined (SIMD_SSE2)
+      _mm_storeu_si128 ((__m128i *) (bytes + i * SIMD_LANE_SIZE),
+			board.lane[i]);
+#elif defined (SIMD_NEON)
+      vst1q_u8 (bytes + i * SIMD_LANE_SIZE, board.lane[i]);
+#else
+      memcpy (bytes + i * SIMD_LANE_SIZE, &board.lane[i], SIMD_LANE_SIZE);
+#endif
+    }
+}
+
+/** Return a board with every bit cleared.  */
+static inline SimdBoard
+simd_zero (void)
+{
+  SimdBoard result;
+  memset (&result, 0, sizeof (result));
+  return result;
+}
+
+/** Return the bitwise AND of two boards.  */
+static inline SimdBoard
+simd_and (SimdBoard board1, SimdBoard board2)
+{
+  guint i;
+  for (i = 0; i < SIMD_LANES; i++)
+#if defined (SIMD_AVX2)
+    board1.lane[i] = _mm256_and_si256 (board1.lane[i], board2.lane[i]);
+#elif defined (SIMD_SSE2)
+    board1.lane[i] = _mm_and_si128 (board1.lane[i], board2.lane[i]);
+#elif defined (SIMD_NEON)
+    board1.lane[i] = vandq_u8 (board1.lane[i], board2.lane[i]);
+#else
+    board1.lane[i] &= board2.lane[i];
+#endif
+  return board1;
+}
+
+/** Return the bitwise OR of two boards.  */
+static inline SimdBoard
+simd_or (SimdBoard board1, SimdBoard board2)
+{
+  guint i;
+  for (i = 0; i < SIMD_LANES; i++)
+#if defined (SIMD_AVX2)
+    board1.lane[i] = _mm256_or_si256 (board1.lane[i], board2.lane[i]);
+#elif defined (SIMD_SSE2)
+    board1.lane[i] = _mm_or_si128 (board1.lane[i], board2.lane[i]);
+#elif defined (SIMD_NEON)
+    board1.lane[i] = vorrq_u8 (board1.lane[i], board2.lane[i]);
+#else
+    board1.lane[i] |= board2.lane[i];
+#endif
+  return board1;
+}
+
+/**
+ * Clear the bits of a mask in a board.
+ *
+ * @param mask the bits to clear
+ * @param board the board to clear them in
+ * @return @a board AND NOT @a mask
+ */
+static inline SimdBoard
+simd_andnot (SimdBoard mask, SimdBoard board)
+{
+  guint i;
+  for (i = 0; i < SIMD_LANES; i++)
+#if defined (SIMD_AVX2)
+    board.lane[i] = _mm256_andnot_si256 (mask.lane[i], board.lane[i]);
+#elif defined (SIMD_SSE2)
+    board.lane[i] = _mm_andnot_si128 (mask.lane[i], board.lane[i]);
+#elif defined (SIMD_NEON)
+    board.lane[i] = vbicq_u8 (board.lane[i], mask.lane[i]);
+#else
+    board.lane[i] &= ~mask.lane[i];
+#endif
+  return board;
+}
+
+/** Check if every bit of a board is cleared.  */
+static inline bool
+simd_is_zero (SimdBoard board)
+{
+#if defined (SIMD_AVX2)
+  __m256i any = board.lane[0];
+#elif defined (SIMD_SSE2)
+  __m128i any = board.lane[0];
+#elif defined (SIMD_NEON)
+  uint8x16_t any = board.lane[0];
+#else
+  guint64 any = board.lane[0];
+#endif
+  guint i;
+  for (i = 1; i < SIMD_LANES; i++)
+#if defined (SIMD_AVX2)
+    any = _mm256_or_si256 (any, board.lane[i]);
+#elif defined (SIMD_SSE2)
+    any = _mm_or_si128 (any, board.lane[i]);
+#elif defined (SIMD_NEON)
+    any = vorrq_u8 (any, board.lane[i]);
+#else
+    any |= board.lane[i];
+#endif
+#if defined (SIMD_AVX2)
+  return _mm256_testz_si256 (any, any);
+#elif defined (SIMD_SSE2)
+  return _mm_movemask_epi8 (_mm_cmpeq_epi8 (any, _mm_setzero_si128 ()))
+    == 0xffff;
+#elif defined (SIMD_NEON)
+  {
+    uint64x2_t halves = vreinterpretq_u64_u8 (any);
+    return (vgetq_lane_u64 (halves, 0) | vgetq_lane_u64 (halves, 1)) == 0;
+  }
+#else
+  return any == 0;
+#endif
+}
+
+/**
+ * Check if all the pieces of a mask are on a board.
+ *
+ * @param board the board to test
+ * @param mask the pieces to look for
+ * @return @a true if (@a board AND @a mask) equals @a mask
+ */
+static inline bool
+simd_covers (SimdBoard board, SimdBoard mask)
+{
+  return simd_is_zero (simd_andnot (board, mask));
+}
+
+/**
+ * Find the bytes of a board that equal a value.  This is meant for
+ * unpacked boards, which have one byte per position.
+ *
+ * @param board the board to search
+ * @param value the byte value to look for
+ * @return a bit set with bit @a n set if byte @a n equals @a value,
+ * for the first 32 bytes
+ */
+static inline guint32
+simd_match_bytes (SimdBoard board, guchar value)
+{
+#if defined (SIMD_AVX2)
+  return _mm256_movemask_epi8 (_mm256_cmpeq_epi8
+			       (board.lane[0], _mm256_set1_epi8 (value)));
+#elif defined (SIMD_SSE2)
+  guint32 result = 0;
+  guint i;
+  for (i = 0; i < SIMD_LANES && i < 2; i++)
+    result |= (guint32) _mm_movemask_epi8
+      (_mm_cmpeq_epi8 (board.lane[i], _mm_set1_epi8 (value))) << (i * 16);
+  return result;
+#else
+  guchar bytes[MASK_SIZE];
+  guint32 result = 0;
+  guint i;
+  simd_store (bytes, board);
+  for (i = 0; i < MASK_SIZE && i < 32; i++)
+    result |= (guint32) (bytes[i] == value) << i;
+  return result;
+#endif
+}
+
+#endif /* not SIMD_H */
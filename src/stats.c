@@ -0,0 +1,413 @@
+/* Live statistics for the simulator.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Live statistics for the simulator.
+ *
+ * A simulation of the full game runs for days, so the simulator can
+ * report on its progress while it works, both as human readable lines
+ * on standard error and as a stream of JSON objects, one per line,
+ * for dashboards.
+ *
+ * Keeping the overhead low is what shapes this module.  Each worker
+ * thread counts into its own ::SimCounters structure, which no other
+ * thread writes to, and nothing is aggregated until a report is due.
+ * Reports come from a separate thread that wakes up every few seconds
+ * and sums up the counters of all workers.  Reading the clock for
+ * every expansion would cost more than the expansion itself, so only
+ * one small batch of states out of every ::STATS_SAMPLE_INTERVAL is
+ * timed, and the time spent in each piece-count subspace is estimated
+ * from those samples.
+ *
+ * Two kinds of JSON records are written.  A "progress" record is
+ * written with every periodic report:
+ *
+ * @code
+ * {"type":"progress","time":12.500,"level":6,"phase":"expand",
+ *  "level_size":2665740,"expanded":1310720,"generated":23396320,
+ *  "states_per_sec":581983.0,"unique":3161185,"queue":1355020,
+ *  "buffered":[982001,967873],"rss_bytes":39845888}
+ * @endcode
+ *
+ * The phase is either "expand" or "merge".  The queue is the number
+ * of states of the level that have not been taken by a worker yet,
+ * and "buffered" holds the number of children that each worker has
+ * waiting to be written out as a run.  A "level" record is written
+ * after each level has been merged:
+ *
+ * @code
+ * {"type":"level","time":7.106,"level":6,"seconds":5.845,
+ *  "expanded":2665740,"generated":47589420,"new":12002340,
+ *  "unique":15163525,"duplicate_rate":0.7478,"disk_bytes":217326920,
+ *  "disk_bytes_per_state":14.332,"rss_bytes":72249344,
+ *  "subspaces":[{"pieces":4,"states":420,"cpu_seconds":0.000},
+ *  {"pieces":6,"states":2665320,"cpu_seconds":3.545}]}
+ * @endcode
+ *
+ * The duplicate rate is the share of generated children that were
+ * either generated more than once or had been visited before.  The CPU
+ * time of a subspace is summed over all worker threads.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#include "wpthread.h"
+#else
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+#include "morris.h"
+#include "stats.h"
+
+/** How often the statistics thread checks whether it should stop.  */
+#define STATS_POLL_USEC 100000
+
+struct SimStats_tag
+{
+  pthread_t thread;
+  pthread_mutex_t lock;
+  bool running; /**< Is the statistics thread running?  */
+  bool stopping;
+  guint interval; /**< Seconds between reports, or zero for none */
+  FILE *json_fp;
+  gint64 start_time;
+  guint64 unique; /**< Number of states visited before this level */
+  /* The level being expanded, guarded by the lock.  */
+  SimCounters *counters;
+  guint num_counters;
+  guint level;
+  guint64 level_size;
+  gint64 level_start;
+  /* State of the previous report, for the current rate.  */
+  gint64 last_time;
+  guint64 last_expanded;
+};
+
+/**
+ * Find a percentile of a sorted sample by the nearest rank method.
+ * morris-bench and morris-load use this for their timings.
+ *
+ * @param count the size of the sample, which must not be 0
+ * @param percent the percentile, from 0 to 100
+ * @return the index of the percentile in the sorted sample
+ */
+guint
+stats_percentile_index (guint count, guint percent)
+{
+  guint rank = (guint) (((guint64) percent * count + 99) / 100);
+  return (rank > 0) ? rank - 1 : 0;
+}
+
+/**
+ * Read a monotonic clock with nanosecond resolution.
+ */
+guint64
+stats_clock_ns (void)
+{
+#ifdef G_OS_WIN32
+  static LARGE_INTEGER freq;
+  LARGE_INTEGER count;
+  if (freq.QuadPart == 0)
+    QueryPerformanceFrequency (&freq);
+  QueryPerformanceCounter (&count);
+  return (guint64) ((double) count.QuadPart * 1e9 / freq.QuadPart);
+#else
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (guint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+/* Get the resident set size of this process, or zero where the
+   system does not tell.  */
+static guint64
+get_rss_bytes (void)
+{
+#ifdef G_OS_WIN32
+  return 0;
+#else
+  FILE *fp = fopen ("/proc/self/statm", "r");
+  unsigned long size, resident;
+  bool success;
+  if (fp == NULL)
+    return 0;
+  success = (fscanf (fp, "%lu %lu", &size, &resident) == 2);
+  fclose (fp);
+  if (!success)
+    return 0;
+  return (guint64) resident * sysconf (_SC_PAGESIZE);
+#endif
+}
+
+static double
+seconds_since (gint64 start)
+{
+  return (g_get_monotonic_time () - start) / 1e6;
+}
+
+/* Sum up all worker counters.  Must be called with the lock held.  */
+static void
+sum_counters (SimStats *stats, SimCounters *total)
+{
+  guint i, j;
+  memset (total, 0, sizeof (SimCounters));
+  for (i = 0; i < stats->num_counters; i++)
+    {
+      SimCounters *counters = &stats->counters[i];
+      total->expanded += counters->expanded;
+      total->generated += counters->generated;
+      total->buffered += counters->buffered;
+      for (j = 0; j < STATS_NUM_SUBSPACES; j++)
+	{
+	  total->subspace_states[j] += counters->subspace_states[j];
+	  total->subspace_samples[j] += counters->subspace_samples[j];
+	  total->subspace_ns[j] += counters->subspace_ns[j];
+	}
+    }
+}
+
+/* Write a progress report.  Must be called with the lock held.  */
+static void
+report_progress (SimStats *stats)
+{
+  SimCounters total;
+  gint64 now = g_get_monotonic_time ();
+  double rate = 0.0;
+  guint64 queue = 0, rss = get_rss_bytes ();
+  bool merging;
+  guint i;
+
+  if (stats->counters == NULL)
+    return;
+  sum_counters (stats, &total);
+  if (now > stats->last_time)
+    rate = (total.expanded - stats->last_expanded) * 1e6 /
+      (now - stats->last_time);
+  if (total.expanded < stats->level_size)
+    queue = stats->level_size - total.expanded;
+  /* Once every state has been expanded, the runs are being merged.  */
+  merging = (queue == 0);
+  stats->last_time = now;
+  stats->last_expanded = total.expanded;
+
+  if (stats->interval > 0 && merging)
+    g_printerr ("morris-sim: level %u: merging, %" G_GUINT64_FORMAT
+		" MB resident\n", stats->level, rss / (1024 * 1024));
+  else if (stats->interval > 0)
+    g_printerr ("morris-sim: level %u: %.1f%% done, %.0f states/s, "
+		"%" G_GUINT64_FORMAT " queued, %" G_GUINT64_FORMAT
+		" buffered, %" G_GUINT64_FORMAT " MB resident\n",
+		stats->level, (stats->level_size > 0) ?
+		100.0 * total.expanded / stats->level_size : 100.0,
+		rate, queue, total.buffered, rss / (1024 * 1024));
+
+  if (stats->json_fp != NULL)
+    {
+      fprintf (stats->json_fp,
+	       "{\"type\":\"progress\",\"time\":%.3f,\"level\":%u,"
+	       "\"phase\":\"%s\",\"level_size\":%" G_GUINT64_FORMAT ","
+	       "\"expanded\":%" G_GUINT64_FORMAT ","
+	       "\"generated\":%" G_GUINT64_FORMAT ","
+	       "\"states_per_sec\":%.1f,\"unique\":%" G_GUINT64_FORMAT ","
+	       "\"queue\":%" G_GUINT64_FORMAT ",\"buffered\":[",
+	       seconds_since (stats->start_time), stats->level,
+	       merging ? "merge" : "expand", stats->level_size,
+	       total.expanded, total.generated, rate, stats->unique, queue);
+      for (i = 0; i < stats->num_counters; i++)
+	fprintf (stats->json_fp, "%s%" G_GUINT64_FORMAT, (i > 0) ? "," : "",
+		 stats->counters[i].buffered);
+      fprintf (stats->json_fp, "],\"rss_bytes\":%" G_GUINT64_FORMAT "}\n",
+	       rss);
+      fflush (stats->json_fp);
+    }
+}
+
+static void *
+stats_main (void *user_data)
+{
+  SimStats *stats = (SimStats *) user_data;
+  gint64 next_report = g_get_monotonic_time () +
+    (gint64) stats->interval * 1000000;
+
+  pthread_mutex_lock (&stats->lock);
+  while (!stats->stopping)
+    {
+      pthread_mutex_unlock (&stats->lock);
+      g_usleep (STATS_POLL_USEC);
+      pthread_mutex_lock (&stats->lock);
+      if (g_get_monotonic_time () >= next_report)
+	{
+	  report_progress (stats);
+	  next_report += (gint64) stats->interval * 1000000;
+	}
+    }
+  pthread_mutex_unlock (&stats->lock);
+  return NULL;
+}
+
+/**
+ * Start collecting statistics.
+ *
+ * @param interval the number of seconds between progress reports, or
+ * zero to only report at the end of each level
+ * @param json_fp the stream to write JSON records to, or @a NULL
+ * @param unique the number of states that have already been visited
+ * @return the new statistics collector
+ */
+SimStats *
+sim_stats_new (guint interval, FILE *json_fp, guint64 unique)
+{
+  SimStats *stats = g_new0 (SimStats, 1);
+  pthread_mutex_init (&stats->lock, NULL);
+  stats->interval = interval;
+  stats->json_fp = json_fp;
+  stats->start_time = g_get_monotonic_time ();
+  stats->unique = unique;
+  if (interval > 0)
+    stats->running = (pthread_create (&stats->thread, NULL, stats_main,
+				      stats) == 0);
+  return stats;
+}
+
+/**
+ * Tell the statistics collector that a level is being expanded.
+ *
+ * @param stats the statistics collector
+ * @param level the level number
+ * @param level_size the number of states in the level
+ * @param counters the counters of the worker threads, which must stay
+ * valid until sim_stats_end_level() is called
+ * @param num_counters the number of worker threads
+ */
+void
+sim_stats_begin_level (SimStats *stats, guint level, guint64 level_size,
+		       SimCounters *counters, guint num_counters)
+{
+  pthread_mutex_lock (&stats->lock);
+  stats->counters = counters;
+  stats->num_counters = num_counters;
+  stats->level = level;
+  stats->level_size = level_size;
+  stats->level_start = g_get_monotonic_time ();
+  stats->last_time = stats->level_start;
+  stats->last_expanded = 0;
+  pthread_mutex_unlock (&stats->lock);
+}
+
+/**
+ * Report on a level that has been merged.
+ *
+ * @param stats the statistics collector
+ * @param num_new the number of new states that the level produced
+ * @param disk_bytes the disk space taken up by the simulation
+ */
+void
+sim_stats_end_level (SimStats *stats, guint64 num_new, guint64 disk_bytes)
+{
+  SimCounters total;
+  double seconds, dup_rate = 0.0, bytes_per_state = 0.0;
+  guint64 rss = get_rss_bytes ();
+  bool first = true;
+  guint i;
+
+  pthread_mutex_lock (&stats->lock);
+  sum_counters (stats, &total);
+  stats->counters = NULL;
+  stats->num_counters = 0;
+  stats->unique += num_new;
+  seconds = seconds_since (stats->level_start);
+  if (total.generated > 0)
+    dup_rate = 1.0 - (double) num_new / total.generated;
+  if (stats->unique > 0)
+    bytes_per_state = (double) disk_bytes / stats->unique;
+
+  if (stats->interval > 0)
+    g_printerr ("morris-sim: level %u took %.1f s, %.0f states/s, "
+		"%" G_GUINT64_FORMAT " unique states, "
+		"%.1f%% duplicates, %.1f bytes per state on disk\n",
+		stats->level, seconds,
+		(seconds > 0.0) ? total.expanded / seconds : 0.0,
+		stats->unique, 100.0 * dup_rate, bytes_per_state);
+
+  if (stats->json_fp != NULL)
+    {
+      fprintf (stats->json_fp,
+	       "{\"type\":\"level\",\"time\":%.3f,\"level\":%u,"
+	       "\"seconds\":%.3f,\"expanded\":%" G_GUINT64_FORMAT ","
+	       "\"generated\":%" G_GUINT64_FORMAT ","
+	       "\"new\":%" G_GUINT64_FORMAT ","
+	       "\"unique\":%" G_GUINT64_FORMAT ","
+	       "\"duplicate_rate\":%.4f,\"disk_bytes\":%" G_GUINT64_FORMAT ","
+	       "\"disk_bytes_per_state\":%.3f,"
+	       "\"rss_bytes\":%" G_GUINT64_FORMAT ",\"subspaces\":[",
+	       seconds_since (stats->start_time), stats->level, seconds,
+	       total.expanded, total.generated, num_new, stats->unique,
+	       dup_rate, disk_bytes, bytes_per_state, rss);
+      for (i = 0; i < STATS_NUM_SUBSPACES; i++)
+	{
+	  double cpu_seconds = 0.0;
+	  if (total.subspace_states[i] == 0)
+	    continue;
+	  if (total.subspace_samples[i] > 0)
+	    cpu_seconds = (double) total.subspace_ns[i] /
+	      total.subspace_samples[i] * total.subspace_states[i] / 1e9;
+	  fprintf (stats->json_fp, "%s{\"pieces\":%u,"
+		   "\"states\":%" G_GUINT64_FORMAT ",\"cpu_seconds\":%.3f}",
+		   first ? "" : ",", i, total.subspace_states[i],
+		   cpu_seconds);
+	  first = false;
+	}
+      fputs ("]}\n", stats->json_fp);
+      fflush (stats->json_fp);
+    }
+  pthread_mutex_unlock (&stats->lock);
+}
+
+/**
+ * Stop the statistics thread and free the collector.
+ */
+void
+sim_stats_free (SimStats *stats)
+{
+  if (stats->running)
+    {
+      pthread_mutex_lock (&stats->lock);
+      stats->stopping = true;
+      pthread_mutex_unlock (&stats->lock);
+      pthread_join (stats->thread, NULL);
+    }
+  pthread_mutex_destroy (&stats->lock);
+  g_free (stats);
+}
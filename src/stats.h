@@ -0,0 +1,79 @@
+/* Live statistics for the simulator.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Live statistics for the simulator.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+/**
+ * Number of piece-count subspaces.  Game states are grouped by the
+ * total number of pieces on the board, which is at most ::BOARD_SIZE.
+ */
+#define STATS_NUM_SUBSPACES (BOARD_SIZE + 1)
+
+/** Only one batch of states in every this many is timed.  */
+#define STATS_SAMPLE_INTERVAL 64
+
+/**
+ * Counters kept by one worker thread.
+ *
+ * Only the owning thread writes to its counters, with plain
+ * increments.  The statistics thread reads them without locking when
+ * it prints a report, so a report may be off by a few states, but the
+ * workers never wait on anything.
+ */
+struct SimCounters_tag
+{
+  guint64 expanded; /**< States expanded in this level */
+  guint64 generated; /**< Children generated, including duplicates */
+  guint64 buffered; /**< Children waiting to be written as a run */
+  /** States expanded within each piece-count subspace.  */
+  guint64 subspace_states[STATS_NUM_SUBSPACES];
+  /** Number of timed expansions within each subspace.  */
+  guint64 subspace_samples[STATS_NUM_SUBSPACES];
+  /** Total nanoseconds spent on the timed expansions.  */
+  guint64 subspace_ns[STATS_NUM_SUBSPACES];
+  /* Keep the next thread's counters off of the last cache line.  */
+  gchar padding[64];
+};
+typedef struct SimCounters_tag SimCounters;
+
+typedef struct SimStats_tag SimStats;
+
+guint64 stats_clock_ns (void);
+guint stats_percentile_index (guint count, guint percent);
+
+SimStats *sim_stats_new (guint interval, FILE *json_fp, guint64 unique);
+void sim_stats_begin_level (SimStats *stats, guint level, guint64 level_size,
+			    SimCounters *counters, guint num_counters);
+void sim_stats_end_level (SimStats *stats, guint64 num_new,
+			  guint64 disk_bytes);
+void sim_stats_free (SimStats *stats);
+
+#endif /* not STATS_H */
@@ -1,718 +0,0 @@
-/* Unpacked mill mask tables.  One byte is one board position.
-
-Copyright (C) 2012 Andrew Makousky
-
-Permission is hereby granted, free of charge, to any person obtaining
-a copy of this software and associated documentation files (the
-"Software"), to deal in the Software without restriction, including
-without limitation the rights to use, copy, modify, merge, publish,
-distribute, sublicense, and/or sell copies of the Software, and to
-permit persons to whom the Software is furnished to do so, subject to
-the following conditions:
-
-The above copyright notice and this permission notice shall be
-included in all copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
-EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
-MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
-NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
-LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
-OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
-WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
-
-/**
- * @file
- * Unpacked mill mask tables.
- *
- * In these unpacked mill mask tables, one board position is one byte
- * in size.
- */
-
-guchar null_mask[MASK_SIZE] =
-  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, };
-
-guchar saturated_mask[MASK_SIZE] =
-  { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, };
-
-guchar p1_mask[MASK_SIZE] =
-  { 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
-    0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
-    0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
-    0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, };
-
-guchar p2_mask[MASK_SIZE] =
-  { 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
-    0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
-    0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
-    0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, };
-
-/**
- * Mill masks.
- *
- * These are graphical representations of the mill masks.
-
-@verbatim
-mill_masks[ 0]
-    X-----------X-----------X
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[ 1]
-     ----------- -----------X
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     --- ---         --- ---X
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- -----------X
-mill_masks[ 2]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-    X-----------X-----------X
-mill_masks[ 3]
-    X----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-    X--- ---         --- --- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-    X----------- ----------- 
-mill_masks[ 4]
-     ----------- ----------- 
-    | \         |         / |
-    |  \X-------X-------X/  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[ 5]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- -------X/  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     --- ---         ---X--- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- -------X\  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[ 6]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | / X-------X-------X\  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[ 7]
-     ----------- ----------- 
-    | \         |         / |
-    |  \X------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     ---X---         --- --- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | / X------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[ 8]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \ X---X---X/  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[ 9]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- ---X/  |   |
-    |   |   |       |   |   |
-     --- ---        X--- --- 
-    |   |   |       |   |   |
-    |   | /  --- ---X\  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[10]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | / X---X---X\  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[11]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \ X--- --- /  |   |
-    |   |   |       |   |   |
-     --- ---X        --- --- 
-    |   |   |       |   |   |
-    |   | / X--- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[12]
-    X----------- ----------- 
-    | \         |         / |
-    |  \X------- ------- /  |
-    |   |\      |     / |   |
-    |   | \ X--- --- /  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[13]
-     -----------X----------- 
-    | \         |         / |
-    |  \ -------X------- /  |
-    |   |\      |     / |   |
-    |   | \  ---X--- /  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[14]
-     ----------- -----------X
-    | \         |         / |
-    |  \ ------- -------X/  |
-    |   |\      |     / |   |
-    |   | \  --- ---X/  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[15]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     --- ---        X---X---X
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-mill_masks[16]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | /  --- ---X\  |   |
-    |   |/      |     \ |   |
-    | /  ------- -------X\  |
-    |/          |         \ |
-     ----------- -----------X
-mill_masks[17]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | /  ---X--- \  |   |
-    |   |/      |     \ |   |
-    | /  -------X------- \  |
-    |/          |         \ |
-     -----------X----------- 
-mill_masks[18]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-     --- ---         --- --- 
-    |   |   |       |   |   |
-    |   | / X--- --- \  |   |
-    |   |/      |     \ |   |
-    | / X------- ------- \  |
-    |/          |         \ |
-    X----------- ----------- 
-mill_masks[19]
-     ----------- ----------- 
-    | \         |         / |
-    |  \ ------- ------- /  |
-    |   |\      |     / |   |
-    |   | \  --- --- /  |   |
-    |   |   |       |   |   |
-    X---X---X        --- --- 
-    |   |   |       |   |   |
-    |   | /  --- --- \  |   |
-    |   |/      |     \ |   |
-    | /  ------- ------- \  |
-    |/          |         \ |
-     ----------- ----------- 
-@endverbatim
-
- *
- */
-guchar mill_masks[20][MASK_SIZE] =
-  {
-    { 0xff, 0xff, 0xff, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0xff, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0xff, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0xff, 0xff, 0xff,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0xff, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0xff, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0xff, 0xff, 0xff,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0xff, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0xff, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0xff, 0xff, 0xff, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0xff, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0xff, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0xff, 0xff, 0xff, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0xff, 0x00, 0x00, 0x00,
-      0xff, 0x00, 0x00, 0x00, 0x00, 0xff,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0xff, 0xff, 0xff,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0xff, 0x00, 0x00, 0x00, 0x00, 0xff,
-      0x00, 0x00, 0x00, 0xff, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0xff, 0x00, 0x00, 0xff, 0x00, 0x00,
-      0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0xff, 0x00, 0x00, 0xff, 0x00,
-      0x00, 0xff, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0xff, 0x00, 0x00, 0xff,
-      0x00, 0x00, 0xff, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0xff, 0xff, 0xff, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
-      0x00, 0x00, 0xff, 0x00, 0x00, 0xff,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0xff, 0x00,
-      0x00, 0xff, 0x00, 0x00, 0xff, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0xff, 0x00, 0x00,
-      0xff, 0x00, 0x00, 0xff, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0xff, 0xff, 0xff,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-  };
-
-/* These masks are generated from `mill_masks'.  */
-guchar p1_mill_masks[20][MASK_SIZE] =
-  {
-    { 0x01, 0x01, 0x01, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x01, 0x01, 0x01,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x01, 0x01, 0x01,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x01, 0x01, 0x01, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x01, 0x01, 0x01, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-      0x01, 0x00, 0x00, 0x00, 0x00, 0x01,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x01, 0x01, 0x01,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x01, 0x00, 0x00, 0x00, 0x00, 0x01,
-      0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x01, 0x00, 0x00, 0x01, 0x00, 0x00,
-      0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x01, 0x00, 0x00, 0x01, 0x00,
-      0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x01, 0x00, 0x00, 0x01,
-      0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x01, 0x01, 0x01, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
-      0x00, 0x00, 0x01, 0x00, 0x00, 0x01,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
-      0x00, 0x01, 0x00, 0x00, 0x01, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
-      0x01, 0x00, 0x00, 0x01, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x01, 0x01, 0x01,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-  };
-
-guchar p2_mill_masks[20][MASK_SIZE] =
-  {
-    { 0x02, 0x02, 0x02, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x02, 0x02, 0x02,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x02, 0x02, 0x02,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x02, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x02, 0x02, 0x02, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x02, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x02, 0x02, 0x02, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-      0x02, 0x00, 0x00, 0x00, 0x00, 0x02,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x02, 0x02, 0x02,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x02, 0x00, 0x00, 0x00, 0x00, 0x02,
-      0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x02, 0x00, 0x00, 0x02, 0x00, 0x00,
-      0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x02, 0x00, 0x00, 0x02, 0x00,
-      0x00, 0x02, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x02, 0x00, 0x00, 0x02,
-      0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x02, 0x02, 0x02, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
-      0x00, 0x00, 0x02, 0x00, 0x00, 0x02,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x02, 0x00,
-      0x00, 0x02, 0x00, 0x00, 0x02, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
-      0x02, 0x00, 0x00, 0x02, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-
-    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x02, 0x02, 0x02,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, },
-  };
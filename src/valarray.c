@@ -0,0 +1,247 @@
+/* Bit-packed arrays of small per-state values.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Bit-packed arrays of small per-state values.
+ *
+ * During a retrograde solve, every game state only needs to remember
+ * whether it is won, lost, drawn, or still unknown (two bits), and
+ * possibly a small count of unresolved successors (another two bits).
+ * Storing those values in whole bytes would waste three quarters of
+ * the memory, so they are packed into 64-bit words instead, with the
+ * lowest numbered entry in the least significant bits, just like in
+ * ::BoardQuad.
+ *
+ * Updates use the GCC atomic builtins on the whole word.  A failed
+ * compare and swap just means that another thread changed a
+ * neighboring entry in the meantime, so the update is retried with
+ * the new word.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "core.h"
+#include <glib.h>
+
+#include "valarray.h"
+
+/* Locate the word and the bit position within the word of an
+   entry.  */
+#define ENTRIES_PER_WORD(array) (64 / (array)->bits)
+#define WORD_INDEX(array, index) ((index) / ENTRIES_PER_WORD (array))
+#define BIT_POS(array, index) \
+  (((index) % ENTRIES_PER_WORD (array)) * (array)->bits)
+#define ENTRY_MASK(array) ((G_GUINT64_CONSTANT (1) << (array)->bits) - 1)
+
+/**
+ * Create a value array with every entry set to zero
+ * (::VALUE_UNKNOWN).
+ *
+ * @param length the number of entries
+ * @param bits the number of bits per entry, either 2 or 4
+ * @return the new value array, or @a NULL if there is not enough
+ * memory
+ */
+ValueArray *
+value_array_new (guint64 length, guchar bits)
+{
+  ValueArray *array;
+  guint64 num_words;
+  g_return_val_if_fail (bits == 2 || bits == 4, NULL);
+  array = g_new (ValueArray, 1);
+  array->length = length;
+  array->bits = bits;
+  num_words = (length + ENTRIES_PER_WORD (array) - 1) /
+    ENTRIES_PER_WORD (array);
+  array->words = g_try_malloc0 (num_words * sizeof (guint64));
+  if (array->words == NULL && num_words > 0)
+    {
+      g_free (array);
+      return NULL;
+    }
+  return array;
+}
+
+void
+value_array_free (ValueArray *array)
+{
+  g_free (array->words);
+  g_free (array);
+}
+
+/**
+ * Get an entry of a value array.
+ *
+ * @param array the value array to index
+ * @param index the index of the entry
+ * @return the value of the entry
+ */
+guchar
+value_array_get (ValueArray *array, guint64 index)
+{
+  guint64 word;
+  word = ((volatile guint64 *) array->words)[WORD_INDEX (array, index)];
+  return (word >> BIT_POS (array, index)) & ENTRY_MASK (array);
+}
+
+/**
+ * Atomically set an entry of a value array.
+ *
+ * @param array the value array to mutate
+ * @param index the index of the entry
+ * @param value the new value of the entry
+ */
+void
+value_array_set (ValueArray *array, guint64 index, guchar value)
+{
+  guint64 *word_ptr = &array->words[WORD_INDEX (array, index)];
+  guint bitpos = BIT_POS (array, index);
+  guint64 mask = ENTRY_MASK (array) << bitpos;
+  guint64 new_bits = ((guint64) value << bitpos) & mask;
+  guint64 old_word, new_word;
+  do
+    {
+      old_word = *(volatile guint64 *) word_ptr;
+      new_word = (old_word & ~mask) | new_bits;
+    }
+  while (!__sync_bool_compare_and_swap (word_ptr, old_word, new_word));
+}
+
+/**
+ * Atomically change an entry only if it still has an expected value.
+ *
+ * This is how a thread claims a state, for example by changing it
+ * from ::VALUE_UNKNOWN to ::VALUE_WIN: only one of the threads that
+ * race to mark the same state will succeed.
+ *
+ * @param array the value array to mutate
+ * @param index the index of the entry
+ * @param old_value the expected current value of the entry
+ * @param new_value the value to store
+ * @return @a true if the entry had the value @a old_value and was
+ * changed, @a false otherwise
+ */
+bool
+value_array_cas (ValueArray *array, guint64 index,
+		 guchar old_value, guchar new_value)
+{
+  guint64 *word_ptr = &array->words[WORD_INDEX (array, index)];
+  guint bitpos = BIT_POS (array, index);
+  guint64 mask = ENTRY_MASK (array) << bitpos;
+  guint64 old_bits = ((guint64) old_value << bitpos) & mask;
+  guint64 new_bits = ((guint64) new_value << bitpos) & mask;
+  guint64 old_word;
+  while (1)
+    {
+      old_word = *(volatile guint64 *) word_ptr;
+      if ((old_word & mask) != old_bits)
+	return false;
+      if (__sync_bool_compare_and_swap (word_ptr, old_word,
+					(old_word & ~mask) | new_bits))
+	return true;
+    }
+}
+
+/**
+ * Atomically add to an entry, saturating at zero and at the largest
+ * value that fits in the entry.
+ *
+ * With 4-bit entries, this is used to count down the number of
+ * successors of a state that have not been resolved yet.
+ *
+ * @param array the value array to mutate
+ * @param index the index of the entry
+ * @param delta the amount to add, which may be negative
+ * @return the new value of the entry
+ */
+guchar
+value_array_add (ValueArray *array, guint64 index, gint delta)
+{
+  guint64 *word_ptr = &array->words[WORD_INDEX (array, index)];
+  guint bitpos = BIT_POS (array, index);
+  guint64 mask = ENTRY_MASK (array) << bitpos;
+  guint64 old_word;
+  gint value;
+  do
+    {
+      old_word = *(volatile guint64 *) word_ptr;
+      value = (gint) ((old_word & mask) >> bitpos) + delta;
+      if (value < 0)
+	value = 0;
+      if (value > (gint) ENTRY_MASK (array))
+	value = ENTRY_MASK (array);
+    }
+  while (!__sync_bool_compare_and_swap
+	 (word_ptr, old_word,
+	  (old_word & ~mask) | ((guint64) value << bitpos)));
+  return value;
+}
+
+/**
+ * Count the entries that have a given value.
+ *
+ * Whole words are compared at once by XORing them with the value
+ * repeated in every entry, so that matching entries become zero, and
+ * then counting the zero entries with a population count.
+ *
+ * @param array the value array to scan
+ * @param value the value to count
+ * @return the number of entries equal to @a value
+ */
+guint64
+value_array_count (ValueArray *array, guchar value)
+{
+  guint64 pattern = 0, low_bits = 0;
+  guint64 num_words, full_words, i, total = 0;
+  guint entries_per_word = ENTRIES_PER_WORD (array);
+  guint j;
+
+  for (j = 0; j < entries_per_word; j++)
+    {
+      pattern |= ((guint64) value & ENTRY_MASK (array)) << (j * array->bits);
+      low_bits |= G_GUINT64_CONSTANT (1) << (j * array->bits);
+    }
+
+  full_words = array->length / entries_per_word;
+  num_words = (array->length + entries_per_word - 1) / entries_per_word;
+  for (i = 0; i < num_words; i++)
+    {
+      guint64 diff = array->words[i] ^ pattern;
+      /* Fold every entry down to its lowest bit.  */
+      diff |= diff >> 1;
+      if (array->bits == 4)
+	diff |= diff >> 2;
+      diff = ~diff & low_bits;
+      if (i >= full_words)
+	{
+	  /* Ignore the unused entries past the end of the array.  */
+	  guint num_left = array->length % entries_per_word;
+	  diff &= (G_GUINT64_CONSTANT (1) << (num_left * array->bits)) - 1;
+	}
+      total += __builtin_popcountll (diff);
+    }
+  return total;
+}
@@ -0,0 +1,61 @@
+/* Bit-packed arrays of small per-state values.
+
+Copyright (C) 2012 Andrew Makousky
+
+Permission is hereby granted, free of charge, to any person obtaining
+a copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  */
+
+/**
+ * @file
+ * Bit-packed arrays of small per-state values.
+ */
+
+#ifndef VALARRAY_H
+#define VALARRAY_H
+
+/** The game theoretic value of a game state, as seen by its mover.  */
+enum GameValue_tag { VALUE_UNKNOWN, VALUE_WIN, VALUE_LOSS, VALUE_DRAW };
+
+/**
+ * An array of 2-bit or 4-bit values packed into 64-bit words.
+ *
+ * This is the same idea as ::BoardQuad, but scaled up to one entry
+ * per game state of a whole database.  Entries never straddle a word,
+ * so every entry can be updated with a single atomic compare and swap
+ * on its word, and many threads can update neighboring entries at the
+ * same time without any locks.
+ */
+struct ValueArray_tag
+{
+  guint64 *words;
+  guint64 length; /**< Number of entries */
+  guchar bits; /**< Bits per entry: either 2 or 4 */
+};
+typedef struct ValueArray_tag ValueArray;
+
+ValueArray *value_array_new (guint64 length, guchar bits);
+void value_array_free (ValueArray *array);
+guchar value_array_get (ValueArray *array, guint64 index);
+void value_array_set (ValueArray *array, guint64 index, guchar value);
+bool value_array_cas (ValueArray *array, guint64 index,
+		      guchar old_value, guchar new_value);
+guchar value_array_add (ValueArray *array, guint64 index, gint delta);
+guint64 value_array_count (ValueArray *array, guchar value);
+
+#endif /* not VALARRAY_H */
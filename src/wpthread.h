@@ -3,19 +3,38 @@
 #ifndef WPTHREAD_H
 #define WPTHREAD_H
 
-#define pthread_t DWORD
+/* A thread is the handle returned by CreateThread(), which is closed
+   when the thread is joined.  */
+#define pthread_t HANDLE
 #define pthread_mutex_t HANDLE
 #define PTHREAD_MUTEX_INITIALIZER INVALID_HANDLE
 
-#define pthread_self() GetCurrentThreadId()
+#define pthread_self() GetCurrentThread()
 #define pthread_mutex_lock(mutex) WaitForSingleObject(*(mutex), INFINITE)
-#define pthread_equal(p1, p2) (p1 == p2)
+#define pthread_equal(p1, p2) (GetThreadId(p1) == GetThreadId(p2))
 #define pthread_mutex_unlock(mutex) ReleaseMutex(*(mutex))
-#define pthread_exit(val) ExitThread((DWORD)(val))
+#define pthread_exit(val) ExitThread((DWORD)(DWORD_PTR)(val))
 #define pthread_mutex_destroy(mutex) CloseHandle(*(mutex))
 #define pthread_create(thread_id, props, proc, user_data) \
-  (CreateThread(NULL, 0, proc, user_data, thread_id) == NULL)
+  ((*(thread_id) = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE) proc, \
+				user_data, 0, NULL)) == NULL)
+#define pthread_join(thread_id, retval) wpthread_join(thread_id, retval)
 #define pthread_mutex_init(mutex, attr) \
   ((*(mutex)) = CreateMutex(NULL, FALSE, NULL))
 
+/* Wait for a thread and close its handle.  Windows threads only
+   return a DWORD, so the pointer in *retval holds just that much.  */
+static __inline int
+wpthread_join (HANDLE thread, void **retval)
+{
+  DWORD code;
+  if (WaitForSingleObject (thread, INFINITE) == WAIT_FAILED)
+    return 1;
+  if (retval != NULL)
+    *retval = GetExitCodeThread (thread, &code) ?
+      (void *) (DWORD_PTR) code : NULL;
+  CloseHandle (thread);
+  return 0;
+}
+
 #endif /* not WPTHREAD_H */